@@ -12,9 +12,12 @@
 
 #include "../Geometry/Point.h"
 #include "../Parser/strutil.h"
+#include "../Parser/attributes.h"
 #include "../Utils/IO.h"
 #include "Iterators_2.h"
 #include "Boundary_2.h"
+#include "Topology_2.h"
+#include "Ordering.h"
 
 #include "MapKeys.h"
 
@@ -28,6 +31,11 @@ namespace DartLib
 /*! \class TBaseMesh_2 BaseMesh_2.h "BaseMesh_2.h"
  *  \brief TBaseMesh_2, base class for all types of 2d-mesh classes
  *
+ *  The queries which do not modify the mesh, the iterators, vertex_edge,
+ *  dart, id_vertex and the like, only read it, so several threads can
+ *  traverse the mesh at once while none of them creates, deletes or
+ *  relinks cells. The parallel_for_each_* methods rely on it.
+ *
  *  \tparam tVertex: vertex class, derived from DartLib::CVertex_2 class
  *  \tparam tEdge  : edge   class, derived from DartLib::CEdge_2   class
  *  \tparam tFace  : face   class, derived from DartLib::CFace_2   class
@@ -44,6 +52,7 @@ class TBaseMesh_2
     
     using CLoop                = TLoop      <T_BASEMESH>;
     using CBoundary            = TBoundary_2<T_BASEMESH>;
+    using CTopology            = TTopology_2<T_BASEMESH>;
 
     using VertexIterator       = Dim2::VertexIterator<T_BASEMESH>;
     using EdgeIterator         = Dim2::EdgeIterator  <T_BASEMESH>;
@@ -61,7 +70,7 @@ class TBaseMesh_2
     /*!
      *  Constructor function
      */
-    TBaseMesh_2(){};
+    TBaseMesh_2() : m_typed_traits(false) {};
 
     /*!
      *  Destructor function
@@ -111,6 +120,56 @@ class TBaseMesh_2
         const std::map<int, std::string>& face_id_str,
         const std::vector<std::tuple<int, int, std::string>>& edge_attrs,
         const std::vector<std::tuple<int, int, std::string>>& corner_attrs);
+
+    /*!
+     *  Whether the traits of the vertices and faces are kept in typed
+     *  attribute columns instead of their strings, false by default.
+     *  It is set before a read: the strings are parsed into the columns
+     *  and dropped, and regenerated only to write the mesh. The edges
+     *  and darts keep their strings.
+     */
+    bool& typed_traits() { return m_typed_traits; };
+
+    /*!
+     *  Typed traits of the vertices and faces, the rows are the ids.
+     */
+    CAttributeTable& vertex_attributes() { return m_vertex_attributes; };
+    CAttributeTable& face_attributes()   { return m_face_attributes;   };
+
+    /*!
+     *  Move the traits of the vertex and face strings to the attribute
+     *  columns, the strings keep the tokens which do not fit a column.
+     */
+    void strings_to_attributes();
+
+    /*!
+     *  Write the attribute columns back to the vertex and face strings.
+     */
+    void attributes_to_strings();
+
+    /*!
+     *  Reorder the vertices and faces for cache locality, by reverse
+     *  Cuthill-McKee over the edges, or along the Hilbert curve of the
+     *  points. The faces follow their first vertex. The mesh is loaded
+     *  again in the new order from the points and strings of the cells,
+     *  as a read loads it, so it is called right after a read. The ids
+     *  are renumbered from 1 in the new order.
+     *  \param ordering: COrdering::RCM or COrdering::HILBERT
+     */
+    void reorder(int ordering = COrdering::RCM);
+
+    /*!
+     *  Apply a function to each vertex, edge or face in parallel. The cells
+     *  are cut into chunks, each thread takes the next chunk when it is done
+     *  with the previous one. The function may write the cell it is given,
+     *  and read the whole mesh; it must not write the other cells, create
+     *  or delete cells, nor throw. Without OpenMP the cells are visited in
+     *  order.
+     *  \param f: function taking a vertex, edge or face pointer
+     */
+    template <typename F> void parallel_for_each_vertex(F f) { _parallel_for_each(m_vertices, f); };
+    template <typename F> void parallel_for_each_edge  (F f) { _parallel_for_each(m_edges,    f); };
+    template <typename F> void parallel_for_each_face  (F f) { _parallel_for_each(m_faces,    f); };
  
     /*!
      *  Create a vertex cell.
@@ -169,8 +228,8 @@ class TBaseMesh_2
     CEdge*   edge  (int index) { return m_edges[index];    };
     CFace*   face  (int index) { return m_faces[index];    };
    */
-    CVertex* id_vertex(int id) { return m_map_vertex[id];  };
-    CFace*   id_face  (int id) { return m_map_face[id];    };
+    CVertex* id_vertex(int id) { auto it = m_map_vertex.find(id); return it != m_map_vertex.end() ? it->second : NULL; };
+    CFace*   id_face  (int id) { auto it = m_map_face.find(id);   return it != m_map_face.end()   ? it->second : NULL; };
 
 
     /*=============================================================
@@ -317,6 +376,20 @@ class TBaseMesh_2
 
     void _post_processing();
 
+    /*!
+     *  Apply a function to the cells of a list, the lists have no random
+     *  access, so the cells are gathered in an array first
+     */
+    template <typename T, typename F>
+    static void _parallel_for_each(std::list<T*>& cells, F& f)
+    {
+        std::vector<T*> array(cells.begin(), cells.end());
+        int n = (int)array.size();
+#pragma omp parallel for schedule(dynamic, 256)
+        for (int i = 0; i < n; i++)
+            f(array[i]);
+    };
+
   protected:
     std::list<CDart*  > m_darts;
     std::list<CVertex*> m_vertices;
@@ -330,6 +403,13 @@ class TBaseMesh_2
      *  This is used to check that whether an edge has been created.
      */
     std::unordered_map<EdgeMapKey, CEdge*, EdgeMapKey_hasher> m_map_edge_keys;
+
+    /*!
+     *  Typed traits of the vertices and faces, by id.
+     */
+    bool            m_typed_traits;
+    CAttributeTable m_vertex_attributes;
+    CAttributeTable m_face_attributes;
 };
 
 T_TYPENAME
@@ -351,6 +431,9 @@ void T_BASEMESH::unload()
 
     m_map_vertex.clear();
     m_map_face.clear();
+
+    m_vertex_attributes.clear();
+    m_face_attributes.clear();
 }
 
 T_TYPENAME
@@ -441,6 +524,157 @@ void T_BASEMESH::load_attributes(
 
         pD->from_string();
     }
+
+    // the strings are dropped once the cells have read them
+    if (m_typed_traits)
+        strings_to_attributes();
+
+}
+
+T_TYPENAME
+void T_BASEMESH::strings_to_attributes()
+{
+    // the ids of a file are dense, the rows of the others stay in the strings
+    m_vertex_attributes.limit(2 * m_vertices.size() + 1024);
+    m_face_attributes.limit(2 * m_faces.size() + 1024);
+
+    for (CVertex* pV : m_vertices)
+        m_vertex_attributes.parse((size_t)(unsigned int) pV->id(), pV->string());
+
+    for (CFace* pF : m_faces)
+        m_face_attributes.parse((size_t)(unsigned int) pF->id(), pF->string());
+}
+
+T_TYPENAME
+void T_BASEMESH::attributes_to_strings()
+{
+    for (CVertex* pV : m_vertices)
+        m_vertex_attributes.format((size_t)(unsigned int) pV->id(), pV->string());
+
+    for (CFace* pF : m_faces)
+        m_face_attributes.format((size_t)(unsigned int) pF->id(), pF->string());
+}
+
+T_TYPENAME
+void T_BASEMESH::reorder(int ordering)
+{
+    // the strings carry the traits
+    if (m_typed_traits)
+        attributes_to_strings();
+
+    std::vector<CVertex*> verts(m_vertices.begin(), m_vertices.end());
+    std::vector<CFace*>   faces(m_faces.begin(), m_faces.end());
+    int nv = (int)verts.size();
+    int nf = (int)faces.size();
+
+    std::unordered_map<CVertex*, int> vindex;
+    for (int i = 0; i < nv; i++)
+        vindex[verts[i]] = i;
+
+    // the neighbors of the vertices, by the edges
+    std::vector<int> offsets(nv + 1, 0), adjacency;
+    for (CEdge* pE : m_edges)
+    {
+        offsets[vindex[edge_vertex(pE, 0)] + 1]++;
+        offsets[vindex[edge_vertex(pE, 1)] + 1]++;
+    }
+    for (int i = 0; i < nv; i++)
+        offsets[i + 1] += offsets[i];
+    adjacency.resize(offsets[nv]);
+    std::vector<int> fill(offsets.begin(), offsets.end() - 1);
+    for (CEdge* pE : m_edges)
+    {
+        int a = vindex[edge_vertex(pE, 0)];
+        int b = vindex[edge_vertex(pE, 1)];
+        adjacency[fill[a]++] = b;
+        adjacency[fill[b]++] = a;
+    }
+
+    std::vector<int> order;
+    if (ordering == COrdering::HILBERT)
+    {
+        std::vector<double> points(3 * nv);
+        for (int i = 0; i < nv; i++)
+            for (int k = 0; k < 3; k++)
+                points[3 * i + k] = verts[i]->point()[k];
+        COrdering::hilbert(points, order);
+    }
+    else
+        COrdering::rcm(offsets, adjacency, order);
+
+    std::vector<int> rank(nv);
+    for (int k = 0; k < nv; k++)
+        rank[order[k]] = k;
+
+    // the vertices of the faces, load() starts a face at the dart of its
+    // second vertex, so the last vertex goes first to keep the same darts
+    std::vector<int> foffsets(1, 0), findices;
+    for (CFace* pF : faces)
+    {
+        size_t first = findices.size();
+        CDart* pD = D(pF);
+        do
+        {
+            findices.push_back(vindex[C0(pD)]);
+            pD = beta(1, pD);
+        } while (pD != D(pF));
+        std::rotate(findices.begin() + first, findices.end() - 1, findices.end());
+        foffsets.push_back((int)findices.size());
+    }
+
+    std::vector<int> forder;
+    COrdering::faces(foffsets, findices, rank, forder);
+    std::vector<int> frank(nf);
+    for (int k = 0; k < nf; k++)
+        frank[forder[k]] = k;
+
+    // what a read gives the cells, by the new ids
+    std::map<int, CPoint> vert_id_point;
+    std::map<int, std::vector<int>> face_id_vids;
+    std::map<int, std::string> vert_id_str, face_id_str;
+    std::vector<std::tuple<int, int, std::string>> edge_attrs, corner_attrs;
+
+    for (int i = 0; i < nv; i++)
+    {
+        CVertex* pV = verts[order[i]];
+        vert_id_point.insert(vert_id_point.end(), std::make_pair(i + 1, pV->point()));
+        if (!pV->string().empty())
+            vert_id_str.insert(vert_id_str.end(), std::make_pair(i + 1, pV->string()));
+    }
+
+    for (int i = 0; i < nf; i++)
+    {
+        int f = forder[i];
+        std::vector<int> vids;
+        for (int k = foffsets[f]; k < foffsets[f + 1]; k++)
+            vids.push_back(rank[findices[k]] + 1);
+        face_id_vids.insert(face_id_vids.end(), std::make_pair(i + 1, vids));
+        if (!faces[f]->string().empty())
+            face_id_str.insert(face_id_str.end(), std::make_pair(i + 1, faces[f]->string()));
+    }
+
+    for (CEdge* pE : m_edges)
+    {
+        if (pE->string().empty())
+            continue;
+        edge_attrs.push_back(std::make_tuple(rank[vindex[edge_vertex(pE, 0)]] + 1,
+                                             rank[vindex[edge_vertex(pE, 1)]] + 1, pE->string()));
+    }
+
+    for (int i = 0; i < nf; i++)
+    {
+        CDart* pD = D(faces[i]);
+        do
+        {
+            if (!pD->string().empty())
+                corner_attrs.push_back(std::make_tuple(rank[vindex[C0(pD)]] + 1, frank[i] + 1, pD->string()));
+            pD = beta(1, pD);
+        } while (pD != D(faces[i]));
+    }
+
+    // load() unloads the mesh first
+    load(vert_id_point, face_id_vids);
+    load_attributes(vert_id_str, face_id_str, edge_attrs, corner_attrs);
 }
 
 T_TYPENAME
@@ -11,6 +11,7 @@
 #include "DynamicMesh_2.h"
 #include "Iterators_2.h"
 #include "Boundary_2.h"
+#include "Topology_2.h"
 
 #include "BaseMesh_3.h"
 #include "Iterators_3.h"
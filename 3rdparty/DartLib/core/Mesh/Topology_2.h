@@ -0,0 +1,208 @@
+#ifndef _DARTLIB_TOPOLOGY_2_H_
+#define _DARTLIB_TOPOLOGY_2_H_
+
+#include <unordered_map>
+#include <vector>
+
+#include "Iterators_2.h"
+
+namespace DartLib
+{
+/*!
+        \brief CComponent Topology of one connected component.
+*/
+struct CComponent
+{
+    /*! number of vertices, edges, faces and boundary loops */
+    int vertices;
+    int edges;
+    int faces;
+    int boundaries;
+
+    CComponent() : vertices(0), edges(0), faces(0), boundaries(0){};
+
+    /*! Euler characteristic V - E + F */
+    int euler() { return vertices - edges + faces; };
+    /*! genus, from V - E + F = 2 - 2g - b */
+    int genus() { return (2 - euler() - boundaries) / 2; };
+};
+
+/*!
+        \brief TTopology_2 Topology analyzer class.
+
+        Labels the connected components by union-find over the edges, and
+        the boundary loops by union-find over the boundary edges, in linear
+        time, without tracing the loops. The genus of each component follows
+        from its Euler characteristic.
+
+        \tparam M mesh type
+*/
+
+template <class M>
+class TTopology_2
+{
+  public:
+    /*!
+    TTopology_2 constructor, analyzes the mesh
+    \param pMesh pointer to the current mesh
+    */
+    TTopology_2(M* pMesh);
+
+    /*!
+    The connected components.
+    */
+    std::vector<CComponent>& components() { return m_components; }
+    /*!
+    The component of each vertex, in the order of the vertex list.
+    */
+    std::vector<int>& vertex_component() { return m_vertex_component; }
+
+    /*! Euler characteristic of the whole mesh */
+    int euler();
+    /*! sum of the genera of the components */
+    int genus();
+    /*! total number of boundary loops */
+    int boundaries();
+
+    /*! one component without boundary */
+    bool is_closed() { return m_components.size() == 1 && m_components[0].boundaries == 0; }
+    /*! one component of genus zero with one boundary loop */
+    bool is_disk() { return m_components.size() == 1 && m_components[0].boundaries == 1 && m_components[0].genus() == 0; }
+
+  protected:
+    /*! root of the set of i, halving the path */
+    int _find(std::vector<int>& parent, int i);
+    /*! merge the sets of i and j */
+    void _union(std::vector<int>& parent, int i, int j);
+
+  protected:
+    /*!
+            Pointer to the current mesh.
+    */
+    M* m_pMesh;
+    /*!
+            The connected components.
+    */
+    std::vector<CComponent> m_components;
+    /*!
+            The component of each vertex.
+    */
+    std::vector<int> m_vertex_component;
+};
+
+template <class M>
+int TTopology_2<M>::_find(std::vector<int>& parent, int i)
+{
+    while (parent[i] != i)
+    {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+template <class M>
+void TTopology_2<M>::_union(std::vector<int>& parent, int i, int j)
+{
+    i = _find(parent, i);
+    j = _find(parent, j);
+    if (i == j)
+        return;
+    // the smaller index becomes the root, so the roots are found in vertex order
+    if (i < j)
+        parent[j] = i;
+    else
+        parent[i] = j;
+}
+
+template <class M>
+TTopology_2<M>::TTopology_2(M* pMesh)
+{
+    m_pMesh = pMesh;
+
+    // index the vertices
+    const int nv = m_pMesh->numVertices();
+    std::unordered_map<typename M::CVertex*, int> index;
+    index.reserve(nv);
+    for (typename M::MeshVertexIterator viter(m_pMesh); !viter.end(); viter++)
+    {
+        int i = (int)index.size();
+        index[*viter] = i;
+    }
+
+    // components by the edges, boundary loops by the boundary edges
+    std::vector<int> parent(nv), loop(nv);
+    std::vector<bool> on_boundary(nv, false);
+    for (int i = 0; i < nv; i++)
+    {
+        parent[i] = i;
+        loop[i] = i;
+    }
+    for (typename M::MeshEdgeIterator eiter(m_pMesh); !eiter.end(); eiter++)
+    {
+        typename M::CEdge* e = *eiter;
+        int i = index[m_pMesh->edgeVertex(e, 0)];
+        int j = index[m_pMesh->edgeVertex(e, 1)];
+        _union(parent, i, j);
+        if (!m_pMesh->isBoundary(e))
+            continue;
+        _union(loop, i, j);
+        on_boundary[i] = true;
+        on_boundary[j] = true;
+    }
+
+    // number the components in vertex order, then count
+    m_vertex_component.assign(nv, -1);
+    for (int i = 0; i < nv; i++)
+    {
+        int r = _find(parent, i);
+        if (m_vertex_component[r] < 0)
+        {
+            m_vertex_component[r] = (int)m_components.size();
+            m_components.push_back(CComponent());
+        }
+        m_vertex_component[i] = m_vertex_component[r];
+
+        CComponent& c = m_components[m_vertex_component[i]];
+        c.vertices++;
+        if (on_boundary[i] && _find(loop, i) == i)
+            c.boundaries++;
+    }
+    for (typename M::MeshEdgeIterator eiter(m_pMesh); !eiter.end(); eiter++)
+        m_components[m_vertex_component[index[m_pMesh->edgeVertex(*eiter, 0)]]].edges++;
+    for (typename M::MeshFaceIterator fiter(m_pMesh); !fiter.end(); fiter++)
+    {
+        typename M::CHalfEdge* he = m_pMesh->faceHalfedge(*fiter);
+        m_components[m_vertex_component[index[m_pMesh->halfedgeTarget(he)]]].faces++;
+    }
+}
+
+template <class M>
+int TTopology_2<M>::euler()
+{
+    int chi = 0;
+    for (size_t i = 0; i < m_components.size(); i++)
+        chi += m_components[i].euler();
+    return chi;
+}
+
+template <class M>
+int TTopology_2<M>::genus()
+{
+    int g = 0;
+    for (size_t i = 0; i < m_components.size(); i++)
+        g += m_components[i].genus();
+    return g;
+}
+
+template <class M>
+int TTopology_2<M>::boundaries()
+{
+    int b = 0;
+    for (size_t i = 0; i < m_components.size(); i++)
+        b += m_components[i].boundaries;
+    return b;
+}
+
+} // namespace DartLib
+#endif //! _DARTLIB_TOPOLOGY_2_H_
@@ -9,220 +9,350 @@
 #ifndef _DARTLIB_PARSER_H_
 #define _DARTLIB_PARSER_H_
 
+#include <stdlib.h>
+#include <string.h>
 #include <string>
-#include <assert.h>
-#include <list>
 #include <sstream>
+#include <vector>
+
+#include "writer.h"
 
 namespace DartLib
 {
 
 /*!
- *	\brief CToken  class, key=(value), e.g. uv=(x y)
-*/
-
-class CToken
+ *	\brief CTokenView class, a token key=(value) seen in place in the trait string
+ *
+ *	Nothing is copied, the key and the value point into the string, which
+ *	has to outlive the view. The value keeps its parentheses.
+ */
+class CTokenView
 {
 public:
-	/*! key of the token */
-	std::string m_key;
-	/*! value of the token */
-	std::string m_value;
-};
+	CTokenView() : m_key( NULL ), m_key_size( 0 ), m_value( NULL ), m_value_size( 0 ) {};
 
-/*!
- *	\brief CParser class
-*/
+	/*! whether the key of the token is key */
+	bool is( const char * key ) const
+	{
+		return strncmp( m_key, key, m_key_size ) == 0 && key[m_key_size] == 0;
+	};
+
+	/*! whether the token has a value */
+	bool has_value() const { return m_value_size > 0; };
 
-class CParser
-{
-public:
 	/*!
-	 *	\brief CParser constructor
-	 *  \param str input string
+	 *	read the numbers of the value, (x y z)
+	 *	\param v the numbers
+	 *	\param n the number of numbers to read at most
+	 *	\return the number of numbers read
 	 */
-	CParser( const std::string & str)
+	int numbers( double * v, int n ) const
 	{
-		//copy string
-		unsigned int i;
-		for(  i = 0; i < str.length(); i ++ )
+		const char * pt  = m_value;
+		const char * end = m_value + m_value_size;
+		int k = 0;
+		while( k < n && pt < end )
 		{
-			m_line[i] = str.c_str()[i];
+			while( pt < end && ( *pt == '(' || *pt == ' ' ) ) pt ++;
+			if( pt >= end ) break;
+			char * e;
+			double d = strtod( pt, &e );
+			if( e == pt || e > end ) break;
+			v[k ++] = d;
+			pt = e;
 		}
-		m_line[i] = 0;
-
-		m_pt = m_line;
-		
-		//while not reaching the end
-		while( !end() )
-		{
-			skip_blank();
-			if( end() ) break;
-
-			//copy key
-
-			char * pkey = m_key;
-			char   ch = next_char();
-
-			while( ch != ' ' && ch != '=' && !end() )
-			{
-				*pkey ++ = ch;
-				ch = next_char();
-			}
-			if( ch != '=' && ch != ' ')
-				*pkey++ = ch;
-
-			*pkey = 0;
-
-			if( ch == ' ' )
-			{
-				skip_blank();
-			}
-
-			if( ch != '=' )
-			{
-				CToken *	tk = new CToken;
-				assert(tk);
-				tk->m_key  = std::string( m_key );
-				
-				m_tokens.push_back( tk );
-				continue;
-			}
-
-			if( end() ) break;
+		return k;
+	};
 
-			ch = next_char();
+	/*! key of the token, not terminated */
+	const char * m_key;
+	/*! length of the key */
+	size_t       m_key_size;
+	/*! value of the token with its parentheses, not terminated, NULL if there is none */
+	const char * m_value;
+	/*! length of the value */
+	size_t       m_value_size;
+};
 
-			while( ch != '(' ) ch = next_char();
+/*!
+ *	\brief CTokenizer class, walks the tokens of a trait string without allocating
+ *
+ *	The grammar is the one of CParser, blank separated tokens, key or key=(value).
+ *	\code
+ *	CTokenizer tokenizer( pV->string() );
+ *	CTokenView token;
+ *	while( tokenizer.next( token ) )
+ *		if( token.is( "uv" ) ) ...
+ *	\endcode
+ */
+class CTokenizer
+{
+public:
+	/*!
+	 *	\brief CTokenizer constructor
+	 *	\param str the trait string, it is not copied
+	 */
+	CTokenizer( const std::string & str ) : m_pt( str.c_str() ) {};
+	/*!
+	 *	\brief CTokenizer constructor
+	 *	\param str a zero terminated trait string, it is not copied
+	 */
+	CTokenizer( const char * str ) : m_pt( str ) {};
 
-			char * pvalue = m_value;
+	/*!
+	 *	read the next token
+	 *	\param token the token
+	 *	\return false at the end of the string
+	 */
+	bool next( CTokenView & token )
+	{
+		while( *m_pt == ' ' ) m_pt ++;
+		if( *m_pt == 0 ) return false;
 
-			while( ch != ')' && !end() )
-			{
-				*pvalue ++ = ch;
-				ch = next_char();
-			}
-			*pvalue++ = ch;
-			*pvalue  = 0;
-
-			CToken *	tk = new CToken;
-			assert(tk);
-			tk->m_key   = std::string( m_key   );
-			tk->m_value = std::string( m_value );
-			
-			m_tokens.push_back( tk );
-			
-		}
+		token.m_key = m_pt;
+		while( *m_pt != 0 && *m_pt != ' ' && *m_pt != '=' ) m_pt ++;
+		token.m_key_size   = m_pt - token.m_key;
+		token.m_value      = NULL;
+		token.m_value_size = 0;
+		if( *m_pt != '=' ) return true;
 
+		m_pt ++;
+		while( *m_pt != 0 && *m_pt != '(' ) m_pt ++;
+		token.m_value = m_pt;
+		while( *m_pt != 0 && *m_pt != ')' ) m_pt ++;
+		if( *m_pt == ')' ) m_pt ++;
+		token.m_value_size = m_pt - token.m_value;
+		return true;
 	};
 
+private:
+	/*! current position in the string */
+	const char * m_pt;
+};
+
+/*!
+ *	\brief CParser class, the tokens of a trait string, key=(value), e.g. uv=(x y)
+ *
+ *	The tokens are CTokenView, seen in place in the string, which is neither
+ *	copied nor allowed to change while the parser is in use. Up to INLINE_TOKENS
+ *	tokens are kept in the parser itself, so parsing a usual trait string does
+ *	not allocate. Removing tokens and writing the string back into its own
+ *	buffer does not allocate either.
+ *	\code
+ *	CParser parser( m_string );
+ *	parser._removeToken( "uv" );
+ *	parser._toString( m_string );
+ *	CParser::_appendToken( m_string, "uv", v, 2 );
+ *	\endcode
+ */
+class CParser
+{
+public:
 	/*!
-	 *	CParser Destructor
+	 *	\brief CParser constructor
+	 *  \param str input string, it has to outlive the parser
 	 */
-	~CParser()
+	CParser( const std::string & str ) : m_tokens( m_inline ), m_size( 0 )
 	{
-	  //release all the tokens
-
-	  for( std::list<CToken*>::iterator titer = m_tokens.begin(); titer != m_tokens.end(); titer ++ )
-	  {
-		  CToken * pT = *titer;
-		  delete pT;
-	  }
-	  m_tokens.clear();
+		_parse( str.c_str() );
 	};
 
+	/*! number of tokens */
+	size_t size() const { return m_size; };
+	/*! the i-th token */
+	const CTokenView & operator[]( size_t i ) const { return m_tokens[i]; };
+	/*! first token */
+	const CTokenView * begin() const { return m_tokens; };
+	/*! past the last token */
+	const CTokenView * end() const { return m_tokens + m_size; };
+
 	/*!
-	 *	List of tokens extracted from the string
+	 *	the first token of a key
+	 *	\return the token, NULL if there is none
 	 */
-	std::list<CToken*> & tokens() { return m_tokens; };
-	
+	const CTokenView * find( const char * key ) const
+	{
+		for( size_t i = 0; i < m_size; i ++ )
+		{
+			if( m_tokens[i].is( key ) ) return m_tokens + i;
+		}
+		return NULL;
+	};
+
 	/*!
 	 *	Convert the list of tokens to a string
-	 *  \param str the output string
+	 *  \param str the output string, it may be the parsed string, which is then rewritten in place
 	 */
 	void _toString( std::string & str )
 	{
-		std::stringstream iss;
+		if( str.c_str() == m_source && _fits() )
+		{
+			char * buffer = &str[0];
+			size_t n = 0;
+			for( size_t i = 0; i < m_size; i ++ )
+			{
+				const CTokenView & token = m_tokens[i];
+				if( n > 0 ) buffer[n ++] = ' ';
+				memmove( buffer + n, token.m_key, token.m_key_size );
+				n += token.m_key_size;
+				if( token.m_value == NULL ) continue;
+				buffer[n ++] = '=';
+				memmove( buffer + n, token.m_value, token.m_value_size );
+				n += token.m_value_size;
+			}
+			str.resize( n );
+			_parse( str.c_str() );
+			return;
+		}
 
-		for( std::list<CToken*>::iterator iter = m_tokens.begin() ; iter != m_tokens.end(); ++ iter )
+		if( str.c_str() != m_source )
 		{
-			  CToken * token = *iter;
-			  if( iss.str().length() > 0 ) iss << " ";
-			  if( token->m_value.empty() )
-			  {
-				iss << token->m_key;
-			  }
-			  else
-			  {
-				iss << token->m_key << "=" << token->m_value;			  
-			  }
+			str.clear();
+			_write( str );
+			return;
 		}
 
-		str = iss.str();
+		std::string out;
+		_write( out );
+		str.swap( out );
+		_parse( str.c_str() );
 	};
+
 	/*!
 	 *	Remove the token key=(...) from the current string
 	 *  \param key the key to the token to be removed
 	 */
-	void _removeToken( const std::string & key )	
+	void _removeToken( const char * key )
+	{
+		for( size_t i = 0; i < m_size; i ++ )
+		{
+			if( !m_tokens[i].is( key ) ) continue;
+			memmove( m_tokens + i, m_tokens + i + 1, ( m_size - i - 1 ) * sizeof( CTokenView ) );
+			m_size --;
+			return;
+		}
+	};
+
+	/*!
+	 *	Append the token key=(v0 v1 ...) to a string, the numbers are written as an ostream does
+	 *	\param str the string
+	 *	\param key the key of the token
+	 *	\param v the numbers
+	 *	\param n the number of numbers
+	 */
+	static void _appendToken( std::string & str, const char * key, const double * v, int n )
 	{
-		for( std::list<CToken*>::iterator iter = m_tokens.begin() ; iter != m_tokens.end(); ++ iter )
+		char buffer[32];
+		if( !str.empty() ) str += ' ';
+		str += key;
+		str += "=(";
+		for( int i = 0; i < n; i ++ )
 		{
-			  CToken * token = *iter;
-			  if( token->m_key == key )
-			  {
-				  m_tokens.erase( iter );
-				  return;
-			  }
+			if( i > 0 ) str += ' ';
+			int k = _format( buffer, sizeof( buffer ), v[i] );
+			str.append( buffer, k );
 		}
+		str += ')';
 	};
 
 private:
+	enum { INLINE_TOKENS = 16 };
+
+	CParser( const CParser & );
+	CParser & operator=( const CParser & );
 
 	/*!
-	 *	get the next char in the current string
+	 *	write a number as an ostream does, "%g"
+	 *	\return the number of characters
 	 */
-	char next_char()
+	static int _format( char * buffer, size_t size, double v ) { return CTextBuffer::format( buffer, size, v ); };
+
+	/*!
+	 *	tokenize a string
+	 */
+	void _parse( const char * str )
 	{
-		char ch= *m_pt;
-		m_pt++;
-		return ch;
+		m_source = str;
+		m_tokens = m_inline;
+		m_size   = 0;
+		CTokenizer tokenizer( str );
+		CTokenView token;
+		while( tokenizer.next( token ) )
+		{
+			if( m_size == INLINE_TOKENS && m_tokens == m_inline )
+			{
+				m_more.assign( m_inline, m_inline + m_size );
+				m_tokens = NULL;
+			}
+			if( m_tokens == m_inline )
+			{
+				m_inline[m_size ++] = token;
+				continue;
+			}
+			m_more.resize( m_size );
+			m_more.push_back( token );
+			m_tokens = &m_more[0];
+			m_size ++;
+		}
 	};
+
 	/*!
-	 *	skip blank spaces
+	 *	append the tokens to a string other than the parsed one
 	 */
-	void skip_blank()
+	void _write( std::string & out ) const
 	{
-		while( *m_pt == ' ' ) m_pt++;
+		for( size_t i = 0; i < m_size; i ++ )
+		{
+			const CTokenView & token = m_tokens[i];
+			if( !out.empty() ) out += ' ';
+			out.append( token.m_key, token.m_key_size );
+			if( token.m_value == NULL ) continue;
+			out += '=';
+			out.append( token.m_value, token.m_value_size );
+		}
 	};
+
 	/*!
-	 *	verify if we 
+	 *	whether the tokens, written back one blank apart, never overtake their
+	 *	place in the parsed string, so the string can be rewritten in place
 	 */
-	bool end()
+	bool _fits() const
 	{
-		return ( (*m_pt) == 0 );
+		size_t n = 0;
+		for( size_t i = 0; i < m_size; i ++ )
+		{
+			const CTokenView & token = m_tokens[i];
+			if( n > 0 ) n ++;
+			if( m_source + n > token.m_key ) return false;
+			n += token.m_key_size;
+			if( token.m_value == NULL ) continue;
+			n ++;
+			if( m_source + n > token.m_value ) return false;
+			n += token.m_value_size;
+		}
+		return true;
 	};
+
 	/*!
-	 *	list of tokens
+	 *	the tokens, m_inline or m_more
 	 */
-	std::list<CToken*> m_tokens;
-	
+	CTokenView * m_tokens;
 	/*!
-	 * The buffer to contain the string
+	 *	number of tokens
 	 */
-	char m_line[1024];
+	size_t m_size;
 	/*!
-	 *	current key
+	 *	the first tokens
 	 */
-	char m_key[1024];
+	CTokenView m_inline[INLINE_TOKENS];
 	/*!
-	 *	current value
+	 *	all the tokens, when there are more than INLINE_TOKENS
 	 */
-	char m_value[1024];
+	std::vector<CTokenView> m_more;
 	/*!
-	 *	current pointer to the char buffer
+	 *	the parsed string
 	 */
-	char * m_pt;
+	const char * m_source;
 };
 
 
@@ -41,24 +41,246 @@
 namespace MeshLib
 {
 
-template<typename M, typename V, typename E, typename F, typename H>
-void _read_vertex_target_k( M * pMesh )
+/*!
+ *	\brief CTraitDecoder class, decodes the trait string of an element in one pass
+ *
+ *	A handler is registered for each key. decode() walks the tokens of the
+ *	string once with a CTokenizer, nothing is allocated, and calls the
+ *	handlers of the keys it meets, so the traits of an element are all read
+ *	by a single tokenization, whatever their number.
+ *	\tparam T element type, vertex, edge, face or halfedge
+ */
+template<typename T>
+class CTraitDecoder
 {
-	for(typename M::MeshVertexIterator viter( pMesh ); !viter.end(); viter ++ )
+public:
+	/*! handler of a key, reads the value of the token into the element */
+	typedef void ( * CHandler )( T * pT, const CTokenView & token );
+	/*! called on each element before its tokens */
+	typedef void ( * CReset )( T * pT );
+
+	CTraitDecoder() : m_reset( NULL ) {};
+
+	/*! register the handler of a key, the key string has to outlive the decoder */
+	void add( const char * key, CHandler handler )
+	{
+		m_keys.push_back( key );
+		m_handlers.push_back( handler );
+	};
+
+	/*! register the function called on each element before its tokens */
+	void reset( CReset reset ) { m_reset = reset; };
+
+	/*! whether there is nothing to decode */
+	bool empty() const { return m_handlers.empty() && m_reset == NULL; };
+
+	/*!
+	 *	decode the trait string of an element
+	 *	\return the number of tokens handled
+	 */
+	int decode( T * pT ) const { return decode( pT, pT->string() ); };
+
+	/*!
+	 *	decode a trait string into an element
+	 *	\return the number of tokens handled
+	 */
+	int decode( T * pT, const std::string & str ) const
+	{
+		if( m_reset != NULL ) m_reset( pT );
+
+		int n = 0;
+		CTokenizer tokenizer( str );
+		CTokenView token;
+		while( tokenizer.next( token ) )
+		{
+			for( size_t i = 0; i < m_keys.size(); i ++ )
+			{
+				if( !token.is( m_keys[i] ) ) continue;
+				m_handlers[i]( pT, token );
+				n ++;
+			}
+		}
+		return n;
+	};
+
+protected:
+	std::vector<const char*> m_keys;
+	std::vector<CHandler>    m_handlers;
+	CReset                   m_reset;
+};
+
+/*! decode the traits of all the vertices, \return the number of tokens handled */
+template<typename M, typename V>
+int _decode_vertices( M * pMesh, const CTraitDecoder<V> & decoder )
+{
+	int n = 0;
+	if( decoder.empty() ) return n;
+	// with typed traits, the string of the element and its attributes
+	std::string str;
+	for( typename M::MeshVertexIterator viter( pMesh ); !viter.end(); viter ++ )
 	{
 		V * pV = *viter;
-		CParser parser( pV->string() );
-		
-		for( std::list<CToken*>::iterator iter = parser.tokens().begin() ; iter != parser.tokens().end(); ++ iter )
+		if( !pMesh->typed_traits() )
+		{
+			n += decoder.decode( pV );
+			continue;
+		}
+		str = pV->string();
+		pMesh->vertex_attributes().format( pV->handle(), str );
+		n += decoder.decode( pV, str );
+	}
+	return n;
+};
+
+/*! decode the traits of all the edges, \return the number of tokens handled */
+template<typename M, typename E>
+int _decode_edges( M * pMesh, const CTraitDecoder<E> & decoder )
+{
+	int n = 0;
+	if( decoder.empty() ) return n;
+	// with typed traits, the string of the element and its attributes
+	std::string str;
+	for( typename M::MeshEdgeIterator eiter( pMesh ); !eiter.end(); eiter ++ )
+	{
+		E * pE = *eiter;
+		if( !pMesh->typed_traits() )
 		{
-		  CToken * token = *iter;
-		  if( token->m_key == "k" )
-		  {
-			  std::string line = strutil::trim( token->m_value, "()");
-			  pV->target_k() = strutil::parseString<double>( line );	
-		  }
+			n += decoder.decode( pE );
+			continue;
 		}
+		str = pE->string();
+		pMesh->edge_attributes().format( pE->handle(), str );
+		n += decoder.decode( pE, str );
 	}
+	return n;
+};
+
+/*! decode the traits of all the faces, \return the number of tokens handled */
+template<typename M, typename F>
+int _decode_faces( M * pMesh, const CTraitDecoder<F> & decoder )
+{
+	int n = 0;
+	if( decoder.empty() ) return n;
+	// with typed traits, the string of the element and its attributes
+	std::string str;
+	for( typename M::MeshFaceIterator fiter( pMesh ); !fiter.end(); fiter ++ )
+	{
+		F * pF = *fiter;
+		if( !pMesh->typed_traits() )
+		{
+			n += decoder.decode( pF );
+			continue;
+		}
+		str = pF->string();
+		pMesh->face_attributes().format( pF->handle(), str );
+		n += decoder.decode( pF, str );
+	}
+	return n;
+};
+
+/*
+ *	handlers of the traits, k=(k) uv=(u v) z=(x y) mu=(x y) father=(id)
+ *	normal=(x y z) rgb=(r g b) l=(length) sharp
+ */
+
+template<typename V>
+void _decode_vertex_target_k( V * pV, const CTokenView & token )
+{
+	double k = 0;
+	token.numbers( &k, 1 );
+	pV->target_k() = k;
+};
+
+template<typename V>
+void _decode_vertex_uv( V * pV, const CTokenView & token )
+{
+	double v[2] = { 0, 0 };
+	token.numbers( v, 2 );
+	pV->uv() = CPoint2( v[0], v[1] );
+};
+
+template<typename V>
+void _decode_vertex_huv( V * pV, const CTokenView & token )
+{
+	double v[2] = { 0, 0 };
+	token.numbers( v, 2 );
+	pV->huv() = CPoint2( v[0], v[1] );
+};
+
+template<typename V>
+void _decode_vertex_z( V * pV, const CTokenView & token )
+{
+	double v[2] = { 0, 0 };
+	token.numbers( v, 2 );
+	pV->z() = std::complex<double>( v[0], v[1] );
+};
+
+template<typename V>
+void _decode_vertex_mu( V * pV, const CTokenView & token )
+{
+	double v[2] = { 0, 0 };
+	token.numbers( v, 2 );
+	pV->mu() = std::complex<double>( v[0], v[1] );
+};
+
+template<typename V>
+void _decode_vertex_father( V * pV, const CTokenView & token )
+{
+	double father = 0;
+	token.numbers( &father, 1 );
+	pV->father() = (int) father;
+};
+
+template<typename V>
+void _decode_vertex_normal( V * pV, const CTokenView & token )
+{
+	double v[3] = { 0, 0, 0 };
+	token.numbers( v, 3 );
+	pV->normal() = CPoint( v[0], v[1], v[2] );
+};
+
+template<typename V>
+void _decode_vertex_rgb( V * pV, const CTokenView & token )
+{
+	double v[3] = { 0, 0, 0 };
+	token.numbers( v, 3 );
+	pV->rgb() = CPoint( v[0], v[1], v[2] );
+};
+
+template<typename E>
+void _decode_edge_length( E * pE, const CTokenView & token )
+{
+	double l = 0;
+	token.numbers( &l, 1 );
+	pE->length() = l;
+};
+
+template<typename E>
+void _clear_edge_sharp( E * pE )
+{
+	pE->sharp() = false;
+};
+
+template<typename E>
+void _decode_edge_sharp( E * pE, const CTokenView & token )
+{
+	pE->sharp() = true;
+};
+
+template<typename F>
+void _decode_face_mu( F * pF, const CTokenView & token )
+{
+	double v[2] = { 0, 0 };
+	token.numbers( v, 2 );
+	pF->mu() = std::complex<double>( v[0], v[1] );
+};
+
+template<typename M, typename V, typename E, typename F, typename H>
+void _read_vertex_target_k( M * pMesh )
+{
+	CTraitDecoder<V> decoder;
+	decoder.add( "k", _decode_vertex_target_k<V> );
+	_decode_vertices<M>( pMesh, decoder );
 };
 
 
@@ -115,64 +337,25 @@ void _write_vertex_huv( M * pMesh )
 template<typename M, typename V, typename E, typename F, typename H>
 void _read_vertex_uv( M * pMesh )
 {
-	for(typename M::MeshVertexIterator viter( pMesh ); !viter.end(); viter ++ )
-	{
-		V * pV = *viter;
-		CParser parser( pV->string() );
-		
-		for( std::list<CToken*>::iterator iter = parser.tokens().begin() ; iter != parser.tokens().end(); ++ iter )
-		{
-		  CToken * token = *iter;
-		  if( token->m_key == "uv" )
-		  {
-			  CPoint2 uv;
-			  token->m_value >> uv;
-			  pV->uv() = uv;
-		  }
-		}
-	}
+	CTraitDecoder<V> decoder;
+	decoder.add( "uv", _decode_vertex_uv<V> );
+	_decode_vertices<M>( pMesh, decoder );
 };
 
 template<typename M>
 void __read_vertex_uv( M * pMesh )
 {
-	for(typename M::MeshVertexIterator viter( pMesh ); !viter.end(); viter ++ )
-	{
-		typename M::CVertex * pV = *viter;
-		CParser parser( pV->string() );
-		
-		for( std::list<CToken*>::iterator iter = parser.tokens().begin() ; iter != parser.tokens().end(); ++ iter )
-		{
-		  CToken * token = *iter;
-		  if( token->m_key == "uv" )
-		  {
-			  CPoint2 uv;
-			  token->m_value >> uv;
-			  pV->uv() = uv;
-		  }
-		}
-	}
+	CTraitDecoder<typename M::CVertex> decoder;
+	decoder.add( "uv", _decode_vertex_uv<typename M::CVertex> );
+	_decode_vertices<M>( pMesh, decoder );
 };
 
 template<typename M, typename V, typename E, typename F, typename H>
 void _read_vertex_z( M * pMesh )
 {
-	for(typename M::MeshVertexIterator viter( pMesh ); !viter.end(); viter ++ )
-	{
-		V * pV = *viter;
-		CParser parser( pV->string() );
-		
-		for( std::list<CToken*>::iterator iter = parser.tokens().begin() ; iter != parser.tokens().end(); ++ iter )
-		{
-		  CToken * token = *iter;
-		  if( token->m_key == "z" )
-		  {
-			  CPoint2 uv;
-			  token->m_value >> uv;
-			  pV->z() = std::complex<double>( uv[0], uv[1] );
-		  }
-		}
-	}
+	CTraitDecoder<V> decoder;
+	decoder.add( "z", _decode_vertex_z<V> );
+	_decode_vertices<M>( pMesh, decoder );
 };
 
 
@@ -180,237 +363,93 @@ void _read_vertex_z( M * pMesh )
 template<typename M>
 void _read_vertex_huv( M * pMesh )
 {
-	for(typename M::MeshVertexIterator viter( pMesh ); !viter.end(); viter ++ )
-	{
-		typename M::CVertex * pV = *viter;
-		CParser parser( pV->string() );
-		
-		for( std::list<CToken*>::iterator iter = parser.tokens().begin() ; iter != parser.tokens().end(); ++ iter )
-		{
-		  CToken * token = *iter;
-		  if( token->m_key == "uv" )
-		  {
-			  CPoint2 uv;
-			  token->m_value >> uv;
-			  pV->huv() = uv;
-		  }
-		}
-	}
+	CTraitDecoder<typename M::CVertex> decoder;
+	decoder.add( "uv", _decode_vertex_huv<typename M::CVertex> );
+	_decode_vertices<M>( pMesh, decoder );
 };
 
 template<typename M, typename V, typename E, typename F, typename H>
 void _read_vertex_father( M * pMesh )
 {
-	for(typename M::MeshVertexIterator viter( pMesh ); !viter.end(); viter ++ )
-	{
-		V * pV = *viter;
-		CParser parser( pV->string() );
-		
-		for( std::list<CToken*>::iterator iter = parser.tokens().begin() ; iter != parser.tokens().end(); ++ iter )
-		{
-		  CToken * token = *iter;
-		  if( token->m_key == "father" )
-		  {
-			  std::string line = strutil::trim( token->m_value, "()");
-			  pV->father() = strutil::parseString<int>( line );	
-		  }
-		}
-	}
+	CTraitDecoder<V> decoder;
+	decoder.add( "father", _decode_vertex_father<V> );
+	_decode_vertices<M>( pMesh, decoder );
 };
 
 template<typename M>
 void _read_vertex_father_trait( M * pMesh )
 {
-	for(typename M::MeshVertexIterator viter( pMesh ); !viter.end(); viter ++ )
-	{
-		typename M::CVertex * pV = *viter;
-		CParser parser( pV->string() );
-		
-		for( std::list<CToken*>::iterator iter = parser.tokens().begin() ; iter != parser.tokens().end(); ++ iter )
-		{
-		  CToken * token = *iter;
-		  if( token->m_key == "father" )
-		  {
-			  std::string line = strutil::trim( token->m_value, "()");
-			  pV->father() = strutil::parseString<int>( line );	
-		  }
-		}
-	}
+	CTraitDecoder<typename M::CVertex> decoder;
+	decoder.add( "father", _decode_vertex_father<typename M::CVertex> );
+	_decode_vertices<M>( pMesh, decoder );
 };
 
 
 template<typename M, typename V, typename E, typename F, typename H>
 void _read_vertex_mu( M * pMesh )
 {
-	for(typename M::MeshVertexIterator viter( pMesh ); !viter.end(); viter ++ )
-	{
-		V * pV = *viter;
-		CParser parser( pV->string() );
-		
-		for( std::list<CToken*>::iterator iter = parser.tokens().begin() ; iter != parser.tokens().end(); ++ iter )
-		{
-		  CToken * token = *iter;
-		  if( token->m_key == "mu" )
-		  {
-			  CPoint2 uv;
-			  token->m_value >> uv;
-			  pV->mu() = std::complex<double>( uv[0], uv[1] );
-		  }
-		}
-	}
+	CTraitDecoder<V> decoder;
+	decoder.add( "mu", _decode_vertex_mu<V> );
+	_decode_vertices<M>( pMesh, decoder );
 };
 
 template<typename M, typename V, typename E, typename F, typename H>
 void _read_vertex_normal( M * pMesh )
 {
-	for(typename M::MeshVertexIterator viter( pMesh ); !viter.end(); viter ++ )
-	{
-		V * pV = *viter;
-		CParser parser( pV->string() );
-		
-		for( std::list<CToken*>::iterator iter = parser.tokens().begin() ; iter != parser.tokens().end(); ++ iter )
-		{
-		  CToken * token = *iter;
-		  if( token->m_key == "normal" )
-		  {
-			  CPoint normal;
-			  token->m_value >> normal;
-			  pV->normal() = normal;
-		  }
-		}
-	}
+	CTraitDecoder<V> decoder;
+	decoder.add( "normal", _decode_vertex_normal<V> );
+	_decode_vertices<M>( pMesh, decoder );
 };
 
 
 template<typename M>
 bool __read_vertex_normal( M * pMesh )
 {
-	bool has_normal = false;
-
-	for(typename M::MeshVertexIterator viter( pMesh ); !viter.end(); viter ++ )
-	{
-		typename M::CVertex * pV = *viter;
-		CParser parser( pV->string() );
-		
-		for( std::list<CToken*>::iterator iter = parser.tokens().begin() ; iter != parser.tokens().end(); ++ iter )
-		{
-		  CToken * token = *iter;
-		  if( token->m_key == "normal" )
-		  {
-			  CPoint normal;
-			  token->m_value >> normal;
-			  pV->normal() = normal;
-			  has_normal = true;
-		  }
-		}
-	}
-	return has_normal;
+	CTraitDecoder<typename M::CVertex> decoder;
+	decoder.add( "normal", _decode_vertex_normal<typename M::CVertex> );
+	return _decode_vertices<M>( pMesh, decoder ) > 0;
 };
 
 
 template<typename M, typename V, typename E, typename F, typename H>
 void _read_vertex_rgb( M * pMesh )
 {
-	for(typename M::MeshVertexIterator viter( pMesh ); !viter.end(); viter ++ )
-	{
-		V * pV = *viter;
-		CParser parser( pV->string() );
-		
-		for( std::list<CToken*>::iterator iter = parser.tokens().begin() ; iter != parser.tokens().end(); ++ iter )
-		{
-		  CToken * token = *iter;
-		  if( token->m_key == "rgb" )
-		  {
-			  CPoint rgb;
-			  token->m_value >> rgb;
-			  pV->rgb() = rgb;
-		  }
-		}
-	}
+	CTraitDecoder<V> decoder;
+	decoder.add( "rgb", _decode_vertex_rgb<V> );
+	_decode_vertices<M>( pMesh, decoder );
 };
 
 template<typename M>
 void _read_vertex_rgb_trait( M * pMesh )
 {
-	for(typename M::MeshVertexIterator viter( pMesh ); !viter.end(); viter ++ )
-	{
-		typename M::CVertex * pV = *viter;
-		CParser parser( pV->string() );
-		
-		for( std::list<CToken*>::iterator iter = parser.tokens().begin() ; iter != parser.tokens().end(); ++ iter )
-		{
-		  CToken * token = *iter;
-		  if( token->m_key == "rgb" )
-		  {
-			  CPoint rgb;
-			  token->m_value >> rgb;
-			  pV->rgb() = rgb;
-		  }
-		}
-	}
+	CTraitDecoder<typename M::CVertex> decoder;
+	decoder.add( "rgb", _decode_vertex_rgb<typename M::CVertex> );
+	_decode_vertices<M>( pMesh, decoder );
 };
 
 template<typename M, typename V, typename E, typename F, typename H>
 void _read_edge_length( M * pMesh )
 {
-	for(typename M::MeshEdgeIterator eiter( pMesh ); !eiter.end(); eiter ++ )
-	{
-		E * pE = *eiter;
-
-		CParser parser( pE->string() );
-
-		for( std::list<CToken*>::iterator iter = parser.tokens().begin() ; iter != parser.tokens().end(); ++ iter )
-		{
-		  CToken * token = *iter;
-		  if( token->m_key == "l" )
-		  {
-			 std::string line = strutil::trim( token->m_value, "()");
-			 pE->length() = strutil::parseString<double>(line) ;		
-		  }
-		}
-	}
+	CTraitDecoder<E> decoder;
+	decoder.add( "l", _decode_edge_length<E> );
+	_decode_edges<M>( pMesh, decoder );
 };
 
 template<typename M>
 void _read_edge_length_trait( M * pMesh )
 {
-	for(typename M::MeshEdgeIterator eiter( pMesh ); !eiter.end(); eiter ++ )
-	{
-		typename M::CEdge * pE = *eiter;
-
-		CParser parser( pE->string() );
-
-		for( std::list<CToken*>::iterator iter = parser.tokens().begin() ; iter != parser.tokens().end(); ++ iter )
-		{
-		  CToken * token = *iter;
-		  if( token->m_key == "l" )
-		  {
-			 std::string line = strutil::trim( token->m_value, "()");
-			 pE->length() = strutil::parseString<double>(line) ;		
-		  }
-		}
-	}
+	CTraitDecoder<typename M::CEdge> decoder;
+	decoder.add( "l", _decode_edge_length<typename M::CEdge> );
+	_decode_edges<M>( pMesh, decoder );
 };
 
 template<typename M, typename V, typename E, typename F, typename H>
 void _read_edge_sharp( M * pMesh )
 {
-	for(typename M::MeshEdgeIterator eiter( pMesh ); !eiter.end(); eiter ++ )
-	{
-		E * pE = *eiter;
-
-		CParser parser( pE->string() );
-		pE->sharp() = false;
-
-		for( std::list<CToken*>::iterator iter = parser.tokens().begin() ; iter != parser.tokens().end(); ++ iter )
-		{
-		  CToken * token = *iter;
-		  if( token->m_key == "sharp" )
-		  {
-			  pE->sharp() = true;
-		  }
-		}
-	}
+	CTraitDecoder<E> decoder;
+	decoder.add( "sharp", _decode_edge_sharp<E> );
+	decoder.reset( _clear_edge_sharp<E> );
+	_decode_edges<M>( pMesh, decoder );
 };
 
 template<typename M, typename V, typename E, typename F, typename H>
@@ -543,6 +582,8 @@ void _write_edge_sharp( M * pMesh )
 		E * pE = *eiter;
 		CParser parser( pE->string() );
 		parser._removeToken( "sharp" );
+		// the string holds the flag, the column would restore a cleared one
+		if( pMesh->typed_traits() ) pMesh->edge_attributes().remove( pE->handle(), "sharp" );
 		parser._toString( pE->string() );
 		
 		std::string line;
@@ -587,65 +628,75 @@ void _write_edge_du( M * pMesh )
 };
 
 
+/*!
+ *	read the traits selected by M::m_input_traits, the trait string of
+ *	each element is tokenized once for all of them
+ */
 template<typename M, typename V, typename E, typename F, typename H>
 void _input_traits( M * pMesh )
 {
-	if( M::m_input_traits |= VERTEX_UV )
+	CTraitDecoder<V> vdecoder;
+	CTraitDecoder<E> edecoder;
+
+	if( M::m_input_traits & VERTEX_UV )
 	{
-		_read_vertex_uv<M,V,E,F,H>( pMesh );
+		vdecoder.add( "uv", _decode_vertex_uv<V> );
 	}
 
-	if( M::m_input_traits |= VERTEX_NORMAL )
+	if( M::m_input_traits & VERTEX_NORMAL )
 	{
-		_read_vertex_normal<M,V,E,F,H>( pMesh );
+		vdecoder.add( "normal", _decode_vertex_normal<V> );
 	}
 
-	if( M::m_input_traits |= VERTEX_RGB )
+	if( M::m_input_traits & VERTEX_RGB )
 	{
-		_read_vertex_rgb( pMesh );
+		vdecoder.add( "rgb", _decode_vertex_rgb<V> );
 	}
 
-	if( M::m_input_traits |= EDGE_LENGTH )
+	if( M::m_input_traits & EDGE_LENGTH )
 	{
-		_read_edge_length( pMesh );
+		edecoder.add( "l", _decode_edge_length<E> );
 	}
 
-	if( M::m_input_traits |= EDGE_SHARP )
+	if( M::m_input_traits & EDGE_SHARP )
 	{
-		_read_edge_sharp( pMesh );
+		edecoder.add( "sharp", _decode_edge_sharp<E> );
+		edecoder.reset( _clear_edge_sharp<E> );
 	}
 
+	_decode_vertices<M>( pMesh, vdecoder );
+	_decode_edges<M>( pMesh, edecoder );
 };
 
 template<typename M, typename V, typename E, typename F, typename H>
 void _output_traits( M * pMesh )
 {
-	if( M::m_m_output_traits |= VERTEX_UV )
+	if( M::m_output_traits & VERTEX_UV )
 	{
 		_write_vertex_uv<M,V,E,F,H>( pMesh );
 	}
 
-	if( M::m_m_output_traits |= VERTEX_MU )
+	if( M::m_output_traits & VERTEX_MU )
 	{
 		_write_vertex_mu<M,V,E,F,H>( pMesh );
 	}
 
-	if( M::m_m_output_traits |= VERTEX_RGB )
+	if( M::m_output_traits & VERTEX_RGB )
 	{
 		_write_vertex_rgb<M,V,E,F,H>( pMesh );
 	}
 
-	if( M::m_m_output_traits |= VERTEX_U )
+	if( M::m_output_traits & VERTEX_U )
 	{
 		_write_vertex_u<M,V,E,F,H>( pMesh );
 	}
 
-	if( M::m_m_output_traits |= EDGE_DU )
+	if( M::m_output_traits & EDGE_DU )
 	{
 		_write_edge_du<M,V,E,F,H>( pMesh );
 	}
 
-	if( M::m_m_output_traits |= EDGE_SHARP )
+	if( M::m_output_traits & EDGE_SHARP )
 	{
 		_write_edge_sharp<M,V,E,F,H>( pMesh );
 	}
@@ -681,6 +732,8 @@ void _write_edge_sharp_trait( M * pMesh )
 		typename M::CEdge * pE = *eiter;
 		CParser parser( pE->string() );
 		parser._removeToken( "sharp" );
+		// the string holds the flag, the column would restore a cleared one
+		if( pMesh->typed_traits() ) pMesh->edge_attributes().remove( pE->handle(), "sharp" );
 		parser._toString( pE->string() );
 		
 		std::string line;
@@ -702,22 +755,9 @@ void _write_edge_sharp_trait( M * pMesh )
 template<typename M>
 void _read_face_mu( M * pMesh )
 {
-	for(typename M::MeshFaceIterator fiter( pMesh ); !fiter.end(); fiter ++ )
-	{
-		typename M::CFace * pF = *fiter;
-		CParser parser( pF->string() );
-		
-		for( std::list<CToken*>::iterator iter = parser.tokens().begin() ; iter != parser.tokens().end(); ++ iter )
-		{
-		  CToken * token = *iter;
-		  if( token->m_key == "mu" )
-		  {
-			  CPoint2 uv;
-			  token->m_value >> uv;
-			  pF->mu() = std::complex<double>( uv[0], uv[1] );
-		  }
-		}
-	}
+	CTraitDecoder<typename M::CFace> decoder;
+	decoder.add( "mu", _decode_face_mu<typename M::CFace> );
+	_decode_faces<M>( pMesh, decoder );
 };
 
 template<typename M>
@@ -5,12 +5,20 @@
 #include <vector>
 #include <map>
 #include <tuple>
+#include <algorithm>
+#include <unordered_map>
 #include <fstream>
 #include <iostream>
 
 #include "../Geometry/Point2.h"
 #include "../Geometry/Point.h"
 #include "../Parser/strutil.h"
+#include "../Parser/scanner.h"
+#include "../Parser/parser.h"
+#include "../Parser/binary.h"
+#include "../Parser/writer.h"
+#include "../Parser/ply.h"
+#include "../Parser/codec.h"
 
 #define MAX_LINE 1024
 
@@ -37,12 +45,36 @@ void write(M* pMesh, const std::string& output);
 template <class M>
 void write_m(M* pMesh, const std::string& output);
 
+template <class M>
+void read_mb(M* pMesh, const std::string& input);
+
+template <class M>
+void write_mb(M* pMesh, const std::string& output);
+
+template <class M>
+void read_ply(M* pMesh, const std::string& input);
+
+template <class M>
+void write_ply(M* pMesh, const std::string& output, bool binary = true);
+
+template <class M>
+void read_mc(M* pMesh, const std::string& input);
+
+template <class M>
+void write_mc(M* pMesh, const std::string& output, int bits = 16);
+
 
 template <class M>
 void read(M* pMesh, const std::string& input)
 {
     if (strutil::endsWith(input, ".m"))
         read_m<M>(pMesh, input);
+    else if (strutil::endsWith(input, ".mb"))
+        read_mb<M>(pMesh, input);
+    else if (strutil::endsWith(input, ".ply"))
+        read_ply<M>(pMesh, input);
+    else if (strutil::endsWith(input, ".mc"))
+        read_mc<M>(pMesh, input);
     else
     {
         std::cerr << "Not support to read in " << input << "\n";
@@ -62,153 +94,88 @@ void read_m(M* pMesh, const std::string& input)
     std::vector<std::tuple<int, int, std::string>>   edge_attrs; //(vid1, vid2) -> string
     std::vector<std::tuple<int, int, std::string>> corner_attrs; //(vid,   fid) -> string
 
-    std::fstream fs(input, std::fstream::in);
-    if (fs.fail())
+    CMappedFile file;
+    if (!file.open(input.c_str()))
     {
         std::cerr << "Error in opening file " << input << "\n";
         return;
     }
 
-    char buffer[MAX_LINE];
-    int vid, vidx, fid, fidx;
-
-    // 1. read data
-    while (fs.getline(buffer, MAX_LINE))
+    // 1. read data, the ids are usually increasing, so each insertion
+    //    is hinted at the end of the map
+    for (CScanner scanner(file.begin(), file.end()); !scanner.end(); scanner.next_line())
     {
-        std::string line(buffer);
-        line = strutil::trim(line);
-
-        strutil::Tokenizer stokenizer(line, " \r\n");
-
-        stokenizer.nextToken();
-        std::string token = stokenizer.getToken();
+        const char* word;
+        size_t n;
+        if (!scanner.word(word, n))
+            continue;
 
-        if (token == "Vertex")
+        if (n == 6 && memcmp(word, "Vertex", 6) == 0)
         {
-            stokenizer.nextToken();
-            token = stokenizer.getToken();
-            vid = strutil::parseString<int>(token);
+            int vid = 0;
+            scanner.parse_int(vid);
 
             CPoint p;
             for (int i = 0; i < 3; i++)
             {
-                stokenizer.nextToken();
-                token = stokenizer.getToken();
-                p[i] = strutil::parseString<float>(token);
+                float x = 0;
+                scanner.parse_float(x);
+                p[i] = x;
             }
-            vert_id_point.insert(std::make_pair(vid, p));
-
-            if (!stokenizer.nextToken("\t\r\n"))
-                continue;
-            token = stokenizer.getToken();
+            vert_id_point.insert(vert_id_point.end(), std::make_pair(vid, p));
 
-            int sp = (int) token.find("{");
-            int ep = (int) token.find("}");
-
-            if (sp >= 0 && ep >= 0)
-            {
-                std::string str = token.substr(sp + 1, ep - sp - 1);
-                vert_id_str.insert(std::make_pair(vid, str));
-            }
+            std::string str;
+            scanner.trait(str);
+            if (!str.empty())
+                vert_id_str.insert(vert_id_str.end(), std::make_pair(vid, str));
             continue;
         }
 
-        if (token == "Face")
+        if (n == 4 && memcmp(word, "Face", 4) == 0)
         {
-            stokenizer.nextToken();
-            token = stokenizer.getToken();
-            fid = strutil::parseString<int>(token);
+            int fid = 0;
+            scanner.parse_int(fid);
 
             std::vector<int> vert_ids;
-
-            while (stokenizer.nextToken())
-            {
-                token = stokenizer.getToken();
-                if (strutil::startsWith(token, "{"))
-                    break;
-                vid = strutil::parseString<int>(token);
+            int vid;
+            while (scanner.peek() != '{' && scanner.parse_int(vid))
                 vert_ids.push_back(vid);
-            }
-            face_id_vids.insert(std::make_pair(fid, vert_ids));
-            
-            if (!stokenizer.nextToken("\t\r\n"))
-                continue;
-            token = stokenizer.getToken();
-
-            token = line;
-            int sp = (int) token.find("{");
-            int ep = (int) token.find("}");
+            face_id_vids.insert(face_id_vids.end(), std::make_pair(fid, vert_ids));
 
-            if (sp >= 0 && ep >= 0)
-            {
-                std::string str = token.substr(sp + 1, ep - sp - 1);
-                face_id_str.insert(std::make_pair(fid, str));
-            }
-            /*
-            if( strutil::startsWith( token, "{" ) )
-            {
-                f->string() = strutil::trim( token, "{}" );
-            }
-            */
+            std::string str;
+            scanner.trait(str);
+            if (!str.empty())
+                face_id_str.insert(face_id_str.end(), std::make_pair(fid, str));
             continue;
         }
 
         // read in edge attributes
-        if (token == "Edge")
+        if (n == 4 && memcmp(word, "Edge", 4) == 0)
         {
-            stokenizer.nextToken();
-            token = stokenizer.getToken();
-            int id0 = strutil::parseString<int>(token);
-
-            stokenizer.nextToken();
-            token = stokenizer.getToken();
-            int id1 = strutil::parseString<int>(token);
-
-            if (!stokenizer.nextToken("\t\r\n"))
-                continue;
-            token = stokenizer.getToken();
-
-            int sp = (int) token.find("{");
-            int ep = (int) token.find("}");
+            int id0 = 0, id1 = 0;
+            scanner.parse_int(id0);
+            scanner.parse_int(id1);
 
             std::string str;
-            if (sp >= 0 && ep >= 0)
-            {
-                str = token.substr(sp + 1, ep - sp - 1);
-            }
+            scanner.trait(str);
             edge_attrs.push_back(std::make_tuple(id0, id1, str));
-
             continue;
         }
 
         // read in corner attributes
-        if (token == "Corner")
+        if (n == 6 && memcmp(word, "Corner", 6) == 0)
         {
-            stokenizer.nextToken();
-            token = stokenizer.getToken();
-            int vid = strutil::parseString<int>(token);
-
-            stokenizer.nextToken();
-            token = stokenizer.getToken();
-            int fid = strutil::parseString<int>(token);
-
-            if (!stokenizer.nextToken("\t\r\n"))
-                continue;
-            token = stokenizer.getToken();
-
-            int sp = (int) token.find("{");
-            int ep = (int) token.find("}");
+            int vid = 0, fid = 0;
+            scanner.parse_int(vid);
+            scanner.parse_int(fid);
 
             std::string str;
-            if (sp >= 0 && ep >= 0)
-            {
-                str = token.substr(sp + 1, ep - sp - 1);
-            }
+            scanner.trait(str);
             corner_attrs.push_back(std::make_tuple(vid, fid, str));
-
             continue;
         }
     }
+    file.close();
 
     // 2. build mesh
     pMesh->load(vert_id_point, face_id_vids);
@@ -222,6 +189,12 @@ void write(M* pMesh, const std::string& output)
 {
     if (strutil::endsWith(output, ".m"))
         write_m<M>(pMesh, output);
+    else if (strutil::endsWith(output, ".mb"))
+        write_mb<M>(pMesh, output);
+    else if (strutil::endsWith(output, ".ply"))
+        write_ply<M>(pMesh, output);
+    else if (strutil::endsWith(output, ".mc"))
+        write_mc<M>(pMesh, output);
     else
     {
         std::cerr << "Not support to write to " << output << "\n";
@@ -232,6 +205,10 @@ void write(M* pMesh, const std::string& output)
 template <class M>
 void write_m(M* pMesh, const std::string& output)
 {
+    // the traits of the columns go back to the strings
+    if (pMesh->typed_traits())
+        pMesh->attributes_to_strings();
+
     for (typename M::VertexIterator viter(pMesh); !viter.end(); ++viter)
     {
         typename M::CVertex* pV = *viter;
@@ -256,71 +233,575 @@ void write_m(M* pMesh, const std::string& output)
         pD->to_string();
     }
 
+    // the cells in the order of the iterators, so the rows can be formatted in parallel
+    std::vector<typename M::CVertex*> verts;
+    std::vector<typename M::CEdge*>   edges;
+    std::vector<typename M::CFace*>   faces;
+    std::vector<typename M::CDart*>   darts;
+    for (typename M::VertexIterator viter(pMesh); !viter.end(); ++viter)
+        verts.push_back(*viter);
+    for (typename M::EdgeIterator eiter(pMesh); !eiter.end(); ++eiter)
+        edges.push_back(*eiter);
+    for (typename M::FaceIterator fiter(pMesh); !fiter.end(); ++fiter)
+        faces.push_back(*fiter);
+    for (typename M::DartIterator diter(pMesh); !diter.end(); ++diter)
+        darts.push_back(*diter);
+
     // write to file
-    std::fstream fs(output, std::fstream::out);
-    if (fs.fail())
+    CTextFile fs;
+    if (!fs.open(output.c_str()))
     {
         std::cerr << "Error in opening file " << output << "\n";
         return;
     }
 
-    for (typename M::VertexIterator viter(pMesh); !viter.end(); ++viter)
-    {
-        typename M::CVertex* pV = *viter;
-        fs << "Vertex " << pV->id();
+    fs.rows(verts.size(), [&](size_t i, CTextBuffer& os) {
+        typename M::CVertex* pV = verts[i];
+        os << "Vertex " << pV->id();
 
-        for (int i = 0; i < 3; i++)
+        for (int k = 0; k < 3; k++)
         {
-            fs << " " << pV->point()[i];
+            os << " " << pV->point()[k];
         }
         if (pV->string().size() > 0)
         {
-            fs << " "
+            os << " "
                << "{" << pV->string() << "}";
         }
-        fs << std::endl;
+        os << '\n';
+    });
+
+    fs.rows(faces.size(), [&](size_t i, CTextBuffer& os) {
+        typename M::CFace* pF = faces[i];
+        os << "Face " << pF->id();
+
+        typename M::CDart* pD = pMesh->D(pF);
+        do
+        {
+            os << " " << pMesh->C0(pD)->id();
+            pD = pMesh->beta(1, pD);
+        } while (pD != pMesh->D(pF));
+
+        if (!pF->string().empty())
+        {
+            os << " {" << pF->string() << "}";
+        }
+        os << '\n';
+    });
+
+    fs.rows(edges.size(), [&](size_t i, CTextBuffer& os) {
+        typename M::CEdge* pE = edges[i];
+        if (!pE->string().empty())
+        {
+            os << "Edge " << pMesh->edge_vertex(pE, 0)->id() << " " << pMesh->edge_vertex(pE, 1)->id() << " ";
+            os << "{" << pE->string() << "}" << '\n';
+        }
+    });
+
+    fs.rows(darts.size(), [&](size_t i, CTextBuffer& os) {
+        typename M::CDart* pD = darts[i];
+        if (!pD->string().empty())
+        {
+            os << "Corner " << pMesh->C0(pD)->id() << " " << pMesh->C2(pD)->id() << " ";
+            os << "{" << pD->string() << "}" << '\n';
+        }
+    });
+
+    if (!fs.close())
+    {
+        std::cerr << "Error in writing file " << output << "\n";
+    }
+
+    // the strings go back to the columns
+    if (pMesh->typed_traits())
+        pMesh->strings_to_attributes();
+}
+template <class M>
+void read_mb(M* pMesh, const std::string& input)
+{
+    CBinaryReader reader;
+    if (!reader.open(input.c_str()))
+        return;
+
+    size_t nv = reader.rows(MB_VERTEX);
+    size_t nf = reader.rows(MB_FACE);
+    size_t nc = reader.rows(MB_FACE_VERTEX);
+
+    const int32_t* vids   = reader.int32(MB_VERTEX, "id", 1);
+    const double*  points = reader.float64(MB_VERTEX, "point", 3);
+    const int32_t* fids   = reader.int32(MB_FACE, "id", 1);
+    const int32_t* degree = reader.int32(MB_FACE, "degree", 1);
+    const int32_t* fv     = reader.int32(MB_FACE_VERTEX, "vertex", 1);
+
+    // the faces have to refer to vertices of the file
+    bool valid = vids != NULL && points != NULL && fids != NULL && fv != NULL;
+    size_t corners = 0;
+    for (size_t i = 0; valid && i < nf; i++)
+    {
+        int d = (degree != NULL) ? degree[i] : 3;
+        valid = d >= 3 && corners + d <= nc;
+        corners += d;
+    }
+    valid = valid && corners == nc;
+    for (size_t i = 0; valid && i < nc; i++)
+        valid = fv[i] >= 0 && (size_t)fv[i] < nv;
+    if (!valid)
+    {
+        std::cerr << "Error in reading file " << input << ", invalid mesh\n";
+        return;
+    }
+
+    std::map<int, CPoint>    vert_id_point; // vid -> coordinate
+    std::map<int, std::string> vert_id_str; // vid -> string
+
+    std::map<int, std::vector<int>> face_id_vids; // fid -> vert_idx
+    std::map<int, std::string>      face_id_str;  // fid -> string
+
+    std::vector<std::tuple<int, int, std::string>>   edge_attrs; //(vid1, vid2) -> string
+    std::vector<std::tuple<int, int, std::string>> corner_attrs; //(vid,   fid) -> string
+
+    // 1. read the columns, the rows are usually in increasing id order,
+    //    so each insertion is hinted at the end of the map
+    std::string str;
+    for (size_t i = 0; i < nv; i++)
+    {
+        const double* p = points + 3 * i;
+        vert_id_point.insert(vert_id_point.end(), std::make_pair(vids[i], CPoint(p[0], p[1], p[2])));
+
+        reader.trait(MB_VERTEX, i, str);
+        if (!str.empty())
+            vert_id_str.insert(vert_id_str.end(), std::make_pair(vids[i], str));
+    }
+
+    const int32_t* pv = fv;
+    for (size_t i = 0; i < nf; i++)
+    {
+        int d = (degree != NULL) ? degree[i] : 3;
+        std::vector<int> vert_ids(d);
+        for (int k = 0; k < d; k++)
+            vert_ids[k] = vids[*pv++];
+        face_id_vids.insert(face_id_vids.end(), std::make_pair(fids[i], vert_ids));
+
+        reader.trait(MB_FACE, i, str);
+        if (!str.empty())
+            face_id_str.insert(face_id_str.end(), std::make_pair(fids[i], str));
+    }
+
+    const int32_t* ev = reader.int32(MB_EDGE, "vertex", 2);
+    for (size_t i = 0; ev != NULL && i < reader.rows(MB_EDGE); i++)
+    {
+        int v0 = ev[2 * i], v1 = ev[2 * i + 1];
+        if (v0 < 0 || v1 < 0 || (size_t)v0 >= nv || (size_t)v1 >= nv)
+            continue;
+        reader.trait(MB_EDGE, i, str);
+        edge_attrs.push_back(std::make_tuple(vids[v0], vids[v1], str));
+    }
+
+    const int32_t* cv = reader.int32(MB_CORNER, "corner", 2);
+    for (size_t i = 0; cv != NULL && i < reader.rows(MB_CORNER); i++)
+    {
+        int v = cv[2 * i], f = cv[2 * i + 1];
+        if (v < 0 || f < 0 || (size_t)v >= nv || (size_t)f >= nf)
+            continue;
+        reader.trait(MB_CORNER, i, str);
+        corner_attrs.push_back(std::make_tuple(vids[v], fids[f], str));
+    }
+    reader.close();
+
+    // 2. build mesh
+    pMesh->load(vert_id_point, face_id_vids);
+
+    // 3. read traits
+    pMesh->load_attributes(vert_id_str, face_id_str, edge_attrs, corner_attrs);
+}
+
+template <class M>
+void write_mb(M* pMesh, const std::string& output)
+{
+    // the traits of the columns go back to the strings
+    if (pMesh->typed_traits())
+        pMesh->attributes_to_strings();
+
+    for (typename M::VertexIterator viter(pMesh); !viter.end(); ++viter)
+    {
+        typename M::CVertex* pV = *viter;
+        pV->to_string();
+    }
+
+    for (typename M::EdgeIterator eiter(pMesh); !eiter.end(); ++eiter)
+    {
+        typename M::CEdge* pE = *eiter;
+        pE->to_string();
     }
 
     for (typename M::FaceIterator fiter(pMesh); !fiter.end(); ++fiter)
     {
         typename M::CFace* pF = *fiter;
-        fs << "Face " << pF->id();
+        pF->to_string();
+    }
+
+    for (typename M::DartIterator diter(pMesh); !diter.end(); ++diter)
+    {
+        typename M::CDart* pD = *diter;
+        pD->to_string();
+    }
 
+    CBinaryWriter writer;
+    std::vector<int32_t> ids;
+    std::vector<const std::string*> strings;
+
+    // vertices, referred to by their rows
+    std::unordered_map<typename M::CVertex*, int> vrow;
+    std::vector<double> points;
+    for (typename M::VertexIterator viter(pMesh); !viter.end(); ++viter)
+    {
+        typename M::CVertex* pV = *viter;
+        vrow[pV] = (int)ids.size();
+        ids.push_back(pV->id());
+        for (int i = 0; i < 3; i++)
+            points.push_back(pV->point()[i]);
+        strings.push_back(&pV->string());
+    }
+    writer.rows(MB_VERTEX, ids.size());
+    writer.column(MB_VERTEX, "id", MB_INT32, 1, ids);
+    writer.column(MB_VERTEX, "point", MB_FLOAT64, 3, points);
+    writer.traits(MB_VERTEX, strings);
+
+    // faces, in the order of write_m
+    std::unordered_map<typename M::CFace*, int> frow;
+    std::vector<int32_t> degree, fv;
+    bool triangles = true;
+    ids.clear();
+    strings.clear();
+    for (typename M::FaceIterator fiter(pMesh); !fiter.end(); ++fiter)
+    {
+        typename M::CFace* pF = *fiter;
+        frow[pF] = (int)ids.size();
+        ids.push_back(pF->id());
+
+        // load() starts a face at the dart of its second vertex, so the
+        // last vertex of write_m goes first to keep the same order
+        size_t first = fv.size();
         typename M::CDart* pD = pMesh->D(pF);
         do
         {
-            fs << " " << pMesh->C0(pD)->id();
+            fv.push_back(vrow[pMesh->C0(pD)]);
             pD = pMesh->beta(1, pD);
         } while (pD != pMesh->D(pF));
+        std::rotate(fv.begin() + first, fv.end() - 1, fv.end());
+        int d = (int)(fv.size() - first);
+        degree.push_back(d);
+        if (d != 3)
+            triangles = false;
+        strings.push_back(&pF->string());
+    }
+    writer.rows(MB_FACE, ids.size());
+    writer.rows(MB_FACE_VERTEX, fv.size());
+    writer.column(MB_FACE, "id", MB_INT32, 1, ids);
+    if (!triangles)
+        writer.column(MB_FACE, "degree", MB_INT32, 1, degree);
+    writer.column(MB_FACE_VERTEX, "vertex", MB_INT32, 1, fv);
+    writer.traits(MB_FACE, strings);
+
+    // edges with traits
+    std::vector<int32_t> ev;
+    strings.clear();
+    for (typename M::EdgeIterator eiter(pMesh); !eiter.end(); ++eiter)
+    {
+        typename M::CEdge* pE = *eiter;
+        if (pE->string().empty())
+            continue;
+        ev.push_back(vrow[pMesh->edge_vertex(pE, 0)]);
+        ev.push_back(vrow[pMesh->edge_vertex(pE, 1)]);
+        strings.push_back(&pE->string());
+    }
+    writer.rows(MB_EDGE, strings.size());
+    writer.column(MB_EDGE, "vertex", MB_INT32, 2, ev);
+    writer.traits(MB_EDGE, strings);
 
-        if (!pF->string().empty())
+    // corners with traits
+    std::vector<int32_t> cv;
+    strings.clear();
+    for (typename M::DartIterator diter(pMesh); !diter.end(); ++diter)
+    {
+        typename M::CDart* pD = *diter;
+        if (pD->string().empty())
+            continue;
+        cv.push_back(vrow[pMesh->C0(pD)]);
+        cv.push_back(frow[pMesh->C2(pD)]);
+        strings.push_back(&pD->string());
+    }
+    writer.rows(MB_CORNER, strings.size());
+    writer.column(MB_CORNER, "corner", MB_INT32, 2, cv);
+    writer.traits(MB_CORNER, strings);
+
+    writer.write(output.c_str());
+
+    // the strings go back to the columns
+    if (pMesh->typed_traits())
+        pMesh->strings_to_attributes();
+}
+template <class M>
+void read_ply(M* pMesh, const std::string& input)
+{
+    CPlyMesh ply;
+    if (!CPlyReader().read(input.c_str(), ply))
+        return;
+
+    std::map<int, CPoint>    vert_id_point; // vid -> coordinate
+    std::map<int, std::string> vert_id_str; // vid -> string
+
+    std::map<int, std::vector<int>> face_id_vids; // fid -> vert_idx
+    std::map<int, std::string>      face_id_str;  // fid -> string
+
+    std::vector<std::tuple<int, int, std::string>>   edge_attrs; //(vid1, vid2) -> string
+    std::vector<std::tuple<int, int, std::string>> corner_attrs; //(vid,   fid) -> string
+
+    // 1. the vertices and faces get the ids 1 to n in the order of the file,
+    //    the vertex properties are read as traits
+    for (size_t i = 0; i < ply.vertices(); i++)
+    {
+        int id = (int) i + 1;
+        vert_id_point.insert(vert_id_point.end(), std::make_pair(id, CPoint(ply.points[3 * i], ply.points[3 * i + 1], ply.points[3 * i + 2])));
+
+        std::string str;
+        if (!ply.uvs.empty())
+            CParser::_appendToken(str, "uv", &ply.uvs[2 * i], 2);
+        if (!ply.normals.empty())
+            CParser::_appendToken(str, "normal", &ply.normals[3 * i], 3);
+        if (!ply.rgbs.empty())
+            CParser::_appendToken(str, "rgb", &ply.rgbs[3 * i], 3);
+        if (!str.empty())
+            vert_id_str.insert(vert_id_str.end(), std::make_pair(id, str));
+    }
+
+    for (size_t i = 0; i < ply.faces(); i++)
+    {
+        std::vector<int> vert_ids;
+        for (int k = ply.offsets[i]; k < ply.offsets[i + 1]; k++)
+            vert_ids.push_back(ply.indices[k] + 1);
+        face_id_vids.insert(face_id_vids.end(), std::make_pair((int) i + 1, vert_ids));
+    }
+
+    // 2. build mesh
+    pMesh->load(vert_id_point, face_id_vids);
+
+    // 3. read traits
+    pMesh->load_attributes(vert_id_str, face_id_str, edge_attrs, corner_attrs);
+}
+
+template <class M>
+void write_ply(M* pMesh, const std::string& output, bool binary)
+{
+    // the traits of the columns go back to the strings
+    if (pMesh->typed_traits())
+        pMesh->attributes_to_strings();
+
+    for (typename M::VertexIterator viter(pMesh); !viter.end(); ++viter)
+    {
+        typename M::CVertex* pV = *viter;
+        pV->to_string();
+    }
+
+    std::vector<typename M::CVertex*> verts;
+    for (typename M::VertexIterator viter(pMesh); !viter.end(); ++viter)
+        verts.push_back(*viter);
+
+    CPlyMesh ply;
+    size_t nv = verts.size();
+    std::unordered_map<typename M::CVertex*, int> index;
+    ply.points.reserve(3 * nv);
+
+    // the traits normal, uv and rgb, the array of a trait is allocated at its first vertex
+    const char* keys[3] = {"uv", "normal", "rgb"};
+    const int width[3] = {2, 3, 3};
+    std::vector<double>* arrays[3] = {&ply.uvs, &ply.normals, &ply.rgbs};
+
+    for (size_t i = 0; i < nv; i++)
+    {
+        typename M::CVertex* pV = verts[i];
+        index[pV] = (int) i;
+        for (int k = 0; k < 3; k++)
+            ply.points.push_back(pV->point()[k]);
+
+        if (pV->string().empty())
+            continue;
+        CParser parser(pV->string());
+        for (int t = 0; t < 3; t++)
         {
-            fs << " {" << pF->string() << "}";
+            const CTokenView* token = parser.find(keys[t]);
+            if (token == NULL)
+                continue;
+            if (arrays[t]->empty())
+                arrays[t]->assign(width[t] * nv, 0.0);
+            token->numbers(&(*arrays[t])[width[t] * i], width[t]);
         }
-        fs << std::endl;
+    }
+
+    // the faces in the order of write_m
+    for (typename M::FaceIterator fiter(pMesh); !fiter.end(); ++fiter)
+    {
+        typename M::CFace* pF = *fiter;
+        typename M::CDart* pD = pMesh->D(pF);
+        do
+        {
+            ply.indices.push_back(index[pMesh->C0(pD)]);
+            pD = pMesh->beta(1, pD);
+        } while (pD != pMesh->D(pF));
+        ply.offsets.push_back((int) ply.indices.size());
+    }
+
+    CPlyWriter::write(output.c_str(), ply, binary);
+
+    // the strings go back to the columns
+    if (pMesh->typed_traits())
+        pMesh->strings_to_attributes();
+}
+
+template <class M>
+void read_mc(M* pMesh, const std::string& input)
+{
+    CCodecMesh mc;
+    if (!CCodecReader().read(input.c_str(), mc))
+        return;
+
+    std::map<int, CPoint>    vert_id_point; // vid -> coordinate
+    std::map<int, std::string> vert_id_str; // vid -> string
+
+    std::map<int, std::vector<int>> face_id_vids; // fid -> vert_idx
+    std::map<int, std::string>      face_id_str;  // fid -> string
+
+    std::vector<std::tuple<int, int, std::string>>   edge_attrs; //(vid1, vid2) -> string
+    std::vector<std::tuple<int, int, std::string>> corner_attrs; //(vid,   fid) -> string
+
+    // 1. the vertices come in the order of the faces, they are inserted
+    //    in increasing id order, each insertion hinted at the end of the map
+    std::vector<int> order(mc.vertices());
+    for (size_t i = 0; i < order.size(); i++)
+        order[i] = (int) i;
+    std::sort(order.begin(), order.end(), [&](int a, int b) { return mc.vertex_ids[a] < mc.vertex_ids[b]; });
+
+    for (size_t j = 0; j < order.size(); j++)
+    {
+        int i  = order[j];
+        int id = mc.vertex_ids[i];
+        vert_id_point.insert(vert_id_point.end(), std::make_pair(id, CPoint(mc.points[3 * i], mc.points[3 * i + 1], mc.points[3 * i + 2])));
+        if (!mc.vertex_traits.empty() && !mc.vertex_traits[i].empty())
+            vert_id_str.insert(vert_id_str.end(), std::make_pair(id, mc.vertex_traits[i]));
+    }
+
+    for (size_t i = 0; i < mc.faces(); i++)
+    {
+        std::vector<int> vert_ids;
+        for (int k = mc.offsets[i]; k < mc.offsets[i + 1]; k++)
+            vert_ids.push_back(mc.vertex_ids[mc.indices[k]]);
+        face_id_vids.insert(face_id_vids.end(), std::make_pair(mc.face_ids[i], vert_ids));
+        if (!mc.face_traits.empty() && !mc.face_traits[i].empty())
+            face_id_str.insert(face_id_str.end(), std::make_pair(mc.face_ids[i], mc.face_traits[i]));
+    }
+
+    for (size_t i = 0; i < mc.edge_traits.size(); i++)
+        edge_attrs.push_back(std::make_tuple(mc.vertex_ids[mc.edges[2 * i]], mc.vertex_ids[mc.edges[2 * i + 1]], mc.edge_traits[i]));
+
+    for (size_t i = 0; i < mc.corner_traits.size(); i++)
+        corner_attrs.push_back(std::make_tuple(mc.vertex_ids[mc.corners[2 * i]], mc.face_ids[mc.corners[2 * i + 1]], mc.corner_traits[i]));
+
+    // 2. build mesh
+    pMesh->load(vert_id_point, face_id_vids);
+
+    // 3. read traits
+    pMesh->load_attributes(vert_id_str, face_id_str, edge_attrs, corner_attrs);
+}
+
+template <class M>
+void write_mc(M* pMesh, const std::string& output, int bits)
+{
+    // the traits of the columns go back to the strings
+    if (pMesh->typed_traits())
+        pMesh->attributes_to_strings();
+
+    for (typename M::VertexIterator viter(pMesh); !viter.end(); ++viter)
+    {
+        typename M::CVertex* pV = *viter;
+        pV->to_string();
     }
 
     for (typename M::EdgeIterator eiter(pMesh); !eiter.end(); ++eiter)
     {
         typename M::CEdge* pE = *eiter;
-        if (!pE->string().empty())
-        {
-            fs << "Edge " << pMesh->edge_vertex(pE, 0)->id() << " " << pMesh->edge_vertex(pE, 1)->id() << " ";
-            fs << "{" << pE->string() << "}" << std::endl;
-        }
+        pE->to_string();
+    }
+
+    for (typename M::FaceIterator fiter(pMesh); !fiter.end(); ++fiter)
+    {
+        typename M::CFace* pF = *fiter;
+        pF->to_string();
     }
 
     for (typename M::DartIterator diter(pMesh); !diter.end(); ++diter)
     {
         typename M::CDart* pD = *diter;
-        if (!pD->string().empty())
+        pD->to_string();
+    }
+
+    CCodecMesh mc;
+    std::unordered_map<typename M::CVertex*, int> index;
+    for (typename M::VertexIterator viter(pMesh); !viter.end(); ++viter)
+    {
+        typename M::CVertex* pV = *viter;
+        index[pV] = (int) mc.vertex_ids.size();
+        mc.vertex_ids.push_back(pV->id());
+        for (int k = 0; k < 3; k++)
+            mc.points.push_back(pV->point()[k]);
+        mc.vertex_traits.push_back(pV->string());
+    }
+
+    // faces, in the order of write_mb
+    std::unordered_map<typename M::CFace*, int> findex;
+    for (typename M::FaceIterator fiter(pMesh); !fiter.end(); ++fiter)
+    {
+        typename M::CFace* pF = *fiter;
+        findex[pF] = (int) mc.face_ids.size();
+        mc.face_ids.push_back(pF->id());
+
+        size_t first = mc.indices.size();
+        typename M::CDart* pD = pMesh->D(pF);
+        do
         {
-            fs << "Corner " << pMesh->C0(pD)->id() << " " << pMesh->C2(pD)->id() << " ";
-            fs << "{" << pD->string() << "}" << std::endl;
-        }
+            mc.indices.push_back(index[pMesh->C0(pD)]);
+            pD = pMesh->beta(1, pD);
+        } while (pD != pMesh->D(pF));
+        std::rotate(mc.indices.begin() + first, mc.indices.end() - 1, mc.indices.end());
+        mc.offsets.push_back((int) mc.indices.size());
+        mc.face_traits.push_back(pF->string());
     }
 
-    fs.close();
+    // edges and corners with traits
+    for (typename M::EdgeIterator eiter(pMesh); !eiter.end(); ++eiter)
+    {
+        typename M::CEdge* pE = *eiter;
+        if (pE->string().empty())
+            continue;
+        mc.edges.push_back(index[pMesh->edge_vertex(pE, 0)]);
+        mc.edges.push_back(index[pMesh->edge_vertex(pE, 1)]);
+        mc.edge_traits.push_back(pE->string());
+    }
+
+    for (typename M::DartIterator diter(pMesh); !diter.end(); ++diter)
+    {
+        typename M::CDart* pD = *diter;
+        if (pD->string().empty())
+            continue;
+        mc.corners.push_back(index[pMesh->C0(pD)]);
+        mc.corners.push_back(findex[pMesh->C2(pD)]);
+        mc.corner_traits.push_back(pD->string());
+    }
+
+    CCodecWriter().write(output.c_str(), mc, bits);
+
+    // the strings go back to the columns
+    if (pMesh->typed_traits())
+        pMesh->strings_to_attributes();
 }
 } // namespace Dim2
 
@@ -20,22 +20,43 @@
 #include <list>
 #include <vector>
 #include <map>
+#include <algorithm>
 
 #include "../Geometry/Point.h"
 #include "../Geometry/Point2.h"
 #include "../Parser/strutil.h"
+#include "../Parser/scanner.h"
+#include "../Parser/binary.h"
+#include "../Parser/writer.h"
+#include "../Parser/ply.h"
+#include "../Parser/codec.h"
+#include "../Parser/attributes.h"
+#include "ElementStorage.h"
+#include "IdMap.h"
+#include "EdgeTable.h"
+#include "Ordering.h"
 
 namespace MeshLib {
 
 /*!
 * \brief CBaseMesh, base class for all types of mesh classes
 *
-*  This is the fundamental class for meshes. It includes a list of vertices,
-*  a list of edges, a list of faces. All the geometric objects are connected by pointers,
+*  This is the fundamental class for meshes. It includes an array of vertices,
+*  an array of edges, an array of faces. All the geometric objects are connected by pointers,
 *  vertex, edge, face are connected by halfedges. The mesh class has file IO functionalities,
 *  supporting .obj, .m and .off file formats. It offers Euler operators, each geometric primative
 *  can access its neighbors freely.
 *
+*  The elements are allocated in blocks, in the order of creation, and the arrays
+*  hold their pointers contiguously, so the mesh iterators walk memory in order.
+*  Each element has a handle, its slot in the array. Deleting an element leaves a
+*  tombstone, compact() removes the tombstones and renumbers the handles.
+*
+*  The queries which do not modify the mesh, the iterators, vertexEdge, corner,
+*  idVertex, handleVertex and the like, only read it, so several threads can
+*  traverse the mesh at once while none of them creates, deletes or relinks
+*  elements. parallel_for_each_vertex, _edge and _face rely on it.
+*
 * \tparam CVertex   vertex   class, derived from MeshLib::CVertex   class
 * \tparam CEdge     edge     class, derived from MeshLib::CEdge     class
 * \tparam CFace     face     class, derived from MeshLib::CFace     class
@@ -55,7 +76,7 @@ public:
     /*!
     CBaseMesh constructor.
     */
-    CBaseMesh() {};
+    CBaseMesh() : m_use_edge_table(true), m_typed_traits(false) {};
     /*!
     CBasemesh destructor
     */
@@ -106,6 +127,42 @@ public:
     */
     void write_off(const char * output);
 
+    /*!
+    Read a .mb binary file.
+    \param input the input .mb file name
+    */
+    void read_mb(const char * input);
+    /*!
+    Write a .mb binary file.
+    \param output the output .mb file name
+    */
+    void write_mb(const char * output);
+
+    /*!
+    Read a .ply file, ascii or binary, the vertex normals, uvs and colors
+    become the traits normal, uv and rgb.
+    \param input the input .ply file name
+    */
+    void read_ply(const char * input);
+    /*!
+    Write a .ply file, the traits normal, uv and rgb of the vertices are written.
+    \param output the output .ply file name
+    \param binary binary little endian, or ascii
+    */
+    void write_ply(const char * output, bool binary = true);
+
+    /*!
+    Read a .mc compressed file.
+    \param input the input .mc file name
+    */
+    void read_mc(const char * input);
+    /*!
+    Write a .mc compressed file, the points are quantized.
+    \param output the output .mc file name
+    \param bits bits of the quantized coordinates, 1 to 30
+    */
+    void write_mc(const char * output, int bits = 16);
+
     //number of vertices, faces, edges
     /*! number of vertices */
     int  numVertices();
@@ -164,6 +221,14 @@ public:
     \return the edge connecting both v0 and v1, NULL if no such edge exists.
     */
     tEdge   vertexEdge(tVertex v0, tVertex v1);
+    /*!
+    Whether vertexEdge and createEdge find the edges in the edge table,
+    keyed on the end vertices, instead of scanning the edge list of a vertex.
+    The table is on by default, turning it on builds it from the current edges,
+    turning it off releases it.
+    \param use whether to use the edge table
+    */
+    void    useEdgeTable(bool use);
 
     //access halfedge - halfedge key, vertex
     /*!
@@ -254,7 +319,7 @@ public:
     \param v the input vertex.
     \return the reference to the edge list
     */
-    std::list<tEdge> &  vertexEdges(tVertex v);
+    std::vector<tEdge> &  vertexEdges(tVertex v);
 
     //edge->vertex
     /*!
@@ -392,36 +457,122 @@ public:
     double edgeLength(tEdge e);
 
     /*!
-    List of the edges of the mesh.
+    Array of the edges of the mesh.
+    */
+    CElementArray<tEdge>   & edges() { return m_edges; };
+    /*!
+    Array of the faces of the mesh.
+    */
+    CElementArray<tFace>   & faces() { return m_faces; };
+    /*!
+    Array of the vertices of the mesh.
     */
-    std::list<tEdge>   & edges() { return m_edges; };
+    CElementArray<tVertex> & vertices() { return m_verts; };
     /*!
-    List of the faces of the mesh.
+    Access a vertex, an edge or a face by its handle.
+    \param h the handle
+    \return the element, NULL if it has been deleted.
     */
-    std::list<tFace>   & faces() { return m_faces; };
+    tVertex handleVertex(int h) { return m_verts[h]; };
+    tEdge   handleEdge(int h)   { return m_edges[h]; };
+    tFace   handleFace(int h)   { return m_faces[h]; };
     /*!
-    List of the vertices of the mesh.
+    Remove the tombstones of the deleted elements, the handles are renumbered.
     */
-    std::list<tVertex> & vertices() { return m_verts; };
+    void compact();
+    /*!
+    Reorder the vertices and faces for cache locality, by reverse Cuthill-McKee
+    over the edges, or along the Hilbert curve of the points. The faces follow
+    their first vertex, the edges and halfedges follow the faces. The mesh is
+    built again in the new order from the points, normals, uvs and strings of
+    the elements, as a read builds it, so it is called right after a read. The
+    ids are renumbered from 1 in the new order.
+    \param ordering COrdering::RCM or COrdering::HILBERT
+    */
+    void reorder(int ordering = COrdering::RCM);
+    /*!
+    Apply a function to each vertex, edge or face in parallel. The array is cut
+    into chunks of slots, each thread takes the next chunk when it is done with
+    the previous one. The function may write the element it is given, and read
+    the whole mesh; it must not write the other elements, create or delete
+    elements, nor throw. Without OpenMP the elements are visited in order.
+    \param f function taking a vertex, edge or face pointer
+    */
+    template<typename F> void parallel_for_each_vertex(F f) { _parallel_for_each(m_verts, f); };
+    template<typename F> void parallel_for_each_edge(F f)   { _parallel_for_each(m_edges, f); };
+    template<typename F> void parallel_for_each_face(F f)   { _parallel_for_each(m_faces, f); };
+    /*!
+    Whether the traits of the vertices, edges and faces are kept in typed attribute
+    columns instead of their strings, false by default. It is set before a read:
+    the strings are parsed into the columns and dropped, and regenerated only to
+    write the mesh. The halfedges keep their strings.
+    */
+    bool & typed_traits() { return m_typed_traits; };
+    /*!
+    Typed traits of the vertices, edges and faces, the rows are the handles.
+    */
+    CAttributeTable & vertex_attributes() { return m_vertex_attributes; };
+    CAttributeTable & edge_attributes()   { return m_edge_attributes; };
+    CAttributeTable & face_attributes()   { return m_face_attributes; };
     /*
         bool with_uv() { return m_with_texture; };
         bool with_normal() { return m_with_normal; };
     */
 protected:
 
-    /*! list of edges */
-    std::list<tEdge>                          m_edges;
-    /*! list of vertices */
-    std::list<tVertex>                        m_verts;
-    /*! list of faces */
-    std::list<tFace>							m_faces;
+    /*! array of edges */
+    CElementArray<tEdge>                      m_edges;
+    /*! array of vertices */
+    CElementArray<tVertex>                    m_verts;
+    /*! array of faces */
+    CElementArray<tFace>						m_faces;
+
+    /*! blocks of the vertices, edges, faces and halfedges */
+    CElementPool<CVertex>                     m_vertex_pool;
+    CElementPool<CEdge>                       m_edge_pool;
+    CElementPool<CFace>                       m_face_pool;
+    CElementPool<CHalfEdge>                   m_halfedge_pool;
+
+    /*! the edge of each pair of end vertices */
+    CEdgeTable<tVertex, tEdge>                m_edge_table;
+    /*! whether the edge table is maintained */
+    bool                                      m_use_edge_table;
+
+    /*! whether the traits are kept in the attribute columns */
+    bool                                      m_typed_traits;
+    /*! typed traits of the vertices, edges and faces, by handle */
+    CAttributeTable                           m_vertex_attributes;
+    CAttributeTable                           m_edge_attributes;
+    CAttributeTable                           m_face_attributes;
+
+    /*! destroy all the elements, the blocks are kept */
+    void _clear();
+
+    /*! apply a function to the elements of an array, a chunk of slots per task */
+    template<typename T, typename F>
+    static void _parallel_for_each(CElementArray<T> & array, F & f)
+    {
+        const int chunk = 256;
+        int chunks = (int)((array.slots() + chunk - 1) / chunk);
+#pragma omp parallel for schedule(dynamic)
+        for (int c = 0; c < chunks; c++)
+        {
+            typename CElementArray<T>::range r = array.chunk((size_t)c * chunk, (size_t)(c + 1) * chunk);
+            for (typename CElementArray<T>::iterator it = r.begin(); it != r.end(); ++it) f(*it);
+        }
+    };
+
+    /*! insert an edge in the edge table, by the end vertices of its first halfedge */
+    void _edge_table_insert(tEdge e) { if (m_use_edge_table) m_edge_table.insert(edgeVertex1(e), edgeVertex2(e), e); };
+    /*! remove an edge from the edge table, by the end vertices of its first halfedge */
+    void _edge_table_erase(tEdge e) { if (m_use_edge_table) m_edge_table.erase(edgeVertex1(e), edgeVertex2(e)); };
 
     //maps
 
     /*! map between vetex and its id*/
-    std::map<int, tVertex>                    m_map_vert;
+    CIdMap<tVertex>                           m_map_vert;
     /*! map between face and its id*/
-    std::map<int, tFace>						m_map_face;
+    CIdMap<tFace>								m_map_face;
 
 
 public:
@@ -462,6 +613,15 @@ public:
     /*! label boundary vertices, edges, faces */
     void labelBoundary(void);
 
+    /*! read the traits of all the elements from their strings */
+    void _traits_from_string();
+    /*! write the traits of all the elements to their strings */
+    void _traits_to_string();
+    /*! move the traits of the vertex, edge and face strings to the attribute columns */
+    void _strings_to_attributes();
+    /*! write the attribute columns back to the strings */
+    void _attributes_to_strings();
+
 public:
     /*!
      *   the input traits of the mesh, there are 64 bits in total
@@ -854,19 +1014,28 @@ inline CHalfEdge * CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::faceMostClwHalfE
  */
 template<typename CVertex, typename CEdge, typename CFace, typename CHalfEdge>
 CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::~CBaseMesh()
+{
+    _clear();
+};
+
+/*!
+    Destroy all the elements, vertices, faces, halfedges and edges, and clear the maps.
+ */
+template<typename CVertex, typename CEdge, typename CFace, typename CHalfEdge>
+void CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::_clear()
 {
     //remove vertices
 
-    for (typename std::list<CVertex*>::iterator viter = m_verts.begin(); viter != m_verts.end(); viter++)
+    for (typename CElementArray<CVertex*>::iterator viter = m_verts.begin(); viter != m_verts.end(); viter++)
     {
         CVertex * pV = *viter;
-        delete pV;
+        m_vertex_pool.destroy(pV);
     }
     m_verts.clear();
 
     //remove faces
 
-    for (typename std::list<CFace*>::iterator fiter = m_faces.begin(); fiter != m_faces.end(); fiter++)
+    for (typename CElementArray<CFace*>::iterator fiter = m_faces.begin(); fiter != m_faces.end(); fiter++)
     {
         CFace * pF = *fiter;
 
@@ -881,22 +1050,23 @@ CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::~CBaseMesh()
         for (typename std::list<CHalfEdge*>::iterator hiter = hes.begin(); hiter != hes.end(); hiter++)
         {
             CHalfEdge * pH = *hiter;
-            delete pH;
+            m_halfedge_pool.destroy(pH);
         }
         hes.clear();
 
-        delete pF;
+        m_face_pool.destroy(pF);
     }
     m_faces.clear();
 
     //remove edges
-    for (typename std::list<CEdge*>::iterator eiter = m_edges.begin(); eiter != m_edges.end(); eiter++)
+    for (typename CElementArray<CEdge*>::iterator eiter = m_edges.begin(); eiter != m_edges.end(); eiter++)
     {
         CEdge * pE = *eiter;
-        delete pE;
+        m_edge_pool.destroy(pE);
     }
 
     m_edges.clear();
+    m_edge_table.clear();
 
     //clear all the maps
     m_map_vert.clear();
@@ -926,11 +1096,11 @@ double CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::edgeLength(tEdge  e)
 template<typename CVertex, typename CEdge, typename CFace, typename CHalfEdge>
 CVertex * CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::createVertex(int id)
 {
-    CVertex * v = new CVertex();
+    CVertex * v = m_vertex_pool.create();
     assert(v != NULL);
     v->id() = id;
     m_verts.push_back(v);
-    m_map_vert.insert(std::pair<int, CVertex*>(id, v));
+    m_map_vert.insert(id, v);
     return v;
 };
 
@@ -944,10 +1114,8 @@ template<typename CVertex, typename CEdge, typename CFace, typename CHalfEdge>
 void CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::read_obj(const char * filename)
 {
 
-    std::fstream f(filename, std::fstream::in);
-    if (f.fail()) return;
-
-    char cmd[1024];
+    CMappedFile file;
+    if (!file.open(filename)) return;
 
     int  vid = 1;
     int  fid = 1;
@@ -959,24 +1127,20 @@ void CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::read_obj(const char * filename
     std::vector<CPoint> normals;
 
 
-    while (f.getline(cmd, 1024))
+    for (CScanner scanner(file.begin(), file.end()); !scanner.end(); scanner.next_line())
     {
-        std::string line(cmd);
-        line = strutil::trim(line);
-
-        strutil::Tokenizer stokenizer(line, " \t\r\n");
-
-        stokenizer.nextToken();
-        std::string token = stokenizer.getToken();
+        const char * word;
+        size_t n;
+        if (!scanner.word(word, n)) continue;
 
-        if (token == "v")
+        if (n == 1 && word[0] == 'v')
         {
             CPoint p;
             for (int i = 0; i < 3; i++)
             {
-                stokenizer.nextToken();
-                token = stokenizer.getToken();
-                p[i] = strutil::parseString<float>(token);
+                float x = 0;
+                scanner.parse_float(x);
+                p[i] = x;
             }
 
             CVertex * v = createVertex(vid);
@@ -986,61 +1150,55 @@ void CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::read_obj(const char * filename
         }
 
 
-        if (token == "vt")
+        if (n == 2 && word[0] == 'v' && word[1] == 't')
         {
             with_uv = true;
             CPoint2 uv;
             for (int i = 0; i < 2; i++)
             {
-                stokenizer.nextToken();
-                token = stokenizer.getToken();
-                uv[i] = strutil::parseString<float>(token);
+                float x = 0;
+                scanner.parse_float(x);
+                uv[i] = x;
             }
             uvs.push_back(uv);
             continue;
         }
 
 
-        if (token == "vn")
+        if (n == 2 && word[0] == 'v' && word[1] == 'n')
         {
             with_normal = true;
 
-            CPoint n;
+            CPoint normal;
             for (int i = 0; i < 3; i++)
             {
-                stokenizer.nextToken();
-                token = stokenizer.getToken();
-                n[i] = strutil::parseString<float>(token);
+                float x = 0;
+                scanner.parse_float(x);
+                normal[i] = x;
             }
-            normals.push_back(n);
+            normals.push_back(normal);
             continue;
         }
 
 
 
 
-        if (token == "f")
+        if (n == 1 && word[0] == 'f')
         {
             CVertex* v[3];
             for (int i = 0; i < 3; i++)
             {
-                stokenizer.nextToken();
-                token = stokenizer.getToken();
-
-
-                strutil::Tokenizer tokenizer(token, " /\t\r\n");
-
-                int ids[3];
+                //the corner is v, v/vt, v//vn or v/vt/vn, the empty indices are skipped
+                int ids[3] = { 0, 0, 0 };
                 int k = 0;
-                while (tokenizer.nextToken())
+                if (scanner.parse_int(ids[k])) k++;
+                while (k < 3 && scanner.skip('/'))
                 {
-                    std::string token = tokenizer.getToken();
-                    ids[k] = strutil::parseString<int>(token);
-                    k++;
+                    while (scanner.skip('/'));
+                    if (scanner.parse_int(ids[k])) k++;
                 }
 
-
-                v[i] = m_map_vert[ids[0]];
+                v[i] = m_map_vert.find(ids[0]);
                 if (with_uv)
                     v[i]->uv() = uvs[ids[1] - 1];
                 if (with_normal)
@@ -1050,7 +1208,7 @@ void CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::read_obj(const char * filename
         }
     }
 
-    f.close();
+    file.close();
 
     labelBoundary();
 }
@@ -1064,18 +1222,18 @@ void CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::read_obj(const char * filename
 template<typename CVertex, typename CEdge, typename CFace, typename CHalfEdge>
 CFace * CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::createFace(tVertex  v[], int id)
 {
-    CFace * f = new CFace();
+    CFace * f = m_face_pool.create();
     assert(f != NULL);
     f->id() = id;
     m_faces.push_back(f);
-    m_map_face.insert(std::pair<int, tFace>(id, f));
+    m_map_face.insert(id, f);
 
     //create halfedges
     tHalfEdge hes[3];
 
     for (int i = 0; i < 3; i++)
     {
-        hes[i] = new CHalfEdge;
+        hes[i] = m_halfedge_pool.create();
         assert(hes[i]);
         CVertex * vert = v[i];
         hes[i]->vertex() = vert;
@@ -1125,7 +1283,7 @@ Access a vertex by its id
 template<typename CVertex, typename CEdge, typename CFace, typename CHalfEdge>
 CVertex * CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::idVertex(int id)
 {
-    return m_map_vert[id];
+    return m_map_vert.find(id);
 };
 
 //access v->id
@@ -1149,7 +1307,7 @@ inline int CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::vertexId(tVertex   v)
 template<typename CVertex, typename CEdge, typename CFace, typename CHalfEdge>
 CFace * CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::idFace(int id)
 {
-    return m_map_face[id];
+    return m_map_face.find(id);
 };
 
 //acess f->id
@@ -1174,30 +1332,38 @@ template<typename CVertex, typename CEdge, typename CFace, typename CHalfEdge>
 CEdge * CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::createEdge(tVertex  v1, tVertex  v2)
 {
     tVertex pV = (v1->id() < v2->id()) ? v1 : v2;
-    std::list<CEdge*> & ledges = (std::list<CEdge*> &) pV->edges();
+    std::vector<CEdge*> & ledges = (std::vector<CEdge*> &) pV->edges();
 
-
-    for (typename std::list<CEdge*>::iterator te = ledges.begin(); te != ledges.end(); te++)
+    if (m_use_edge_table)
     {
-        CEdge	  * pE = *te;
-        CHalfEdge * pH = (CHalfEdge*)pE->halfedge(0);
-
-        if (pH->source() == v1 && pH->target() == v2)
-        {
-            return pE;
-        }
-        if (pH->source() == v2 && pH->target() == v1)
+        CEdge * pE = m_edge_table.find(v1, v2);
+        if (pE != NULL) return pE;
+    }
+    else
+    {
+        for (typename std::vector<CEdge*>::iterator te = ledges.begin(); te != ledges.end(); te++)
         {
-            return pE;
+            CEdge	  * pE = *te;
+            CHalfEdge * pH = (CHalfEdge*)pE->halfedge(0);
+
+            if (pH->source() == v1 && pH->target() == v2)
+            {
+                return pE;
+            }
+            if (pH->source() == v2 && pH->target() == v1)
+            {
+                return pE;
+            }
         }
     }
 
     //new edge
-    CEdge * e = new CEdge;
+    CEdge * e = m_edge_pool.create();
     assert(e != NULL);
     m_edges.push_back(e);
     e->id() = (int)m_edges.size();
     ledges.push_back(e);
+    if (m_use_edge_table) m_edge_table.insert(v1, v2, e);
 
 
     return e;
@@ -1213,15 +1379,17 @@ Access an edge by its two end vertices
 \param v1 the other vertex of the edge
 \return the edge connecting both v0 and v1, NULL if no such edge exists.
 */
-//use the edge list associated with each vertex to locate the edge
+//use the edge table, or the edge list associated with each vertex to locate the edge
 
 template<typename CVertex, typename CEdge, typename CFace, typename CHalfEdge>
 inline CEdge * CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::vertexEdge(tVertex  v0, tVertex  v1)
 {
+    if (m_use_edge_table) return m_edge_table.find(v0, v1);
+
     CVertex * pV = (v0->id() < v1->id()) ? v0 : v1;
-    std::list<CEdge*> & ledges = vertexEdges(pV);
+    std::vector<CEdge*> & ledges = vertexEdges(pV);
 
-    for (typename std::list<CEdge*>::iterator eiter = ledges.begin(); eiter != ledges.end(); eiter++)
+    for (typename std::vector<CEdge*>::iterator eiter = ledges.begin(); eiter != ledges.end(); eiter++)
     {
         CEdge * pE = *eiter;
         CHalfEdge * pH = edgeHalfedge(pE, 0);
@@ -1231,6 +1399,25 @@ inline CEdge * CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::vertexEdge(tVertex
     return NULL;
 };
 
+/*!
+Use the edge table or the vertex edge lists to find the edges
+\param use whether to use the edge table
+*/
+template<typename CVertex, typename CEdge, typename CFace, typename CHalfEdge>
+void CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::useEdgeTable(bool use)
+{
+    m_edge_table.clear();
+    m_use_edge_table = use;
+    if (!use) return;
+
+    m_edge_table.reserve(m_edges.size());
+    for (typename CElementArray<CEdge*>::iterator eiter = m_edges.begin(); eiter != m_edges.end(); ++eiter)
+    {
+        CEdge * pE = *eiter;
+        if (pE->halfedge(0) != NULL) _edge_table_insert(pE);
+    }
+};
+
 /*!
 Access a halfedge by its two end vertices
 \param v0 one vertex of the halfedge
@@ -1260,9 +1447,9 @@ Access the edge list of a vertex, {e} such that e->vertex1() == v
 
 //access vertex->edges
 template<typename CVertex, typename CEdge, typename CFace, typename CHalfEdge>
-inline std::list<CEdge*> & CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::vertexEdges(tVertex  v0)
+inline std::vector<CEdge*> & CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::vertexEdges(tVertex  v0)
 {
-    return (std::list<CEdge*> &)v0->edges();
+    return (std::vector<CEdge*> &)v0->edges();
 };
 
 //access vertex->halfedge
@@ -1284,177 +1471,120 @@ inline CHalfEdge * CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::vertexHalfedge(t
 template<typename CVertex, typename CEdge, typename CFace, typename CHalfEdge>
 void CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::read_m(const char * input)
 {
-    std::fstream is(input, std::fstream::in);
+    CMappedFile file;
 
-    if (is.fail())
+    if (!file.open(input))
     {
         fprintf(stderr, "Error in opening file %s\n", input);
         return;
     }
 
-    char buffer[MAX_LINE];
-    int id;
-
-    while (is.getline(buffer, MAX_LINE))
+    //count the vertices and faces, to allocate the arrays once
+    size_t nv = 0, nf = 0;
+    for (CScanner scanner(file.begin(), file.end()); !scanner.end(); scanner.next_line())
     {
+        const char * word;
+        size_t n;
+        if (!scanner.word(word, n)) continue;
+        if (n == 6 && memcmp(word, "Vertex", 6) == 0) nv++;
+        else if (n == 4 && memcmp(word, "Face", 4) == 0) nf++;
+    }
+    m_verts.reserve(nv);
+    m_map_vert.reserve(nv);
+    m_faces.reserve(nf);
+    m_map_face.reserve(nf);
+    m_edges.reserve(nv + nf);
+    if (m_use_edge_table) m_edge_table.reserve(nv + nf);
 
-        std::string line(buffer);
-        line = strutil::trim(line);
-
-        strutil::Tokenizer stokenizer(line, " \r\n");
+    std::vector<CVertex*> fv;
 
-        stokenizer.nextToken();
-        std::string token = stokenizer.getToken();
+    for (CScanner scanner(file.begin(), file.end()); !scanner.end(); scanner.next_line())
+    {
+        const char * word;
+        size_t n;
+        if (!scanner.word(word, n)) continue;
 
-        if (token == "Vertex")
+        if (n == 6 && memcmp(word, "Vertex", 6) == 0)
         {
-            stokenizer.nextToken();
-            token = stokenizer.getToken();
-            id = strutil::parseString<int>(token);
+            int id = 0;
+            scanner.parse_int(id);
 
             CPoint p;
             for (int i = 0; i < 3; i++)
             {
-                stokenizer.nextToken();
-                token = stokenizer.getToken();
-                p[i] = strutil::parseString<float>(token);
+                float x = 0;
+                scanner.parse_float(x);
+                p[i] = x;
             }
 
             tVertex v = createVertex(id);
             v->point() = p;
             v->id() = id;
 
-            if (!stokenizer.nextToken("\t\r\n")) continue;
-            token = stokenizer.getToken();
-
-            int sp = (int)token.find("{");
-            int ep = (int)token.find("}");
-
-            if (sp >= 0 && ep >= 0)
-            {
-                v->string() = token.substr(sp + 1, ep - sp - 1);
-            }
+            scanner.trait(v->string());
             continue;
         }
 
-
-        if (token == "Face")
+        if (n == 4 && memcmp(word, "Face", 4) == 0)
         {
+            int id = 0;
+            scanner.parse_int(id);
 
-            stokenizer.nextToken();
-            token = stokenizer.getToken();
-            id = strutil::parseString<int>(token);
-
-            std::vector<CVertex*> v;
-
-            //assume each face is a triangle
-            /*
-            for( int i = 0;i < 3; i ++ )
+            fv.clear();
+            int vid;
+            while (scanner.peek() != '{' && scanner.parse_int(vid))
             {
-                stokenizer.nextToken();
-                token = stokenizer.getToken();
-                int vid = strutil::parseString<int>(token);
-                v.push_back( idVertex( vid ) );
+                fv.push_back(idVertex(vid));
             }
-            */
-
-            while (stokenizer.nextToken())
-            {
-                token = stokenizer.getToken();
-                if (strutil::startsWith(token, "{")) break;
-                int vid = strutil::parseString<int>(token);
-                v.push_back(idVertex(vid));
-            }
-
-            tFace f = createFace(v, id);
 
-            if (!stokenizer.nextToken("\t\r\n")) continue;
-            token = stokenizer.getToken();
+            tFace f = createFace(fv, id);
 
-            //stokenizer.reset();
-            token = line;
-            int sp = (int)token.find("{");
-            int ep = (int)token.find("}");
-
-            if (sp >= 0 && ep >= 0)
-            {
-                f->string() = token.substr(sp + 1, ep - sp - 1);
-            }
-            /*
-                        if( strutil::startsWith( token, "{" ) )
-                        {
-
-                            f->string() = strutil::trim( token, "{}" );
-                        }
-            */
+            scanner.trait(f->string());
             continue;
         }
 
         //read in edge attributes
-        if (token == "Edge")
+        if (n == 4 && memcmp(word, "Edge", 4) == 0)
         {
-            stokenizer.nextToken();
-            token = stokenizer.getToken();
-            int id0 = strutil::parseString<int>(token);
-
-            stokenizer.nextToken();
-            token = stokenizer.getToken();
-            int id1 = strutil::parseString<int>(token);
-
+            int id0 = 0, id1 = 0;
+            scanner.parse_int(id0);
+            scanner.parse_int(id1);
 
             CVertex * v0 = idVertex(id0);
             CVertex * v1 = idVertex(id1);
+            if (v0 == NULL || v1 == NULL) continue;
 
             tEdge edge = vertexEdge(v0, v1);
+            if (edge == NULL) continue;
 
-            if (!stokenizer.nextToken("\t\r\n")) continue;
-            token = stokenizer.getToken();
-
-            int sp = (int)token.find("{");
-            int ep = (int)token.find("}");
-
-            if (sp >= 0 && ep >= 0)
-            {
-                edge->string() = token.substr(sp + 1, ep - sp - 1);
-            }
+            scanner.trait(edge->string());
             continue;
         }
 
-        //read in edge attributes
-        if (token == "Corner")
+        //read in corner attributes
+        if (n == 6 && memcmp(word, "Corner", 6) == 0)
         {
-            stokenizer.nextToken();
-            token = stokenizer.getToken();
-            int vid = strutil::parseString<int>(token);
-
-            stokenizer.nextToken();
-            token = stokenizer.getToken();
-            int fid = strutil::parseString<int>(token);
-
+            int vid = 0, fid = 0;
+            scanner.parse_int(vid);
+            scanner.parse_int(fid);
 
             CVertex * v = idVertex(vid);
             CFace   * f = idFace(fid);
+            if (v == NULL || f == NULL) continue;
             tHalfEdge he = corner(v, f);
+            if (he == NULL) continue;
 
-
-            if (!stokenizer.nextToken("\t\r\n")) continue;
-            token = stokenizer.getToken();
-
-            int sp = (int)token.find("{");
-            int ep = (int)token.find("}");
-
-            if (sp >= 0 && ep >= 0)
-            {
-                he->string() = token.substr(sp + 1, ep - sp - 1);
-            }
+            scanner.trait(he->string());
             continue;
         }
     }
 
+    file.close();
+
     //labelBoundary();
 
     //Label boundary edges
-    for (typename std::list<CEdge*>::iterator eiter = m_edges.begin(); eiter != m_edges.end(); ++eiter)
+    for (typename CElementArray<CEdge*>::iterator eiter = m_edges.begin(); eiter != m_edges.end(); ++eiter)
     {
         CEdge *     edge = *eiter;
         CHalfEdge * he[2];
@@ -1487,7 +1617,7 @@ void CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::read_m(const char * input)
 
     std::list<CVertex*> dangling_verts;
     //Label boundary edges
-    for (typename std::list<CVertex*>::iterator viter = m_verts.begin(); viter != m_verts.end(); ++viter)
+    for (typename CElementArray<CVertex*>::iterator viter = m_verts.begin(); viter != m_verts.end(); ++viter)
     {
         CVertex *     v = *viter;
         if (v->halfedge() != NULL) continue;
@@ -1497,15 +1627,17 @@ void CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::read_m(const char * input)
     for (typename std::list<CVertex*>::iterator viter = dangling_verts.begin(); viter != dangling_verts.end(); ++viter)
     {
         CVertex * v = *viter;
+        if (m_map_vert.find(v->id()) == v)
+            m_map_vert.erase(v->id());
         m_verts.remove(v);
-        delete v;
+        m_vertex_pool.destroy(v);
         v = NULL;
     }
 
     //Arrange the boundary half_edge of boundary vertices, to make its halfedge
     //to be the most ccw in half_edge
 
-    for (typename std::list<CVertex*>::iterator viter = m_verts.begin(); viter != m_verts.end(); ++viter)
+    for (typename CElementArray<CVertex*>::iterator viter = m_verts.begin(); viter != m_verts.end(); ++viter)
     {
         CVertex *     v = *viter;
         if (!v->boundary()) continue;
@@ -1519,26 +1651,125 @@ void CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::read_m(const char * input)
     }
 
     //read in the traits
+    _traits_from_string();
+};
+
+/*!
+    Write an .m file.
+    \param output the output .m file name
+*/
+template<typename CVertex, typename CEdge, typename CFace, typename CHalfEdge>
+void CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::write_m(const char * output)
+{
+    //write traits to string
+    _traits_to_string();
+
+    CTextFile _os;
+    if (!_os.open(output))
+    {
+        fprintf(stderr, "Error is opening file %s\n", output);
+        return;
+    }
 
-    for (typename std::list<CVertex*>::iterator viter = m_verts.begin(); viter != m_verts.end(); ++viter)
+    // the rows are formatted in parallel, one slot of the element arrays each
+    _os.rows(m_verts.slots(), [&](size_t i, CTextBuffer & os)
+    {
+        tVertex v = m_verts[(int)i];
+        if (v == NULL) return;
+
+        os << "Vertex " << v->id();
+
+        for (int k = 0; k < 3; k++)
+        {
+            os << " " << v->point()[k];
+        }
+        if (v->string().size() > 0)
+        {
+            os << " " << "{" << v->string() << "}";
+        }
+        os << '\n';
+    });
+
+    _os.rows(m_faces.slots(), [&](size_t i, CTextBuffer & os)
+    {
+        tFace f = m_faces[(int)i];
+        if (f == NULL) return;
+
+        os << "Face " << f->id();
+        tHalfEdge he = faceHalfedge(f);
+        do {
+            os << " " << he->target()->id();
+            he = halfedgeNext(he);
+        } while (he != f->halfedge());
+
+        if (f->string().size() > 0)
+        {
+            os << " " << "{" << f->string() << "}";
+        }
+        os << '\n';
+    });
+
+    _os.rows(m_edges.slots(), [&](size_t i, CTextBuffer & os)
+    {
+        tEdge e = m_edges[(int)i];
+        if (e != NULL && e->string().size() > 0)
+        {
+            os << "Edge " << edgeVertex1(e)->id() << " " << edgeVertex2(e)->id() << " ";
+            os << "{" << e->string() << "}" << '\n';
+        }
+    });
+
+    _os.rows(m_faces.slots(), [&](size_t i, CTextBuffer & os)
+    {
+        tFace f = m_faces[(int)i];
+        if (f == NULL) return;
+
+        tHalfEdge he = faceHalfedge(f);
+
+        do {
+            if (he->string().size() > 0)
+            {
+                os << "Corner " << he->vertex()->id() << " " << f->id() << " ";
+                os << "{" << he->string() << "}" << '\n';
+            }
+            he = halfedgeNext(he);
+        } while (he != f->halfedge());
+    });
+
+    if (!_os.close())
+    {
+        fprintf(stderr, "Error in writing file %s\n", output);
+    }
+
+    //the strings go back to the columns
+    if (m_typed_traits) _strings_to_attributes();
+};
+
+/*!
+    Read the traits of all the elements from their strings.
+*/
+template<typename CVertex, typename CEdge, typename CFace, typename CHalfEdge>
+void CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::_traits_from_string()
+{
+    for (typename CElementArray<CVertex*>::iterator viter = m_verts.begin(); viter != m_verts.end(); ++viter)
     {
         CVertex *     v = *viter;
         v->_from_string();
     }
 
-    for (typename std::list<CEdge*>::iterator eiter = m_edges.begin(); eiter != m_edges.end(); ++eiter)
+    for (typename CElementArray<CEdge*>::iterator eiter = m_edges.begin(); eiter != m_edges.end(); ++eiter)
     {
         CEdge *     e = *eiter;
         e->_from_string();
     }
 
-    for (typename std::list<CFace*>::iterator fiter = m_faces.begin(); fiter != m_faces.end(); ++fiter)
+    for (typename CElementArray<CFace*>::iterator fiter = m_faces.begin(); fiter != m_faces.end(); ++fiter)
     {
         CFace *     f = *fiter;
         f->_from_string();
     }
 
-    for (typename std::list<CFace*>::iterator fiter = m_faces.begin(); fiter != m_faces.end(); fiter++)
+    for (typename CElementArray<CFace*>::iterator fiter = m_faces.begin(); fiter != m_faces.end(); fiter++)
     {
         CFace * pF = *fiter;
 
@@ -1549,35 +1780,38 @@ void CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::read_m(const char * input)
         } while (pH != faceMostCcwHalfEdge(pF));
     }
 
+    //the strings are dropped once the elements have read them
+    if (m_typed_traits) _strings_to_attributes();
 };
 
 /*!
-    Write an .m file.
-    \param output the output .m file name
+    Write the traits of all the elements to their strings.
 */
 template<typename CVertex, typename CEdge, typename CFace, typename CHalfEdge>
-void CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::write_m(const char * output)
+void CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::_traits_to_string()
 {
-    //write traits to string
-    for (typename std::list<CVertex*>::iterator viter = m_verts.begin(); viter != m_verts.end(); viter++)
+    //the elements write their traits over the ones of the columns
+    if (m_typed_traits) _attributes_to_strings();
+
+    for (typename CElementArray<CVertex*>::iterator viter = m_verts.begin(); viter != m_verts.end(); viter++)
     {
         CVertex * pV = *viter;
         pV->_to_string();
     }
 
-    for (typename std::list<CEdge*>::iterator eiter = m_edges.begin(); eiter != m_edges.end(); eiter++)
+    for (typename CElementArray<CEdge*>::iterator eiter = m_edges.begin(); eiter != m_edges.end(); eiter++)
     {
         CEdge * pE = *eiter;
         pE->_to_string();
     }
 
-    for (typename std::list<CFace*>::iterator fiter = m_faces.begin(); fiter != m_faces.end(); fiter++)
+    for (typename CElementArray<CFace*>::iterator fiter = m_faces.begin(); fiter != m_faces.end(); fiter++)
     {
         CFace * pF = *fiter;
         pF->_to_string();
     }
 
-    for (typename std::list<CFace*>::iterator fiter = m_faces.begin(); fiter != m_faces.end(); fiter++)
+    for (typename CElementArray<CFace*>::iterator fiter = m_faces.begin(); fiter != m_faces.end(); fiter++)
     {
         CFace * pF = *fiter;
         CHalfEdge * pH = faceMostCcwHalfEdge(pF);
@@ -1586,82 +1820,473 @@ void CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::write_m(const char * output)
             pH = faceNextCcwHalfEdge(pH);
         } while (pH != faceMostCcwHalfEdge(pF));
     }
+};
 
+/*!
+    Move the traits of the vertex, edge and face strings to the attribute columns,
+    the strings keep the tokens which do not fit a column.
+*/
+template<typename CVertex, typename CEdge, typename CFace, typename CHalfEdge>
+void CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::_strings_to_attributes()
+{
+    for (typename CElementArray<CVertex*>::iterator viter = m_verts.begin(); viter != m_verts.end(); ++viter)
+    {
+        CVertex * v = *viter;
+        m_vertex_attributes.parse(v->handle(), v->string());
+    }
 
-    std::fstream _os(output, std::fstream::out);
-    if (_os.fail())
+    for (typename CElementArray<CEdge*>::iterator eiter = m_edges.begin(); eiter != m_edges.end(); ++eiter)
     {
-        fprintf(stderr, "Error is opening file %s\n", output);
+        CEdge * e = *eiter;
+        m_edge_attributes.parse(e->handle(), e->string());
+    }
+
+    for (typename CElementArray<CFace*>::iterator fiter = m_faces.begin(); fiter != m_faces.end(); ++fiter)
+    {
+        CFace * f = *fiter;
+        m_face_attributes.parse(f->handle(), f->string());
+    }
+};
+
+/*!
+    Write the attribute columns back to the strings of the vertices, edges and faces.
+*/
+template<typename CVertex, typename CEdge, typename CFace, typename CHalfEdge>
+void CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::_attributes_to_strings()
+{
+    for (typename CElementArray<CVertex*>::iterator viter = m_verts.begin(); viter != m_verts.end(); ++viter)
+    {
+        CVertex * v = *viter;
+        m_vertex_attributes.format(v->handle(), v->string());
+    }
+
+    for (typename CElementArray<CEdge*>::iterator eiter = m_edges.begin(); eiter != m_edges.end(); ++eiter)
+    {
+        CEdge * e = *eiter;
+        m_edge_attributes.format(e->handle(), e->string());
+    }
+
+    for (typename CElementArray<CFace*>::iterator fiter = m_faces.begin(); fiter != m_faces.end(); ++fiter)
+    {
+        CFace * f = *fiter;
+        m_face_attributes.format(f->handle(), f->string());
+    }
+};
+
+/*!
+    Remove the tombstones of the deleted elements, the handles are renumbered,
+    and the rows of the attribute columns with them.
+*/
+template<typename CVertex, typename CEdge, typename CFace, typename CHalfEdge>
+void CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::compact()
+{
+    if (m_typed_traits)
+    {
+        std::vector<bool> live(m_verts.slots());
+        for (size_t i = 0; i < live.size(); i++) live[i] = m_verts[(int)i] != NULL;
+        m_vertex_attributes.compact(live);
+
+        live.assign(m_edges.slots(), false);
+        for (size_t i = 0; i < live.size(); i++) live[i] = m_edges[(int)i] != NULL;
+        m_edge_attributes.compact(live);
+
+        live.assign(m_faces.slots(), false);
+        for (size_t i = 0; i < live.size(); i++) live[i] = m_faces[(int)i] != NULL;
+        m_face_attributes.compact(live);
+    }
+    m_verts.compact();
+    m_edges.compact();
+    m_faces.compact();
+};
+
+/*!
+    Reorder the vertices and faces, and build the mesh again in the new order,
+    so the elements are also laid out in memory in the new order.
+    \param ordering COrdering::RCM or COrdering::HILBERT
+*/
+template<typename CVertex, typename CEdge, typename CFace, typename CHalfEdge>
+void CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::reorder(int ordering)
+{
+    //the strings carry the traits
+    if (m_typed_traits) _attributes_to_strings();
+
+    //the vertices by their index
+    std::vector<tVertex> verts;
+    std::vector<int>     vindex(m_verts.slots(), -1);
+    verts.reserve(m_verts.size());
+    for (typename CElementArray<CVertex*>::iterator viter = m_verts.begin(); viter != m_verts.end(); ++viter)
+    {
+        vindex[(*viter)->handle()] = (int)verts.size();
+        verts.push_back(*viter);
+    }
+    int nv = (int)verts.size();
+
+    //the neighbors of the vertices, by the edges
+    std::vector<int> offsets(nv + 1, 0), adjacency;
+    for (typename CElementArray<CEdge*>::iterator eiter = m_edges.begin(); eiter != m_edges.end(); ++eiter)
+    {
+        offsets[vindex[edgeVertex1(*eiter)->handle()] + 1]++;
+        offsets[vindex[edgeVertex2(*eiter)->handle()] + 1]++;
+    }
+    for (int i = 0; i < nv; i++) offsets[i + 1] += offsets[i];
+    adjacency.resize(offsets[nv]);
+    std::vector<int> fill(offsets.begin(), offsets.end() - 1);
+    for (typename CElementArray<CEdge*>::iterator eiter = m_edges.begin(); eiter != m_edges.end(); ++eiter)
+    {
+        int a = vindex[edgeVertex1(*eiter)->handle()];
+        int b = vindex[edgeVertex2(*eiter)->handle()];
+        adjacency[fill[a]++] = b;
+        adjacency[fill[b]++] = a;
+    }
+
+    std::vector<int> order;
+    if (ordering == COrdering::HILBERT)
+    {
+        std::vector<double> points(3 * nv);
+        for (int i = 0; i < nv; i++)
+            for (int k = 0; k < 3; k++) points[3 * i + k] = verts[i]->point()[k];
+        COrdering::hilbert(points, order);
+    }
+    else
+        COrdering::rcm(offsets, adjacency, order);
+
+    std::vector<int> rank(nv);
+    for (int k = 0; k < nv; k++) rank[order[k]] = k;
+
+    //the vertices of the faces, in the order createFace has been given them
+    std::vector<tFace> faces;
+    std::vector<int>   foffsets(1, 0), findices;
+    faces.reserve(m_faces.size());
+    for (typename CElementArray<CFace*>::iterator fiter = m_faces.begin(); fiter != m_faces.end(); ++fiter)
+    {
+        tFace pF = *fiter;
+        tHalfEdge pH = faceHalfedge(pF);
+        do {
+            pH = halfedgeNext(pH);
+            findices.push_back(vindex[pH->vertex()->handle()]);
+        } while (pH != faceHalfedge(pF));
+        foffsets.push_back((int)findices.size());
+        faces.push_back(pF);
+    }
+    int nf = (int)faces.size();
+
+    std::vector<int> forder;
+    COrdering::faces(foffsets, findices, rank, forder);
+    std::vector<int> frank(nf);
+    for (int k = 0; k < nf; k++) frank[forder[k]] = k;
+
+    //what a read gives the elements
+    std::vector<CPoint>      points(nv), normals(nv);
+    std::vector<CPoint2>     uvs(nv);
+    std::vector<std::string> vstrings(nv), fstrings(nf);
+    for (int i = 0; i < nv; i++)
+    {
+        tVertex v = verts[order[i]];
+        points[i]  = v->point();
+        normals[i] = v->normal();
+        uvs[i]     = v->uv();
+        vstrings[i].swap(v->string());
+    }
+    for (int i = 0; i < nf; i++) fstrings[i].swap(faces[forder[i]]->string());
+
+    //edge and corner strings, by the new indices of their vertices and faces
+    std::vector<int>         edge_keys, corner_keys;
+    std::vector<std::string> estrings, cstrings;
+    for (typename CElementArray<CEdge*>::iterator eiter = m_edges.begin(); eiter != m_edges.end(); ++eiter)
+    {
+        tEdge pE = *eiter;
+        if (pE->string().empty()) continue;
+        edge_keys.push_back(rank[vindex[edgeVertex1(pE)->handle()]]);
+        edge_keys.push_back(rank[vindex[edgeVertex2(pE)->handle()]]);
+        estrings.push_back(std::string());
+        estrings.back().swap(pE->string());
+    }
+    for (int i = 0; i < nf; i++)
+    {
+        tHalfEdge pH = faceHalfedge(faces[i]);
+        do {
+            if (!pH->string().empty())
+            {
+                corner_keys.push_back(rank[vindex[pH->vertex()->handle()]]);
+                corner_keys.push_back(frank[i]);
+                cstrings.push_back(std::string());
+                cstrings.back().swap(pH->string());
+            }
+            pH = halfedgeNext(pH);
+        } while (pH != faceHalfedge(faces[i]));
+    }
+
+    //the face vertices by the new indices
+    std::vector<int> face_offsets(1, 0), face_indices;
+    face_indices.reserve(findices.size());
+    for (int i = 0; i < nf; i++)
+    {
+        int f = forder[i];
+        for (int k = foffsets[f]; k < foffsets[f + 1]; k++) face_indices.push_back(rank[findices[k]]);
+        face_offsets.push_back((int)face_indices.size());
+    }
+
+    //build the mesh again, the blocks are laid out in the new order
+    _clear();
+    m_vertex_pool.clear();
+    m_edge_pool.clear();
+    m_face_pool.clear();
+    m_halfedge_pool.clear();
+    m_vertex_attributes.clear();
+    m_edge_attributes.clear();
+    m_face_attributes.clear();
+
+    m_verts.reserve(nv);
+    m_map_vert.reserve(nv);
+    m_faces.reserve(nf);
+    m_map_face.reserve(nf);
+    m_edges.reserve(nv + nf);
+    if (m_use_edge_table) m_edge_table.reserve(nv + nf);
+
+    verts.resize(nv);
+    for (int i = 0; i < nv; i++)
+    {
+        tVertex v = createVertex(i + 1);
+        v->point()  = points[i];
+        v->normal() = normals[i];
+        v->uv()     = uvs[i];
+        v->string().swap(vstrings[i]);
+        verts[i] = v;
+    }
+
+    faces.resize(nf);
+    std::vector<tVertex> vs;
+    for (int i = 0; i < nf; i++)
+    {
+        vs.clear();
+        for (int k = face_offsets[i]; k < face_offsets[i + 1]; k++) vs.push_back(verts[face_indices[k]]);
+        tFace f = createFace(vs, i + 1);
+        f->string().swap(fstrings[i]);
+        faces[i] = f;
+    }
+
+    for (size_t i = 0; i < estrings.size(); i++)
+    {
+        tEdge e = vertexEdge(verts[edge_keys[2 * i]], verts[edge_keys[2 * i + 1]]);
+        if (e != NULL) e->string().swap(estrings[i]);
+    }
+
+    for (size_t i = 0; i < cstrings.size(); i++)
+    {
+        tHalfEdge he = corner(verts[corner_keys[2 * i]], faces[corner_keys[2 * i + 1]]);
+        if (he != NULL) he->string().swap(cstrings[i]);
+    }
+
+    labelBoundary();
+
+    //read in the traits
+    _traits_from_string();
+};
+
+/*!
+    Read a .mb binary file, the columns are read in place from the mapped file.
+    \param input the input .mb file name
+*/
+template<typename CVertex, typename CEdge, typename CFace, typename CHalfEdge>
+void CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::read_mb(const char * input)
+{
+    CBinaryReader reader;
+    if (!reader.open(input)) return;
+
+    size_t nv = reader.rows(MB_VERTEX);
+    size_t nf = reader.rows(MB_FACE);
+    size_t nc = reader.rows(MB_FACE_VERTEX);
+
+    const int32_t * vids   = reader.int32(MB_VERTEX, "id", 1);
+    const double  * points = reader.float64(MB_VERTEX, "point", 3);
+    const int32_t * fids   = reader.int32(MB_FACE, "id", 1);
+    const int32_t * degree = reader.int32(MB_FACE, "degree", 1);
+    const int32_t * fv     = reader.int32(MB_FACE_VERTEX, "vertex", 1);
+
+    //the faces have to refer to vertices of the file
+    bool valid = vids != NULL && points != NULL && fids != NULL && fv != NULL;
+    size_t corners = 0;
+    for (size_t i = 0; valid && i < nf; i++)
+    {
+        int d = (degree != NULL) ? degree[i] : 3;
+        valid = d >= 3 && corners + d <= nc;
+        corners += d;
+    }
+    valid = valid && corners == nc;
+    for (size_t i = 0; valid && i < nc; i++)
+    {
+        valid = fv[i] >= 0 && (size_t)fv[i] < nv;
+    }
+    if (!valid)
+    {
+        fprintf(stderr, "Error in reading file %s, invalid mesh\n", input);
         return;
     }
 
+    m_verts.reserve(nv);
+    m_map_vert.reserve(nv);
+    m_faces.reserve(nf);
+    m_map_face.reserve(nf);
+    m_edges.reserve(nv + nf);
+    if (m_use_edge_table) m_edge_table.reserve(nv + nf);
 
-    //remove vertices
-    for (typename std::list<CVertex*>::iterator viter = m_verts.begin(); viter != m_verts.end(); viter++)
+    std::vector<CVertex*> verts(nv);
+    for (size_t i = 0; i < nv; i++)
     {
-        tVertex v = *viter;
+        tVertex v = createVertex(vids[i]);
+        v->point() = CPoint(points[3 * i], points[3 * i + 1], points[3 * i + 2]);
+        v->id() = vids[i];
+        reader.trait(MB_VERTEX, i, v->string());
+        verts[i] = v;
+    }
 
-        _os << "Vertex " << v->id();
+    std::vector<CFace*>   faces(nf);
+    std::vector<CVertex*> vs;
+    const int32_t * pv = fv;
+    for (size_t i = 0; i < nf; i++)
+    {
+        int d = (degree != NULL) ? degree[i] : 3;
+        vs.resize(d);
+        for (int k = 0; k < d; k++) vs[k] = verts[*pv++];
 
-        for (int i = 0; i < 3; i++)
-        {
-            _os << " " << v->point()[i];
-        }
-        if (v->string().size() > 0)
-        {
-            _os << " " << "{" << v->string() << "}";
-        }
-        _os << std::endl;
+        tFace f = createFace(vs, fids[i]);
+        reader.trait(MB_FACE, i, f->string());
+        faces[i] = f;
     }
 
-    for (typename std::list<CFace*>::iterator fiter = m_faces.begin(); fiter != m_faces.end(); fiter++)
+    //edge attributes
+    const int32_t * ev = reader.int32(MB_EDGE, "vertex", 2);
+    for (size_t i = 0; ev != NULL && i < reader.rows(MB_EDGE); i++)
+    {
+        int v0 = ev[2 * i], v1 = ev[2 * i + 1];
+        if (v0 < 0 || v1 < 0 || (size_t)v0 >= nv || (size_t)v1 >= nv) continue;
+        tEdge e = vertexEdge(verts[v0], verts[v1]);
+        if (e == NULL) continue;
+        reader.trait(MB_EDGE, i, e->string());
+    }
+
+    //corner attributes
+    const int32_t * cv = reader.int32(MB_CORNER, "corner", 2);
+    for (size_t i = 0; cv != NULL && i < reader.rows(MB_CORNER); i++)
+    {
+        int v = cv[2 * i], f = cv[2 * i + 1];
+        if (v < 0 || f < 0 || (size_t)v >= nv || (size_t)f >= nf) continue;
+        tHalfEdge he = corner(verts[v], faces[f]);
+        if (he == NULL) continue;
+        reader.trait(MB_CORNER, i, he->string());
+    }
+
+    reader.close();
+
+    labelBoundary();
+
+    //read in the traits
+    _traits_from_string();
+};
+
+/*!
+    Write a .mb binary file. Reading it back gives the same mesh as the one written,
+    the faces start at the same halfedge.
+    \param output the output .mb file name
+*/
+template<typename CVertex, typename CEdge, typename CFace, typename CHalfEdge>
+void CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::write_mb(const char * output)
+{
+    //write traits to string
+    _traits_to_string();
+
+    CBinaryWriter writer;
+    std::vector<int32_t> ids;
+    std::vector<const std::string*> strings;
+
+    //vertices, referred to by their rows
+    std::vector<int> vrow(m_verts.slots(), -1);
+    std::vector<double> points;
+    points.reserve(3 * m_verts.size());
+    for (typename CElementArray<CVertex*>::iterator viter = m_verts.begin(); viter != m_verts.end(); viter++)
+    {
+        tVertex v = *viter;
+        vrow[v->handle()] = (int)ids.size();
+        ids.push_back(v->id());
+        for (int i = 0; i < 3; i++) points.push_back(v->point()[i]);
+        strings.push_back(&v->string());
+    }
+    writer.rows(MB_VERTEX, ids.size());
+    writer.column(MB_VERTEX, "id", MB_INT32, 1, ids);
+    writer.column(MB_VERTEX, "point", MB_FLOAT64, 3, points);
+    writer.traits(MB_VERTEX, strings);
+
+    //faces, the vertices from the one after the face halfedge to the face halfedge
+    std::vector<int> frow(m_faces.slots(), -1);
+    std::vector<int32_t> degree, fv;
+    bool triangles = true;
+    ids.clear();
+    strings.clear();
+    for (typename CElementArray<CFace*>::iterator fiter = m_faces.begin(); fiter != m_faces.end(); fiter++)
     {
         tFace f = *fiter;
+        frow[f->handle()] = (int)ids.size();
+        ids.push_back(f->id());
 
-        _os << "Face " << f->id();
+        int d = 0;
         tHalfEdge he = faceHalfedge(f);
         do {
-            _os << " " << he->target()->id();
             he = halfedgeNext(he);
+            fv.push_back(vrow[he->target()->handle()]);
+            d++;
         } while (he != f->halfedge());
-
-        if (f->string().size() > 0)
-        {
-            _os << " " << "{" << f->string() << "}";
-        }
-        _os << std::endl;
+        degree.push_back(d);
+        if (d != 3) triangles = false;
+        strings.push_back(&f->string());
     }
-
-    for (typename std::list<CEdge*>::iterator eiter = m_edges.begin(); eiter != m_edges.end(); eiter++)
+    writer.rows(MB_FACE, ids.size());
+    writer.rows(MB_FACE_VERTEX, fv.size());
+    writer.column(MB_FACE, "id", MB_INT32, 1, ids);
+    if (!triangles) writer.column(MB_FACE, "degree", MB_INT32, 1, degree);
+    writer.column(MB_FACE_VERTEX, "vertex", MB_INT32, 1, fv);
+    writer.traits(MB_FACE, strings);
+
+    //edges with traits
+    std::vector<int32_t> ev;
+    strings.clear();
+    for (typename CElementArray<CEdge*>::iterator eiter = m_edges.begin(); eiter != m_edges.end(); eiter++)
     {
         tEdge e = *eiter;
-        if (e->string().size() > 0)
-        {
-            _os << "Edge " << edgeVertex1(e)->id() << " " << edgeVertex2(e)->id() << " ";
-            _os << "{" << e->string() << "}" << std::endl;
-        }
+        if (e->string().empty()) continue;
+        ev.push_back(vrow[edgeVertex1(e)->handle()]);
+        ev.push_back(vrow[edgeVertex2(e)->handle()]);
+        strings.push_back(&e->string());
     }
-
-    for (typename std::list<CFace*>::iterator fiter = m_faces.begin(); fiter != m_faces.end(); fiter++)
+    writer.rows(MB_EDGE, strings.size());
+    writer.column(MB_EDGE, "vertex", MB_INT32, 2, ev);
+    writer.traits(MB_EDGE, strings);
+
+    //corners with traits
+    std::vector<int32_t> cv;
+    strings.clear();
+    for (typename CElementArray<CFace*>::iterator fiter = m_faces.begin(); fiter != m_faces.end(); fiter++)
     {
         tFace f = *fiter;
-
         tHalfEdge he = faceHalfedge(f);
-
         do {
-            if (he->string().size() > 0)
+            if (!he->string().empty())
             {
-                _os << "Corner " << he->vertex()->id() << " " << f->id() << " ";
-                _os << "{" << he->string() << "}" << std::endl;
+                cv.push_back(vrow[he->vertex()->handle()]);
+                cv.push_back(frow[f->handle()]);
+                strings.push_back(&he->string());
             }
             he = halfedgeNext(he);
         } while (he != f->halfedge());
-
     }
+    writer.rows(MB_CORNER, strings.size());
+    writer.column(MB_CORNER, "corner", MB_INT32, 2, cv);
+    writer.traits(MB_CORNER, strings);
 
-    _os.close();
-};
+    writer.write(output);
 
+    //the strings go back to the columns
+    if (m_typed_traits) _strings_to_attributes();
+};
 
 //assume the mesh is with uv coordinates and normal vector for each vertex
 /*!
@@ -1671,77 +2296,83 @@ void CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::write_m(const char * output)
 template<typename CVertex, typename CEdge, typename CFace, typename CHalfEdge>
 void CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::write_obj(const char * output)
 {
-    std::fstream _os(output, std::fstream::out);
-    if (_os.fail())
+    CTextFile _os;
+    if (!_os.open(output))
     {
         fprintf(stderr, "Error is opening file %s\n", output);
         return;
     }
 
     int vid = 1;
-    for (typename std::list<CVertex*>::iterator viter = m_verts.begin(); viter != m_verts.end(); viter++)
+    for (typename CElementArray<CVertex*>::iterator viter = m_verts.begin(); viter != m_verts.end(); viter++)
     {
         tVertex v = *viter;
         v->id() = vid++;
     }
 
-    for (typename std::list<CVertex*>::iterator viter = m_verts.begin(); viter != m_verts.end(); viter++)
+    _os.rows(m_verts.slots(), [&](size_t i, CTextBuffer & os)
     {
-        tVertex v = *viter;
+        tVertex v = m_verts[(int)i];
+        if (v == NULL) return;
 
-        _os << "v";
+        os << "v";
 
-        for (int i = 0; i < 3; i++)
+        for (int k = 0; k < 3; k++)
         {
-            _os << " " << v->point()[i];
+            os << " " << v->point()[k];
         }
-        _os << std::endl;
-    }
+        os << '\n';
+    });
 
-    for (typename std::list<CVertex*>::iterator viter = m_verts.begin(); viter != m_verts.end(); viter++)
+    _os.rows(m_verts.slots(), [&](size_t i, CTextBuffer & os)
     {
-        tVertex v = *viter;
+        tVertex v = m_verts[(int)i];
+        if (v == NULL) return;
 
-        _os << "vt";
+        os << "vt";
 
-        for (int i = 0; i < 2; i++)
+        for (int k = 0; k < 2; k++)
         {
-            _os << " " << v->uv()[i];
+            os << " " << v->uv()[k];
         }
-        _os << std::endl;
-    }
+        os << '\n';
+    });
 
-    for (typename std::list<CVertex*>::iterator viter = m_verts.begin(); viter != m_verts.end(); viter++)
+    _os.rows(m_verts.slots(), [&](size_t i, CTextBuffer & os)
     {
-        tVertex v = *viter;
+        tVertex v = m_verts[(int)i];
+        if (v == NULL) return;
 
-        _os << "vn";
+        os << "vn";
 
-        for (int i = 0; i < 3; i++)
+        for (int k = 0; k < 3; k++)
         {
-            _os << " " << v->normal()[i];
+            os << " " << v->normal()[k];
         }
-        _os << std::endl;
-    }
+        os << '\n';
+    });
 
-
-    for (typename std::list<CFace*>::iterator fiter = m_faces.begin(); fiter != m_faces.end(); fiter++)
+    _os.rows(m_faces.slots(), [&](size_t i, CTextBuffer & os)
     {
-        tFace f = *fiter;
+        tFace f = m_faces[(int)i];
+        if (f == NULL) return;
 
-        _os << "f";
+        os << "f";
 
         tHalfEdge he = faceHalfedge(f);
 
         do {
             int vid = he->target()->id();
-            _os << " " << vid << "/" << vid << "/" << vid;
+            os << " " << vid << "/" << vid << "/" << vid;
             he = halfedgeNext(he);
         } while (he != f->halfedge());
-        _os << std::endl;
-    }
+        os << '\n';
+    });
 
-    _os.close();
+    if (!_os.close())
+    {
+        fprintf(stderr, "Error in writing file %s\n", output);
+    }
 };
 
 /*!
@@ -1751,51 +2382,298 @@ void CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::write_obj(const char * output)
 template<typename CVertex, typename CEdge, typename CFace, typename CHalfEdge>
 void CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::write_off(const char * output)
 {
-    std::fstream _os(output, std::fstream::out);
-    if (_os.fail())
+    CTextFile _os;
+    if (!_os.open(output))
     {
         fprintf(stderr, "Error is opening file %s\n", output);
         return;
     }
 
-    _os << "OFF" << std::endl;
-    _os << m_verts.size() << " " << m_faces.size() << " " << m_edges.size() << std::endl;
+    CTextBuffer header;
+    header << "OFF" << '\n';
+    header << m_verts.size() << " " << m_faces.size() << " " << m_edges.size() << '\n';
+    _os.write(header);
 
 
     int vid = 0;
-    for (typename std::list<CVertex*>::iterator viter = m_verts.begin(); viter != m_verts.end(); viter++)
+    for (typename CElementArray<CVertex*>::iterator viter = m_verts.begin(); viter != m_verts.end(); viter++)
     {
         tVertex v = *viter;
         v->id() = vid++;
     }
 
-    for (typename std::list<CVertex*>::iterator viter = m_verts.begin(); viter != m_verts.end(); viter++)
+    _os.rows(m_verts.slots(), [&](size_t i, CTextBuffer & os)
     {
-        tVertex v = *viter;
-        _os << v->point()[0] << " " << v->point()[1] << " " << v->point()[2] << std::endl;
-        //_os << v->normal()[0] << " " << v->normal()[1]<< " " << v->normal()[2]<< std::endl;
-    }
+        tVertex v = m_verts[(int)i];
+        if (v == NULL) return;
+        os << v->point()[0] << " " << v->point()[1] << " " << v->point()[2] << '\n';
+        //os << v->normal()[0] << " " << v->normal()[1]<< " " << v->normal()[2]<< '\n';
+    });
 
 
-    for (typename std::list<CFace*>::iterator fiter = m_faces.begin(); fiter != m_faces.end(); fiter++)
+    _os.rows(m_faces.slots(), [&](size_t i, CTextBuffer & os)
     {
-        tFace f = *fiter;
+        tFace f = m_faces[(int)i];
+        if (f == NULL) return;
 
-        _os << "3";
+        os << "3";
 
         tHalfEdge he = faceHalfedge(f);
 
         do {
             int vid = he->target()->id();
-            _os << " " << vid;
+            os << " " << vid;
             he = halfedgeNext(he);
         } while (he != f->halfedge());
-        _os << std::endl;
+        os << '\n';
+    });
+
+    if (!_os.close())
+    {
+        fprintf(stderr, "Error in writing file %s\n", output);
     }
+};
 
-    _os.close();
+/*!
+    Read a .ply file, the vertices and faces get the ids 1 to n in the order
+    of the file.
+    \param input the input .ply file name
+*/
+template<typename CVertex, typename CEdge, typename CFace, typename CHalfEdge>
+void CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::read_ply(const char * input)
+{
+    CPlyMesh ply;
+    if (!CPlyReader().read(input, ply)) return;
+
+    size_t nv = ply.vertices();
+    size_t nf = ply.faces();
+
+    m_verts.reserve(nv);
+    m_map_vert.reserve(nv);
+    m_faces.reserve(nf);
+    m_map_face.reserve(nf);
+    m_edges.reserve(nv + nf);
+    if (m_use_edge_table) m_edge_table.reserve(nv + nf);
+
+    std::vector<CVertex*> verts(nv);
+    for (size_t i = 0; i < nv; i++)
+    {
+        tVertex v = createVertex((int)i + 1);
+        v->point() = CPoint(ply.points[3 * i], ply.points[3 * i + 1], ply.points[3 * i + 2]);
+
+        //the properties are read as traits
+        std::string & str = v->string();
+        if (!ply.uvs.empty())     CParser::_appendToken(str, "uv", &ply.uvs[2 * i], 2);
+        if (!ply.normals.empty()) CParser::_appendToken(str, "normal", &ply.normals[3 * i], 3);
+        if (!ply.rgbs.empty())    CParser::_appendToken(str, "rgb", &ply.rgbs[3 * i], 3);
+        verts[i] = v;
+    }
+
+    std::vector<CVertex*> vs;
+    for (size_t i = 0; i < nf; i++)
+    {
+        vs.clear();
+        for (int k = ply.offsets[i]; k < ply.offsets[i + 1]; k++) vs.push_back(verts[ply.indices[k]]);
+        createFace(vs, (int)i + 1);
+    }
+
+    labelBoundary();
+
+    _traits_from_string();
+};
+
+/*!
+    Write a .ply file, the vertices are written in the order of the mesh.
+    \param output the output .ply file name
+    \param binary binary little endian, or ascii
+*/
+template<typename CVertex, typename CEdge, typename CFace, typename CHalfEdge>
+void CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::write_ply(const char * output, bool binary)
+{
+    //write traits to string
+    _traits_to_string();
+
+    CPlyMesh ply;
+    size_t nv = m_verts.size();
+    std::vector<int> index(m_verts.slots(), -1);
+    ply.points.reserve(3 * nv);
+
+    const char * keys[3] = { "uv", "normal", "rgb" };
+    const int    width[3] = { 2, 3, 3 };
+    std::vector<double> * arrays[3] = { &ply.uvs, &ply.normals, &ply.rgbs };
+
+    int i = 0;
+    for (typename CElementArray<CVertex*>::iterator viter = m_verts.begin(); viter != m_verts.end(); viter++, i++)
+    {
+        tVertex v = *viter;
+        index[v->handle()] = i;
+        for (int k = 0; k < 3; k++) ply.points.push_back(v->point()[k]);
+
+        if (v->string().empty()) continue;
+        CParser parser(v->string());
+        for (int t = 0; t < 3; t++)
+        {
+            const CTokenView * token = parser.find(keys[t]);
+            if (token == NULL) continue;
+            //the array of a trait is allocated at its first vertex
+            if (arrays[t]->empty()) arrays[t]->assign(width[t] * nv, 0.0);
+            token->numbers(&(*arrays[t])[width[t] * i], width[t]);
+        }
+    }
+
+    ply.offsets.reserve(m_faces.size() + 1);
+    ply.indices.reserve(3 * m_faces.size());
+    for (typename CElementArray<CFace*>::iterator fiter = m_faces.begin(); fiter != m_faces.end(); fiter++)
+    {
+        tFace f = *fiter;
+        tHalfEdge he = faceHalfedge(f);
+        do {
+            ply.indices.push_back(index[he->target()->handle()]);
+            he = halfedgeNext(he);
+        } while (he != f->halfedge());
+        ply.offsets.push_back((int)ply.indices.size());
+    }
+
+    CPlyWriter::write(output, ply, binary);
+
+    //the strings go back to the columns
+    if (m_typed_traits) _strings_to_attributes();
 };
 
+/*!
+    Read a .mc compressed file, the vertices come in the order of the faces.
+    \param input the input .mc file name
+*/
+template<typename CVertex, typename CEdge, typename CFace, typename CHalfEdge>
+void CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::read_mc(const char * input)
+{
+    CCodecMesh mc;
+    if (!CCodecReader().read(input, mc)) return;
+
+    size_t nv = mc.vertices();
+    size_t nf = mc.faces();
+
+    m_verts.reserve(nv);
+    m_map_vert.reserve(nv);
+    m_faces.reserve(nf);
+    m_map_face.reserve(nf);
+    m_edges.reserve(nv + nf);
+    if (m_use_edge_table) m_edge_table.reserve(nv + nf);
+
+    std::vector<CVertex*> verts(nv);
+    for (size_t i = 0; i < nv; i++)
+    {
+        tVertex v = createVertex(mc.vertex_ids[i]);
+        v->point() = CPoint(mc.points[3 * i], mc.points[3 * i + 1], mc.points[3 * i + 2]);
+        v->id() = mc.vertex_ids[i];
+        if (!mc.vertex_traits.empty()) v->string().swap(mc.vertex_traits[i]);
+        verts[i] = v;
+    }
+
+    std::vector<CFace*>   faces(nf);
+    std::vector<CVertex*> vs;
+    for (size_t i = 0; i < nf; i++)
+    {
+        vs.clear();
+        for (int k = mc.offsets[i]; k < mc.offsets[i + 1]; k++) vs.push_back(verts[mc.indices[k]]);
+        tFace f = createFace(vs, mc.face_ids[i]);
+        if (!mc.face_traits.empty()) f->string().swap(mc.face_traits[i]);
+        faces[i] = f;
+    }
+
+    //edge attributes
+    for (size_t i = 0; i < mc.edge_traits.size(); i++)
+    {
+        tEdge e = vertexEdge(verts[mc.edges[2 * i]], verts[mc.edges[2 * i + 1]]);
+        if (e != NULL) e->string().swap(mc.edge_traits[i]);
+    }
+
+    //corner attributes
+    for (size_t i = 0; i < mc.corner_traits.size(); i++)
+    {
+        tHalfEdge he = corner(verts[mc.corners[2 * i]], faces[mc.corners[2 * i + 1]]);
+        if (he != NULL) he->string().swap(mc.corner_traits[i]);
+    }
+
+    labelBoundary();
+
+    //read in the traits
+    _traits_from_string();
+};
+
+/*!
+    Write a .mc compressed file, the faces in the order of the mesh.
+    \param output the output .mc file name
+    \param bits bits of the quantized coordinates, 1 to 30
+*/
+template<typename CVertex, typename CEdge, typename CFace, typename CHalfEdge>
+void CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::write_mc(const char * output, int bits)
+{
+    //write traits to string
+    _traits_to_string();
+
+    CCodecMesh mc;
+    std::vector<int> index(m_verts.slots(), -1);
+    mc.vertex_ids.reserve(m_verts.size());
+    mc.points.reserve(3 * m_verts.size());
+    mc.vertex_traits.reserve(m_verts.size());
+    for (typename CElementArray<CVertex*>::iterator viter = m_verts.begin(); viter != m_verts.end(); viter++)
+    {
+        tVertex v = *viter;
+        index[v->handle()] = (int)mc.vertex_ids.size();
+        mc.vertex_ids.push_back(v->id());
+        for (int k = 0; k < 3; k++) mc.points.push_back(v->point()[k]);
+        mc.vertex_traits.push_back(v->string());
+    }
+
+    //the vertices from the one after the face halfedge, as in write_mb
+    std::vector<int> findex(m_faces.slots(), -1);
+    mc.face_ids.reserve(m_faces.size());
+    mc.offsets.reserve(m_faces.size() + 1);
+    mc.indices.reserve(3 * m_faces.size());
+    for (typename CElementArray<CFace*>::iterator fiter = m_faces.begin(); fiter != m_faces.end(); fiter++)
+    {
+        tFace f = *fiter;
+        findex[f->handle()] = (int)mc.face_ids.size();
+        mc.face_ids.push_back(f->id());
+        tHalfEdge he = faceHalfedge(f);
+        do {
+            he = halfedgeNext(he);
+            mc.indices.push_back(index[he->target()->handle()]);
+        } while (he != f->halfedge());
+        mc.offsets.push_back((int)mc.indices.size());
+        mc.face_traits.push_back(f->string());
+    }
+
+    //edges and corners with traits
+    for (typename CElementArray<CEdge*>::iterator eiter = m_edges.begin(); eiter != m_edges.end(); eiter++)
+    {
+        tEdge e = *eiter;
+        if (e->string().empty()) continue;
+        mc.edges.push_back(index[edgeVertex1(e)->handle()]);
+        mc.edges.push_back(index[edgeVertex2(e)->handle()]);
+        mc.edge_traits.push_back(e->string());
+    }
+    for (typename CElementArray<CFace*>::iterator fiter = m_faces.begin(); fiter != m_faces.end(); fiter++)
+    {
+        tFace f = *fiter;
+        tHalfEdge he = faceHalfedge(f);
+        do {
+            if (!he->string().empty())
+            {
+                mc.corners.push_back(index[he->vertex()->handle()]);
+                mc.corners.push_back(findex[f->handle()]);
+                mc.corner_traits.push_back(he->string());
+            }
+            he = halfedgeNext(he);
+        } while (he != f->halfedge());
+    }
+
+    CCodecWriter().write(output, mc, bits);
+
+    //the strings go back to the columns
+    if (m_typed_traits) _strings_to_attributes();
+};
 
 //template pointer converting to base class pointer is OK (BasePointer) = (TemplatePointer)
 //(TemplatePointer)=(BasePointer) is incorrect
@@ -1808,10 +2686,9 @@ void CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::deleteFace(tFace  pFace)
 {
     std::vector<CVertex *> isolated_verts;
 
-    typename std::map<int, tFace>::iterator fiter = m_map_face.find(pFace->id());
-    if (fiter != m_map_face.end())
+    if (m_map_face.find(pFace->id()) == pFace)
     {
-        m_map_face.erase(fiter);
+        m_map_face.erase(pFace->id());
     }
     m_faces.remove(pFace);
 
@@ -1867,21 +2744,24 @@ void CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::deleteFace(tFace  pFace)
             m_edges.remove(pE);
             CVertex * v0 = halfedgeSource(pH);
             CVertex * v1 = halfedgeTarget(pH);
+            if (m_use_edge_table) m_edge_table.erase(v0, v1);
 
             // modified by Jerome
-            std::list<CEdge*> & ledges0 = (std::list<CEdge*> &) v0->edges();
-            if (std::find(ledges0.begin(), ledges0.end(), pE) != ledges0.end())
+            std::vector<CEdge*> & ledges0 = (std::vector<CEdge*> &) v0->edges();
+            typename std::vector<CEdge*>::iterator pos0 = std::find(ledges0.begin(), ledges0.end(), pE);
+            if (pos0 != ledges0.end())
             {
-                ledges0.remove(pE);
+                ledges0.erase(pos0);
             }
 
-            std::list<CEdge*> & ledges1 = (std::list<CEdge*> &) v1->edges();
-            if (std::find(ledges1.begin(), ledges1.end(), pE) != ledges1.end())
+            std::vector<CEdge*> & ledges1 = (std::vector<CEdge*> &) v1->edges();
+            typename std::vector<CEdge*>::iterator pos1 = std::find(ledges1.begin(), ledges1.end(), pE);
+            if (pos1 != ledges1.end())
             {
-                ledges1.remove(pE);
+                ledges1.erase(pos1);
             }
 
-            delete pE;
+            m_edge_pool.destroy(pE);
         }
 
 
@@ -1890,20 +2770,20 @@ void CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::deleteFace(tFace  pFace)
     //remove half edges
     for (int i = 0; i < 3; i++)
     {
-        delete hes[i];
+        m_halfedge_pool.destroy(hes[i]);
     }
 
-    delete pFace;
+    m_face_pool.destroy(pFace);
 
     //modified by Wei CHEN, 2018-2-13
     for (typename std::vector<CVertex*>::iterator vit = isolated_verts.begin(); vit != isolated_verts.end(); ++vit)
     {
         CVertex* pV = *vit;
-        typename std::map<int, CVertex*>::iterator viter = m_map_vert.find(pV->id());
-        if (viter != m_map_vert.end())
-            m_map_vert.erase(viter);
+        if (m_map_vert.find(pV->id()) == pV)
+            m_map_vert.erase(pV->id());
 
         m_verts.remove(pV);
+        m_vertex_pool.destroy(pV);
     }
 };
 
@@ -2020,7 +2900,7 @@ void CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::labelBoundary(void)
 {
 
     //Label boundary edges
-    for (typename std::list<CEdge*>::iterator eiter = m_edges.begin(); eiter != m_edges.end(); ++eiter)
+    for (typename CElementArray<CEdge*>::iterator eiter = m_edges.begin(); eiter != m_edges.end(); ++eiter)
     {
         CEdge *     edge = *eiter;
         CHalfEdge * he[2];
@@ -2053,7 +2933,7 @@ void CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::labelBoundary(void)
 
     std::list<CVertex*> dangling_verts;
     //Label boundary edges
-    for (typename std::list<CVertex*>::iterator viter = m_verts.begin(); viter != m_verts.end(); ++viter)
+    for (typename CElementArray<CVertex*>::iterator viter = m_verts.begin(); viter != m_verts.end(); ++viter)
     {
         tVertex     v = *viter;
         if (v->halfedge() != NULL) continue;
@@ -2063,15 +2943,17 @@ void CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::labelBoundary(void)
     for (typename std::list<CVertex*>::iterator viter = dangling_verts.begin(); viter != dangling_verts.end(); ++viter)
     {
         tVertex v = *viter;
+        if (m_map_vert.find(v->id()) == v)
+            m_map_vert.erase(v->id());
         m_verts.remove(v);
-        delete v;
+        m_vertex_pool.destroy(v);
         v = NULL;
     }
 
     //Arrange the boundary half_edge of boundary vertices, to make its halfedge
     //to be the most ccw in half_edge
 
-    for (typename std::list<CVertex*>::iterator viter = m_verts.begin(); viter != m_verts.end(); ++viter)
+    for (typename CElementArray<CVertex*>::iterator viter = m_verts.begin(); viter != m_verts.end(); ++viter)
     {
         tVertex     v = *viter;
         if (!v->boundary()) continue;
@@ -2096,18 +2978,18 @@ void CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::labelBoundary(void)
 template<typename CVertex, typename CEdge, typename CFace, typename CHalfEdge>
 CFace * CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::createFace(std::vector<tVertex> &  v, int id)
 {
-    CFace * f = new CFace();
+    CFace * f = m_face_pool.create();
     assert(f != NULL);
     f->id() = id;
     m_faces.push_back(f);
-    m_map_face.insert(std::pair<int, tFace>(id, f));
+    m_map_face.insert(id, f);
 
     //create halfedges
     std::vector<tHalfEdge> hes;
 
     for (size_t i = 0; i < v.size(); i++)
     {
-        tHalfEdge pH = new CHalfEdge;
+        tHalfEdge pH = m_halfedge_pool.create();
         assert(pH);
         CVertex * vert = v[i];
         pH->vertex() = vert;
@@ -2168,7 +3050,7 @@ void CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::write_g(const char * output)
 
 
     //remove vertices
-    for (typename std::list<CVertex*>::iterator viter = m_verts.begin(); viter != m_verts.end(); viter++)
+    for (typename CElementArray<CVertex*>::iterator viter = m_verts.begin(); viter != m_verts.end(); viter++)
     {
         tVertex v = *viter;
 
@@ -2185,7 +3067,7 @@ void CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::write_g(const char * output)
         _os << std::endl;
     }
 
-    for (typename std::list<CEdge*>::iterator eiter = m_edges.begin(); eiter != m_edges.end(); eiter++)
+    for (typename CElementArray<CEdge*>::iterator eiter = m_edges.begin(); eiter != m_edges.end(); eiter++)
     {
         tEdge e = *eiter;
 
@@ -2194,7 +3076,7 @@ void CBaseMesh<CVertex, CEdge, CFace, CHalfEdge>::write_g(const char * output)
         tVertex v2 = edgeVertex2(e);
         _os << v1->id() << " " << v2->id() << std::endl;
     }
-    for (typename std::list<CFace*>::iterator fiter = m_faces.begin(); fiter != m_faces.end(); fiter++)
+    for (typename CElementArray<CFace*>::iterator fiter = m_faces.begin(); fiter != m_faces.end(); fiter++)
     {
         tFace f = *fiter;
 
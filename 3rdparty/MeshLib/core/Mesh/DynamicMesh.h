@@ -36,8 +36,35 @@ template<typename V, typename E, typename F, typename H>
 class CDynamicMesh : public CBaseMesh<V,E,F,H>
 {
 public:
+	/*! the base mesh, whose names are dependent in the template */
+	typedef CBaseMesh<V,E,F,H> CBase;
+
+	typedef typename CBase::tVertex   tVertex;
+	typedef typename CBase::tEdge     tEdge;
+	typedef typename CBase::tFace     tFace;
+	typedef typename CBase::tHalfEdge tHalfEdge;
+
+	using CBase::createVertex;
+	using CBase::idVertex;
+	using CBase::idFace;
+	using CBase::edgeHalfedge;
+	using CBase::edgeVertex1;
+	using CBase::edgeVertex2;
+	using CBase::faceHalfedge;
+	using CBase::faceMostCcwHalfEdge;
+	using CBase::faceNextCcwHalfEdge;
+	using CBase::halfedgeEdge;
+	using CBase::halfedgeFace;
+	using CBase::halfedgeNext;
+	using CBase::halfedgeSym;
+	using CBase::halfedgeTarget;
+	using CBase::halfedgeVertex;
+	using CBase::vertexHalfedge;
+	using CBase::vertexMostCcwInHalfEdge;
+	using CBase::useEdgeTable;
+
 	/*! CDynamicMesh constructor */
-	CDynamicMesh(){ m_vertex_id = 0; m_face_id = 0; };
+	CDynamicMesh(){ m_vertex_id = 0; m_face_id = 0; m_edge_id = 0; };
 	/*! CDynamicMesh destructor */
 	~CDynamicMesh();
 
@@ -57,11 +84,26 @@ public:
 
 
 protected:
+	using CBase::m_verts;
+	using CBase::m_edges;
+	using CBase::m_faces;
+	using CBase::m_map_vert;
+	using CBase::m_map_face;
+	using CBase::m_vertex_pool;
+	using CBase::m_edge_pool;
+	using CBase::m_face_pool;
+	using CBase::m_halfedge_pool;
+	using CBase::_edge_table_insert;
+	using CBase::_edge_table_erase;
+	using CBase::m_use_edge_table;
+
 	/*! attach halfeges to an edge
 	* \param he0, he1 the halfedges
 	* \param e edge
 	*/
 	void __attach_halfedge_to_edge( H * he0, H * he1, E * e );
+	/*! find the largest ids once, before the first edit */
+	void _max_ids();
 	/*! next vertex id */
 	int  m_vertex_id;
 	/*! next face id */
@@ -93,27 +135,42 @@ CDynamicMesh<V,E,F,H>::~CDynamicMesh()
 
 /*---------------------------------------------------------------------------*/
 
-//insert a vertex in the center of a face, split the face to 3 faces
+//find the largest vertex, face and edge ids once, before the first edit,
+//the new elements are numbered after them
 
 template<typename CVertex, typename CEdge, typename CFace, typename CHalfEdge>
-CVertex * CDynamicMesh<CVertex,CEdge,CFace,CHalfEdge>::splitFace( CFace * pFace )
+void CDynamicMesh<CVertex,CEdge,CFace,CHalfEdge>::_max_ids()
 {
+	if( m_vertex_id > 0 || m_face_id > 0 ) return;
 
-	m_vertex_id = 0;
-
-	for( std::list<tVertex>::iterator viter =m_verts.begin(); viter != m_verts.end(); viter ++ )
+	for( typename CElementArray<tVertex>::iterator viter =m_verts.begin(); viter != m_verts.end(); viter ++ )
 	{
 		tVertex  pV = *viter;
 		m_vertex_id = ( m_vertex_id > pV->id() )?m_vertex_id:pV->id();
 	}
 
-	m_face_id   = 0;
-	for( std::list<tFace>::iterator fiter = m_faces.begin(); fiter != m_faces.end(); fiter ++ )
+	for( typename CElementArray<tFace>::iterator fiter = m_faces.begin(); fiter != m_faces.end(); fiter ++ )
 	{
 		tFace  pF = *fiter;
 		m_face_id = ( m_face_id > pF->id() )?m_face_id:pF->id();
 	}
 
+	for( typename CElementArray<tEdge>::iterator eiter = m_edges.begin(); eiter != m_edges.end(); eiter ++ )
+	{
+		tEdge  pE = *eiter;
+		m_edge_id = ( m_edge_id > pE->id() )?m_edge_id:pE->id();
+	}
+}
+
+/*---------------------------------------------------------------------------*/
+
+//insert a vertex in the center of a face, split the face to 3 faces
+
+template<typename CVertex, typename CEdge, typename CFace, typename CHalfEdge>
+CVertex * CDynamicMesh<CVertex,CEdge,CFace,CHalfEdge>::splitFace( CFace * pFace )
+{
+
+	_max_ids();
 
 	CVertex * pV = createVertex( ++m_vertex_id );
 	
@@ -135,7 +192,7 @@ CVertex * CDynamicMesh<CVertex,CEdge,CFace,CHalfEdge>::splitFace( CFace * pFace
 	}
 	
 
-	CFace * f = new CFace();
+	CFace * f = m_face_pool.create();
 	assert( f != NULL );
 	f->id() = ++m_face_id;
 	m_faces.push_back( f );
@@ -144,7 +201,7 @@ CVertex * CDynamicMesh<CVertex,CEdge,CFace,CHalfEdge>::splitFace( CFace * pFace
 	tHalfEdge hes[3];
 	for(int i = 0; i < 3; i ++ )
 	{
-		hes[i] = new CHalfEdge;
+		hes[i] = m_halfedge_pool.create();
 		assert( hes[i] );
 	}
 
@@ -163,7 +220,7 @@ CVertex * CDynamicMesh<CVertex,CEdge,CFace,CHalfEdge>::splitFace( CFace * pFace
 	}
 
 
-	f = new CFace();
+	f = m_face_pool.create();
 	assert( f != NULL );
 	f->id() = ++m_face_id;
 	m_faces.push_back( f );
@@ -173,7 +230,7 @@ CVertex * CDynamicMesh<CVertex,CEdge,CFace,CHalfEdge>::splitFace( CFace * pFace
 
 	for(int i = 0; i < 3; i ++ )
 	{
-		hes2[i] = new CHalfEdge;
+		hes2[i] = m_halfedge_pool.create();
 		assert( hes2[i] );
 	}
 
@@ -194,7 +251,7 @@ CVertex * CDynamicMesh<CVertex,CEdge,CFace,CHalfEdge>::splitFace( CFace * pFace
 	CEdge * e[3];
 	for( int i = 0; i < 3; i ++ )
 	{
-		e[i] = new CEdge();
+		e[i] = m_edge_pool.create();
 		assert( e[i] );
 		m_edges.push_back( e[i] );
 	}
@@ -225,6 +282,11 @@ CVertex * CDynamicMesh<CVertex,CEdge,CFace,CHalfEdge>::splitFace( CFace * pFace
 	v[0]->halfedge() = h[0];
 	v[1]->halfedge() = hes[1];
 	v[2]->halfedge() = hes2[2];
+
+	for( int i = 0; i < 3; i ++ )
+	{
+		_edge_table_insert( e[i] );
+	}
 /*
 	for( int i = 0; i < 3; i ++ )
 	{
@@ -258,6 +320,8 @@ void CDynamicMesh<CVertex,CEdge,CFace,CHalfEdge>::swapEdge( CEdge * edge )
 	  //return;
   }
 
+  _edge_table_erase( edge );
+
   CHalfEdge * ph[6];
 
   ph[0] = he_left;
@@ -305,7 +369,7 @@ void CDynamicMesh<CVertex,CEdge,CFace,CHalfEdge>::swapEdge( CEdge * edge )
   CVertex * wb = (pv[1]->id() < pv[3]->id() )?pv[1]:pv[3];
   std::list<CEdge*> & wedges = (std::list<CEdge*> &) wb->edges();
 
-  for( std::list<CEdge*>::iterator eiter = wedges.begin(); eiter != wedges.end(); eiter ++ )
+  for( typename std::list<CEdge*>::iterator eiter = wedges.begin(); eiter != wedges.end(); eiter ++ )
   {
 		CEdge * pE = *eiter;
 
@@ -351,12 +415,14 @@ void CDynamicMesh<CVertex,CEdge,CFace,CHalfEdge>::swapEdge( CEdge * edge )
 
   ph[5]->edge() = pe[1];
   pe[1]->halfedge( pi[1] ) = ph[5];
+
+  _edge_table_insert( edge );
   
 
 /*
   //remove edge from edge list of the original vertex
-  std::list<CEdge*>::iterator pos = ledges.end();
-  for( std::list<CEdge*>::iterator eiter = ledges.begin(); eiter != ledges.end(); eiter ++ )
+  typename std::list<CEdge*>::iterator pos = ledges.end();
+  for( typename std::list<CEdge*>::iterator eiter = ledges.begin(); eiter != ledges.end(); eiter ++ )
   {
 		CEdge * pE = *eiter;
 		if( pE == edge ) 
@@ -403,7 +469,7 @@ void CDynamicMesh<CVertex,CEdge,CFace,CHalfEdge>::swapEdge( CEdge * edge )
 		  }
 		  std::cout << std::endl;
 
-		  for( std::list<CEdge*>::iterator eiter = ledges.begin(); eiter != ledges.end(); eiter ++ )
+		  for( typename std::list<CEdge*>::iterator eiter = ledges.begin(); eiter != ledges.end(); eiter ++ )
 		  {
 			  CEdge * e = *eiter;
 			  CVertex * v1 = edgeVertex1( e );
@@ -413,7 +479,7 @@ void CDynamicMesh<CVertex,CEdge,CFace,CHalfEdge>::swapEdge( CEdge * edge )
 
 		  std::cout << " Edge list " << std::endl;
 
-		  for( std::list<CEdge*>::iterator eiter = wedges.begin(); eiter != wedges.end(); eiter ++ )
+		  for( typename std::list<CEdge*>::iterator eiter = wedges.begin(); eiter != wedges.end(); eiter ++ )
 		  {
 			  CEdge * e = *eiter;
 			  CVertex * v1 = edgeVertex1( e );
@@ -447,6 +513,9 @@ void CDynamicMesh<CVertex,CEdge,CFace,CHalfEdge>::swapEdge( CEdge * edge )
 template<typename CVertex, typename CEdge, typename CFace, typename CHalfEdge>
 CVertex * CDynamicMesh<CVertex,CEdge,CFace,CHalfEdge>::splitEdge( CEdge * pEdge )
 {
+	_max_ids();
+
+	_edge_table_erase( pEdge );
 
 	CVertex * pV = createVertex( ++ m_vertex_id );
 
@@ -476,7 +545,7 @@ CVertex * CDynamicMesh<CVertex,CEdge,CFace,CHalfEdge>::splitEdge( CEdge * pEdge
 		s[i] = halfedgeSym( h[i] );
 	}
 
-	f[2] = new CFace();
+	f[2] = m_face_pool.create();
 	assert( f[2] != NULL );
 	f[2]->id() = ++ m_face_id;
 	m_faces.push_back( f[2] );
@@ -484,7 +553,7 @@ CVertex * CDynamicMesh<CVertex,CEdge,CFace,CHalfEdge>::splitEdge( CEdge * pEdge
 	//create halfedges
 	for(int i = 6; i < 9; i ++ )
 	{
-		h[i] = new CHalfEdge;
+		h[i] = m_halfedge_pool.create();
 		assert( h[i] );
 	}
 
@@ -503,7 +572,7 @@ CVertex * CDynamicMesh<CVertex,CEdge,CFace,CHalfEdge>::splitEdge( CEdge * pEdge
 	}
 
 
-	f[3] = new CFace();
+	f[3] = m_face_pool.create();
 	assert( f[3] != NULL );
 	f[3]->id() = ++m_face_id;
 	m_faces.push_back( f[3] );
@@ -511,7 +580,7 @@ CVertex * CDynamicMesh<CVertex,CEdge,CFace,CHalfEdge>::splitEdge( CEdge * pEdge
 	//create halfedges
 	for(int i = 9; i < 12; i ++ )
 	{
-		h[i] = new CHalfEdge;
+		h[i] = m_halfedge_pool.create();
 		assert( h[i] );
 	}
 
@@ -533,7 +602,7 @@ CVertex * CDynamicMesh<CVertex,CEdge,CFace,CHalfEdge>::splitEdge( CEdge * pEdge
 
 	for( int i = 0; i < 3; i ++ )
 	{
-		e[i] = new CEdge();
+		e[i] = m_edge_pool.create();
 		e[i]->id() = ++ m_edge_id;
 		m_edges.push_back( e[i] );
 		assert( e[i] );
@@ -572,12 +641,18 @@ CVertex * CDynamicMesh<CVertex,CEdge,CFace,CHalfEdge>::splitEdge( CEdge * pEdge
 	v[4]->halfedge() = h[4];
 	pV->halfedge()   = h[3];
 
+	_edge_table_insert( pEdge );
+	for( int i = 0; i < 3; i ++ )
+	{
+		_edge_table_insert( e[i] );
+	}
+
 	for( int k = 0; k < 4; k ++ )
 	{
 		CHalfEdge * pH = faceHalfedge( f[k] );
 		for( int i = 0; i < 3; i ++ )
 		{
-			assert( pH->vertex() == pH->he_sym()->he_prev()->vertex() );
+			assert( pH->he_sym() == NULL || pH->vertex() == pH->he_sym()->he_prev()->vertex() );
 			pH = faceNextCcwHalfEdge( pH );
 		}
 	}
@@ -658,10 +733,10 @@ void CDynamicMesh<CVertex,CEdge,CFace,CHalfEdge>::read_vef( const char * input )
 			}
 		
 			// create vertex
-			CVertex * v = new CVertex();
+			CVertex * v = m_vertex_pool.create();
 			assert( v != NULL );
 			m_verts.push_back( v );
-			m_map_vert.insert( std::pair<int,CVertex*>(id,v));
+			m_map_vert.insert( id, v );
 			v->id() = id;
 			v->point() = p;
 			v->boundary() = false;
@@ -697,7 +772,7 @@ void CDynamicMesh<CVertex,CEdge,CFace,CHalfEdge>::read_vef( const char * input )
 			ev[1] = idVertex(vid[1]);
 
 			// create edge 
-			CEdge * e = new CEdge();	assert( e != NULL );
+			CEdge * e = m_edge_pool.create();	assert( e != NULL );
 			e->id() = id;
 			m_edges.push_back( e );
 			m_map_edge.insert( std::pair<int,CEdge*>(id,e));
@@ -706,7 +781,7 @@ void CDynamicMesh<CVertex,CEdge,CFace,CHalfEdge>::read_vef( const char * input )
 			CHalfEdge * he[2];
 			for (int k=0; k<2; k++)
 			{
-				he[k] = new CHalfEdge();	assert(he[k]);
+				he[k] = m_halfedge_pool.create();	assert(he[k]);
 				he[k]->vertex() = ev[1-k];
 				he[k]->edge() = e;
 				he[k]->face() = NULL;
@@ -746,11 +821,11 @@ void CDynamicMesh<CVertex,CEdge,CFace,CHalfEdge>::read_vef( const char * input )
 			}
 
 			// create face & link he
-			CFace * f = new CFace();
+			CFace * f = m_face_pool.create();
 			assert( f != NULL );
 			f->id() = id;
 			m_faces.push_back( f );
-			m_map_face.insert( std::pair<int,tFace>(id,f) );
+			m_map_face.insert( id, f );
 			size_t	nhe = f_he.size();
 			for ( size_t k=0; k<nhe; k++)
 			{
@@ -802,7 +877,7 @@ void CDynamicMesh<CVertex,CEdge,CFace,CHalfEdge>::read_vef( const char * input )
 
 	// check edge: remove non-matched he (i.e. bnd he's sym), remove singular e, and mark bnd v
 	std::list<tEdge> singular_edges;
-	for(std::list<tEdge>::iterator eiter= m_edges.begin() ; eiter != m_edges.end() ; ++ eiter )
+	for(typename CElementArray<tEdge>::iterator eiter= m_edges.begin() ; eiter != m_edges.end() ; ++ eiter )
 	{
 		tEdge e = *eiter;
 		assert( NULL!=e->halfedge(0) && NULL!=e->halfedge(1) );
@@ -810,7 +885,7 @@ void CDynamicMesh<CVertex,CEdge,CFace,CHalfEdge>::read_vef( const char * input )
 		{
 			if ( NULL == e->halfedge(k)->face() )
 			{
-				delete e->halfedge(k);
+				m_halfedge_pool.destroy( e->halfedge(k) );
 				e->halfedge(k) = NULL;
 			}
 		}
@@ -844,30 +919,34 @@ void CDynamicMesh<CVertex,CEdge,CFace,CHalfEdge>::read_vef( const char * input )
 			}
 		}
 	}
-	for( std::list<tEdge>::iterator  eiter = singular_edges.begin() ; eiter != singular_edges.end(); ++ eiter )
+	for( typename std::list<tEdge>::iterator  eiter = singular_edges.begin() ; eiter != singular_edges.end(); ++ eiter )
 	{
 		tEdge e = *eiter;
 		m_edges.remove( e );
-		delete e;
+		m_edge_pool.destroy( e );
 	}
 
 	// check vertex: remove singular v
 	std::list<tVertex> dangling_verts;
-	for(std::list<tVertex>::iterator viter = m_verts.begin();  viter != m_verts.end() ; ++ viter )
+	for(typename CElementArray<tVertex>::iterator viter = m_verts.begin();  viter != m_verts.end() ; ++ viter )
 	{
 		tVertex  v = *viter;
 		if( vertexHalfedge(v) != NULL ) continue;
 		dangling_verts.push_back( v );
 	}
-	for( std::list<tVertex>::iterator  viter = dangling_verts.begin() ; viter != dangling_verts.end(); ++ viter )
+	for( typename std::list<tVertex>::iterator  viter = dangling_verts.begin() ; viter != dangling_verts.end(); ++ viter )
 	{
 		tVertex v = *viter;
+		if( m_map_vert.find( v->id() ) == v ) m_map_vert.erase( v->id() );
 		m_verts.remove( v );
-		delete v;
+		m_vertex_pool.destroy( v );
 	}
 
+	//the edges are created without the edge table
+	useEdgeTable( m_use_edge_table );
+
 	//Arrange the boundary half_edge of boundary vertices, to make its halfedge to be the most ccw in half_edge
-	for(std::list<CVertex*>::iterator viter = m_verts.begin();  viter != m_verts.end() ; ++ viter )
+	for(typename CElementArray<CVertex*>::iterator viter = m_verts.begin();  viter != m_verts.end() ; ++ viter )
 	{
 		CVertex *     v = *viter;
 		if( !v->boundary() ) continue;
@@ -880,22 +959,22 @@ void CDynamicMesh<CVertex,CEdge,CFace,CHalfEdge>::read_vef( const char * input )
 	}
 
 	//read in the traits
-	for(std::list<CVertex*>::iterator viter = m_verts.begin();  viter != m_verts.end() ; ++ viter )
+	for(typename CElementArray<CVertex*>::iterator viter = m_verts.begin();  viter != m_verts.end() ; ++ viter )
 	{
 		CVertex *     v = *viter;
 		v->_from_string();
 	}
-	for(std::list<CEdge*>::iterator eiter = m_edges.begin();  eiter != m_edges.end() ; ++ eiter )
+	for(typename CElementArray<CEdge*>::iterator eiter = m_edges.begin();  eiter != m_edges.end() ; ++ eiter )
 	{
 		CEdge *     e = *eiter;
 		e->_from_string();
 	}
-	for(std::list<CFace*>::iterator fiter = m_faces.begin();  fiter != m_faces.end() ; ++ fiter )
+	for(typename CElementArray<CFace*>::iterator fiter = m_faces.begin();  fiter != m_faces.end() ; ++ fiter )
 	{
 		CFace *     f = *fiter;
 		f->_from_string();
 	}
-	for( std::list<CFace*>::iterator fiter=m_faces.begin(); fiter != m_faces.end(); fiter ++ )
+	for( typename CElementArray<CFace*>::iterator fiter=m_faces.begin(); fiter != m_faces.end(); fiter ++ )
 	{
 		CFace * pF = *fiter;
 		CHalfEdge * pH  = faceMostCcwHalfEdge( pF );
@@ -916,22 +995,22 @@ template<typename CVertex, typename CEdge, typename CFace, typename CHalfEdge>
 void CDynamicMesh<CVertex,CEdge,CFace,CHalfEdge>::write_vef( const char * output )
 {
 	//write traits to string
-	for( std::list<CVertex*>::iterator viter=m_verts.begin(); viter != m_verts.end(); viter ++ )
+	for( typename CElementArray<CVertex*>::iterator viter=m_verts.begin(); viter != m_verts.end(); viter ++ )
 	{
 		CVertex * pV = *viter;
 		pV->_to_string();
 	}
-	for( std::list<CEdge*>::iterator eiter=m_edges.begin(); eiter != m_edges.end(); eiter ++ )
+	for( typename CElementArray<CEdge*>::iterator eiter=m_edges.begin(); eiter != m_edges.end(); eiter ++ )
 	{
 		CEdge * pE = *eiter;
 		pE->_to_string();
 	}
-	for( std::list<CFace*>::iterator fiter=m_faces.begin(); fiter != m_faces.end(); fiter ++ )
+	for( typename CElementArray<CFace*>::iterator fiter=m_faces.begin(); fiter != m_faces.end(); fiter ++ )
 	{
 		CFace * pF = *fiter;
 		pF->_to_string();
 	}
-	for( std::list<CFace*>::iterator fiter=m_faces.begin(); fiter != m_faces.end(); fiter ++ )
+	for( typename CElementArray<CFace*>::iterator fiter=m_faces.begin(); fiter != m_faces.end(); fiter ++ )
 	{
 		CFace * pF = *fiter;
 		CHalfEdge * pH  = faceMostCcwHalfEdge( pF );
@@ -948,7 +1027,7 @@ void CDynamicMesh<CVertex,CEdge,CFace,CHalfEdge>::write_vef( const char * output
 		return;
 	}
 
-	for( std::list<CVertex*>::iterator viter = m_verts.begin(); viter != m_verts.end(); viter ++)
+	for( typename CElementArray<CVertex*>::iterator viter = m_verts.begin(); viter != m_verts.end(); viter ++)
 	{
 		tVertex v = *viter;
 		_os << "Vertex " << v->id();
@@ -962,7 +1041,7 @@ void CDynamicMesh<CVertex,CEdge,CFace,CHalfEdge>::write_vef( const char * output
 		}
 		_os << std::endl;
 	}
-	for( std::list<CEdge*>::iterator eiter = m_edges.begin(); eiter != m_edges.end(); eiter ++ )
+	for( typename CElementArray<CEdge*>::iterator eiter = m_edges.begin(); eiter != m_edges.end(); eiter ++ )
 	{
 		tEdge e = *eiter;
 		_os << "Edge "<<  e->id() << " " << edgeVertex1(e)->id() <<" " << edgeVertex2(e)->id() << " ";
@@ -972,7 +1051,7 @@ void CDynamicMesh<CVertex,CEdge,CFace,CHalfEdge>::write_vef( const char * output
 		}
 		_os << std::endl;
 	}
-	for( std::list<CFace*>::iterator fiter = m_faces.begin(); fiter != m_faces.end(); fiter ++ )
+	for( typename CElementArray<CFace*>::iterator fiter = m_faces.begin(); fiter != m_faces.end(); fiter ++ )
 	{
 		tFace f = *fiter;
 		_os << "Face " << f->id();
@@ -991,7 +1070,7 @@ void CDynamicMesh<CVertex,CEdge,CFace,CHalfEdge>::write_vef( const char * output
 		}
 		_os << std::endl;
 	}
-	for( std::list<CFace*>::iterator fiter = m_faces.begin(); fiter != m_faces.end(); fiter ++  )
+	for( typename CElementArray<CFace*>::iterator fiter = m_faces.begin(); fiter != m_faces.end(); fiter ++  )
 	{
 		tFace f = *fiter;
 		tHalfEdge he = faceHalfedge( f );
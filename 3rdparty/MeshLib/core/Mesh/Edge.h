@@ -29,7 +29,7 @@ public:
 	/*!
 		CEdge constructor, set both halfedge pointers to be NULL.
 	*/
-	CEdge(){ m_halfedge[0] = NULL; m_halfedge[1] = NULL; };
+	CEdge(){ m_halfedge[0] = NULL; m_halfedge[1] = NULL; m_handle = -1; };
 	/*!
 		CEdge destructor.
 	*/
@@ -38,6 +38,10 @@ public:
 		Edge ID
 	 */
 	int & id() { return m_id; };
+	/*!
+		Slot of the edge in the mesh edge array
+	 */
+	int & handle() { return m_handle; };
 
 	/*!
 		The halfedge attached to the current edge
@@ -80,6 +84,10 @@ protected:
 		Edge ID
 	 */
 	int				 m_id;
+	/*!
+		Slot in the mesh edge array
+	 */
+	int				 m_handle;
 };
 
 
@@ -0,0 +1,158 @@
+/*!
+*      \file EdgeTable.h
+*      \brief Lookup of the mesh edges by their end vertices
+*
+*/
+
+#ifndef _MESHLIB_EDGE_TABLE_H_
+#define _MESHLIB_EDGE_TABLE_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <vector>
+
+namespace MeshLib
+{
+/*!
+	\brief CEdgeTable, the edge of each pair of vertices.
+
+	An open addressing hash table with linear probing, keyed on the
+	unordered pair of end vertices, so finding an edge does not depend
+	on the valence of its vertices. Erased slots are marked deleted and
+	dropped at the next rehash.
+
+	\tparam V pointer to the vertex type
+	\tparam E pointer to the edge type
+*/
+template<typename V, typename E>
+class CEdgeTable
+{
+public:
+	CEdgeTable() : m_size( 0 ), m_used( 0 ) {};
+
+	/*! number of edges */
+	size_t size() const { return m_size; };
+
+	/*! make room for n edges */
+	void reserve( size_t n ) { if( 2 * n > m_slots.size() ) _rehash( n ); };
+
+	/*! insert the edge between v0 and v1, replacing the previous one */
+	void insert( V v0, V v1, E e )
+	{
+		_order( v0, v1 );
+		if( 2 * ( m_used + 1 ) > m_slots.size() ) _rehash( 2 * ( m_size + 1 ) );
+		size_t i = _probe( v0, v1 );
+		if( m_slots[i].state == FULL )
+		{
+			m_slots[i].e = e;
+			return;
+		}
+		i = _first_free( v0, v1 );
+		if( m_slots[i].state == EMPTY ) m_used ++;
+		m_slots[i].v0    = v0;
+		m_slots[i].v1    = v1;
+		m_slots[i].e     = e;
+		m_slots[i].state = FULL;
+		m_size ++;
+	};
+
+	/*! the edge between v0 and v1, NULL if there is none */
+	E find( V v0, V v1 ) const
+	{
+		if( m_slots.empty() ) return NULL;
+		_order( v0, v1 );
+		size_t i = _probe( v0, v1 );
+		return ( m_slots[i].state == FULL ) ? m_slots[i].e : NULL;
+	};
+
+	/*! remove the edge between v0 and v1 */
+	void erase( V v0, V v1 )
+	{
+		if( m_slots.empty() ) return;
+		_order( v0, v1 );
+		size_t i = _probe( v0, v1 );
+		if( m_slots[i].state != FULL ) return;
+		m_slots[i].state = DELETED;
+		m_size --;
+	};
+
+	/*! remove all the edges and release the table */
+	void clear()
+	{
+		std::vector<CSlot>().swap( m_slots );
+		m_size = 0;
+		m_used = 0;
+	};
+
+protected:
+	enum { EMPTY = 0, FULL = 1, DELETED = 2 };
+
+	struct CSlot
+	{
+		CSlot() : v0( NULL ), v1( NULL ), e( NULL ), state( EMPTY ) {};
+		V   v0;
+		V   v1;
+		E   e;
+		int state;
+	};
+
+	static void _order( V & v0, V & v1 ) { if( v1 < v0 ) { V v = v0; v0 = v1; v1 = v; } };
+
+	static size_t _hash( V v0, V v1 )
+	{
+		uint64_t h = (uint64_t)(uintptr_t)v0 * 0x9E3779B97F4A7C15ull;
+		h ^= (uint64_t)(uintptr_t)v1 + 0x7F4A7C159E3779B9ull + ( h << 6 ) + ( h >> 2 );
+		h ^= h >> 29;
+		return (size_t)h;
+	};
+
+	/*! slot of the pair, or the empty slot ending its probe sequence */
+	size_t _probe( V v0, V v1 ) const
+	{
+		size_t mask = m_slots.size() - 1;
+		size_t i = _hash( v0, v1 ) & mask;
+		while( m_slots[i].state != EMPTY )
+		{
+			if( m_slots[i].state == FULL && m_slots[i].v0 == v0 && m_slots[i].v1 == v1 ) break;
+			i = ( i + 1 ) & mask;
+		}
+		return i;
+	};
+
+	/*! first deleted or empty slot in the probe sequence of the pair */
+	size_t _first_free( V v0, V v1 ) const
+	{
+		size_t mask = m_slots.size() - 1;
+		size_t i = _hash( v0, v1 ) & mask;
+		while( m_slots[i].state == FULL ) i = ( i + 1 ) & mask;
+		return i;
+	};
+
+	/*! rebuild the table with room for n edges at half load */
+	void _rehash( size_t n )
+	{
+		size_t capacity = 16;
+		while( capacity < 2 * n ) capacity *= 2;
+
+		std::vector<CSlot> slots( capacity );
+		slots.swap( m_slots );
+		m_used = 0;
+		for( size_t i = 0; i < slots.size(); i ++ )
+		{
+			if( slots[i].state != FULL ) continue;
+			size_t j = _first_free( slots[i].v0, slots[i].v1 );
+			m_slots[j] = slots[i];
+			m_used ++;
+		}
+	};
+
+	/*! slots, a power of two */
+	std::vector<CSlot> m_slots;
+	/*! number of edges */
+	size_t             m_size;
+	/*! slots not empty, edges and deleted */
+	size_t             m_used;
+};
+
+}
+#endif
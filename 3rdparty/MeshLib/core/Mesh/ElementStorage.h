@@ -0,0 +1,234 @@
+/*!
+*      \file ElementStorage.h
+*      \brief Contiguous storage of the mesh elements
+*
+*/
+
+#ifndef _MESHLIB_ELEMENT_STORAGE_H_
+#define _MESHLIB_ELEMENT_STORAGE_H_
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <iterator>
+#include <new>
+#include <vector>
+
+namespace MeshLib
+{
+/*!
+	\brief CElementArray, the vertices, edges or faces of a mesh.
+
+	The element pointers are kept in one contiguous array. Each element
+	knows its slot, its handle, which stays valid until the next compaction.
+	Removing an element leaves a tombstone, an empty slot, which the
+	iterators skip, so the removal is O(1). compact() drops the tombstones
+	and renumbers the handles. The interface is the subset of std::list
+	used by the mesh classes.
+
+	\tparam T pointer to the element type, the element has handle()
+*/
+template<typename T>
+class CElementArray
+{
+public:
+	/*!
+		\brief iterator over the live elements, skips the tombstones
+	*/
+	class iterator
+	{
+	public:
+		iterator() : m_pSlots( NULL ), m_index( 0 ), m_last( (size_t) -1 ) {};
+		iterator( std::vector<T> * pSlots, size_t index, size_t last = (size_t) -1 ) : m_pSlots( pSlots ), m_index( index ), m_last( last ) { _skip_forward(); };
+
+		T & operator*() { return (*m_pSlots)[m_index]; };
+		iterator & operator++() { m_index ++; _skip_forward(); return *this; };
+		iterator   operator++(int) { iterator it = *this; ++ (*this); return it; };
+		iterator & operator--() { do { m_index --; } while( (*m_pSlots)[m_index] == NULL ); return *this; };
+		iterator   operator--(int) { iterator it = *this; -- (*this); return it; };
+		bool operator==( const iterator & it ) const { return m_index == it.m_index; };
+		bool operator!=( const iterator & it ) const { return m_index != it.m_index; };
+
+		/*! handle of the current element */
+		int handle() const { return (int)m_index; };
+
+		typedef std::bidirectional_iterator_tag iterator_category;
+		typedef T                               value_type;
+		typedef ptrdiff_t                       difference_type;
+		typedef T *                             pointer;
+		typedef T &                             reference;
+
+	protected:
+		void _skip_forward() { while( m_index < m_last && m_index < m_pSlots->size() && (*m_pSlots)[m_index] == NULL ) m_index ++; };
+
+		std::vector<T> * m_pSlots;
+		size_t           m_index;
+		/*! end of the range of slots, unbounded for the whole array, which may grow while it is walked */
+		size_t           m_last;
+	};
+
+	/*!
+		\brief the live elements of a range of slots, a chunk of the array
+
+		The chunks of disjoint ranges can be walked by several threads at once.
+		\code
+		for( CVertex * pV : pMesh->vertices().chunk( first, last ) ) ...
+		\endcode
+	*/
+	class range
+	{
+	public:
+		range( std::vector<T> * pSlots, size_t first, size_t last ) : m_pSlots( pSlots ), m_first( first ), m_last( last ) {};
+
+		iterator begin() { return iterator( m_pSlots, m_first, m_last ); };
+		iterator end()   { return iterator( m_pSlots, m_last, m_last ); };
+
+	protected:
+		std::vector<T> * m_pSlots;
+		size_t           m_first;
+		size_t           m_last;
+	};
+
+	CElementArray() : m_live( 0 ) {};
+
+	iterator begin() { return iterator( &m_slots, 0 ); };
+	iterator end()   { return iterator( &m_slots, m_slots.size() ); };
+
+	/*! the live elements of the slots first to last - 1 */
+	range chunk( size_t first, size_t last )
+	{
+		last  = ( last < m_slots.size() ) ? last : m_slots.size();
+		first = ( first < last ) ? first : last;
+		return range( &m_slots, first, last );
+	};
+
+	/*! number of live elements */
+	size_t size() const  { return m_live; };
+	/*! whether there is no live element */
+	bool   empty() const { return m_live == 0; };
+	/*! number of slots, live elements and tombstones */
+	size_t slots() const { return m_slots.size(); };
+	/*! reserve the slots before a load */
+	void   reserve( size_t n ) { m_slots.reserve( n ); };
+
+	/*! append an element, its handle is the new slot */
+	void push_back( T p )
+	{
+		p->handle() = (int)m_slots.size();
+		m_slots.push_back( p );
+		m_live ++;
+	};
+	/*! remove an element, leaving a tombstone */
+	void remove( T p )
+	{
+		int h = p->handle();
+		if( h < 0 || h >= (int)m_slots.size() || m_slots[h] != p ) return;
+		m_slots[h] = NULL;
+		p->handle() = -1;
+		m_live --;
+	};
+	/*! the element of a handle, NULL for a tombstone */
+	T operator[]( int h ) { return m_slots[h]; };
+	/*! the first live element */
+	T front() { return *begin(); };
+	/*! the last live element */
+	T back() { return *(-- end()); };
+
+	/*! drop the tombstones, keeping the order, and renumber the handles */
+	void compact()
+	{
+		size_t n = 0;
+		for( size_t i = 0; i < m_slots.size(); i ++ )
+		{
+			if( m_slots[i] == NULL ) continue;
+			m_slots[n] = m_slots[i];
+			m_slots[n]->handle() = (int)n;
+			n ++;
+		}
+		m_slots.resize( n );
+	};
+
+	void clear() { m_slots.clear(); m_live = 0; };
+
+protected:
+	/*! element pointers and tombstones, by handle */
+	std::vector<T> m_slots;
+	/*! number of live elements */
+	size_t         m_live;
+};
+
+/*!
+	\brief CElementPool, allocates the elements of one type in blocks.
+
+	Elements created one after another lie next to each other in memory,
+	so walking them in creation order, as the mesh iterators do after a
+	load, is sequential. The addresses never move. Destroyed elements are
+	reused by the next creations. The pool releases its blocks, the owner
+	destroys the live elements first.
+
+	\tparam T element type
+*/
+template<typename T>
+class CElementPool
+{
+public:
+	CElementPool() : m_next( BLOCK_SIZE ) {};
+	~CElementPool()
+	{
+		for( size_t i = 0; i < m_blocks.size(); i ++ ) ::operator delete( m_blocks[i] );
+	};
+
+	/*! construct a new element */
+	T * create()
+	{
+		void * p;
+		if( !m_free.empty() )
+		{
+			p = m_free.back();
+			m_free.pop_back();
+		}
+		else
+		{
+			if( m_next == BLOCK_SIZE )
+			{
+				m_blocks.push_back( (T*)::operator new( BLOCK_SIZE * sizeof(T) ) );
+				m_next = 0;
+			}
+			p = m_blocks.back() + m_next ++;
+		}
+		return new( p ) T();
+	};
+
+	/*! destroy an element, its memory is reused */
+	void destroy( T * p )
+	{
+		if( p == NULL ) return;
+		p->~T();
+		m_free.push_back( p );
+	};
+
+	/*! release the blocks, the owner destroys the live elements first,
+	    the next creations are laid out from the start again */
+	void clear()
+	{
+		for( size_t i = 0; i < m_blocks.size(); i ++ ) ::operator delete( m_blocks[i] );
+		m_blocks.clear();
+		m_free.clear();
+		m_next = BLOCK_SIZE;
+	};
+
+protected:
+	CElementPool( const CElementPool & );
+	CElementPool & operator=( const CElementPool & );
+
+	enum { BLOCK_SIZE = 1024 };
+
+	/*! the blocks, each of BLOCK_SIZE elements */
+	std::vector<T*> m_blocks;
+	/*! next unused element in the last block */
+	size_t          m_next;
+	/*! destroyed elements */
+	std::vector<T*> m_free;
+};
+
+}
+#endif
@@ -27,7 +27,7 @@ public:
 	/*!	
 	CFace constructor
 	*/
-	CFace(){ m_halfedge = NULL; };
+	CFace(){ m_halfedge = NULL; m_handle = -1; };
 	/*!
 	CFace destructor
 	*/
@@ -44,6 +44,10 @@ public:
 		The value of the current face id.
 	*/
 	const int             id() const { return m_id;      };
+	/*!
+		Slot of the face in the mesh face array.
+	*/
+	int		            & handle()      { return m_handle;  };
 	/*!
 		The string of the current face.
 	*/
@@ -61,6 +65,10 @@ protected:
 		id of the current face
 	*/
 	int			       m_id;
+	/*!
+		slot in the mesh face array
+	*/
+	int			       m_handle;
 	/*!
 		One halfedge  attaching to the current face.
 	*/
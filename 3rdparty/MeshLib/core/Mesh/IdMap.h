@@ -0,0 +1,189 @@
+/*!
+*      \file IdMap.h
+*      \brief Lookup of the mesh elements by their ids
+*
+*/
+
+#ifndef _MESHLIB_ID_MAP_H_
+#define _MESHLIB_ID_MAP_H_
+
+#include <stdlib.h>
+#include <limits.h>
+#include <vector>
+
+namespace MeshLib
+{
+/*!
+	\brief CIdMap, the element of each id.
+
+	The ids of a mesh file are almost always dense, 1 to n. While they
+	stay dense, the elements are kept in an array indexed by the id, so
+	a lookup is one load. The first id which would leave the array more
+	than half empty, or a negative id, switches the map to an open
+	addressing hash table with linear probing, which it keeps until
+	cleared.
+
+	\tparam T pointer to the element type
+*/
+template<typename T>
+class CIdMap
+{
+public:
+	CIdMap() : m_size( 0 ), m_dense( true ), m_used( 0 ) {};
+
+	/*! number of elements */
+	size_t size() const { return m_size; };
+
+	/*! expect n elements with the ids 1 to n */
+	void reserve( size_t n ) { if( m_dense ) m_array.reserve( n + 1 ); };
+
+	/*!
+		insert an element, an id already in the map keeps its element
+		\return whether the element has been inserted
+	*/
+	bool insert( int id, T p )
+	{
+		if( m_dense && id >= 0 && (size_t)id < m_array.size() )
+		{
+			if( m_array[id] != NULL ) return false;
+			m_array[id] = p;
+			m_size ++;
+			return true;
+		}
+		if( m_dense && id >= 0 && (size_t)id < 2 * m_size + DENSE_SLACK )
+		{
+			m_array.resize( id + 1, NULL );
+			m_array[id] = p;
+			m_size ++;
+			return true;
+		}
+		if( m_dense ) _to_hash();
+
+		if( 2 * ( m_used + 1 ) > m_keys.size() ) _rehash( 2 * ( m_size + 1 ) );
+		size_t i = _probe( id );
+		if( m_keys[i] == id ) return false;
+		// reuse the first deleted slot on the way
+		size_t j = _first_free( id );
+		if( m_keys[j] == EMPTY ) m_used ++;
+		m_keys[j]   = id;
+		m_values[j] = p;
+		m_size ++;
+		return true;
+	};
+
+	/*! the element of an id, NULL if there is none */
+	T find( int id ) const
+	{
+		if( m_dense ) return ( id >= 0 && (size_t)id < m_array.size() ) ? m_array[id] : NULL;
+		if( m_keys.empty() ) return NULL;
+		size_t i = _probe( id );
+		return ( m_keys[i] == id ) ? m_values[i] : NULL;
+	};
+
+	/*! remove the element of an id */
+	void erase( int id )
+	{
+		if( m_dense )
+		{
+			if( id >= 0 && (size_t)id < m_array.size() && m_array[id] != NULL )
+			{
+				m_array[id] = NULL;
+				m_size --;
+			}
+			return;
+		}
+		if( m_keys.empty() ) return;
+		size_t i = _probe( id );
+		if( m_keys[i] != id ) return;
+		m_keys[i]   = DELETED;
+		m_values[i] = NULL;
+		m_size --;
+	};
+
+	/*! remove all the elements, the map is dense again */
+	void clear()
+	{
+		m_array.clear();
+		m_keys.clear();
+		m_values.clear();
+		m_size  = 0;
+		m_used  = 0;
+		m_dense = true;
+	};
+
+protected:
+	enum { DENSE_SLACK = 1024 };
+	enum { EMPTY = INT_MIN, DELETED = INT_MIN + 1 };
+
+	/*! slot of the id, or the empty slot ending its probe sequence */
+	size_t _probe( int id ) const
+	{
+		size_t mask = m_keys.size() - 1;
+		size_t i = _hash( id ) & mask;
+		while( m_keys[i] != id && m_keys[i] != EMPTY ) i = ( i + 1 ) & mask;
+		return i;
+	};
+
+	/*! first deleted or empty slot in the probe sequence of the id */
+	size_t _first_free( int id ) const
+	{
+		size_t mask = m_keys.size() - 1;
+		size_t i = _hash( id ) & mask;
+		while( m_keys[i] != EMPTY && m_keys[i] != DELETED ) i = ( i + 1 ) & mask;
+		return i;
+	};
+
+	static size_t _hash( int id ) { return (size_t)( (unsigned int)id * 2654435761u ); };
+
+	/*! rebuild the table with room for n elements at half load */
+	void _rehash( size_t n )
+	{
+		size_t capacity = 16;
+		while( capacity < 2 * n ) capacity *= 2;
+
+		std::vector<int> keys( capacity, (int)EMPTY );
+		std::vector<T>   values( capacity, (T)NULL );
+		keys.swap( m_keys );
+		values.swap( m_values );
+		m_used = 0;
+		for( size_t i = 0; i < keys.size(); i ++ )
+		{
+			if( keys[i] == EMPTY || keys[i] == DELETED ) continue;
+			size_t j = _first_free( keys[i] );
+			m_keys[j]   = keys[i];
+			m_values[j] = values[i];
+			m_used ++;
+		}
+	};
+
+	/*! move the dense array into the hash table */
+	void _to_hash()
+	{
+		m_dense = false;
+		_rehash( m_size + 1 );
+		for( size_t id = 0; id < m_array.size(); id ++ )
+		{
+			if( m_array[id] == NULL ) continue;
+			size_t j = _first_free( (int)id );
+			m_keys[j]   = (int)id;
+			m_values[j] = m_array[id];
+			m_used ++;
+		}
+		std::vector<T>().swap( m_array );
+	};
+
+	/*! number of elements */
+	size_t           m_size;
+	/*! whether the elements are in the dense array */
+	bool             m_dense;
+	/*! the element of each id, in the dense mode */
+	std::vector<T>   m_array;
+	/*! keys and values of the hash table, a power of two of slots */
+	std::vector<int> m_keys;
+	std::vector<T>   m_values;
+	/*! slots of the hash table not empty, elements and deleted */
+	size_t           m_used;
+};
+
+}
+#endif
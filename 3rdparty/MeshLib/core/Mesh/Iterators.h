@@ -810,7 +810,7 @@ private:
 	/*! 
 	Current vertex list iterator.
 	*/
-	typename std::list<CVertex*>::iterator m_iter;
+	typename CElementArray<CVertex*>::iterator m_iter;
 };
 
 // mesh->f
@@ -858,7 +858,7 @@ private:
 	CBaseMesh<CVertex,CEdge,CFace,CHalfEdge> * m_pMesh;
 	/*! Current face list iterator.
 	*/
-	typename std::list<CFace*>::iterator  m_iter;
+	typename CElementArray<CFace*>::iterator  m_iter;
 };
 
 //Mesh->e
@@ -908,7 +908,7 @@ private:
 	/*!
 	current edge list iterator
 	*/
-	typename std::list<CEdge*>::iterator m_iter;
+	typename CElementArray<CEdge*>::iterator m_iter;
 };
 
 // Mesh->he
@@ -1005,7 +1005,7 @@ private:
 	/*!
 		Current edge list iterator
 	*/
-	typename std::list<CEdge*>::iterator m_iter;
+	typename CElementArray<CEdge*>::iterator m_iter;
 	int  m_id;
 };
 
@@ -0,0 +1,262 @@
+/*!
+*      \file Ordering.h
+*      \brief Orders of the mesh elements for cache locality
+*
+*/
+
+#ifndef _MESHLIB_ORDERING_H_
+#define _MESHLIB_ORDERING_H_
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace MeshLib
+{
+/*!
+	\brief COrdering, permutations of the vertices and faces of a mesh.
+
+	Reverse Cuthill-McKee numbers the vertices by breadth first search from
+	a pseudo-peripheral vertex, so the neighbors of a vertex get close
+	numbers, which bounds the bandwidth of the matrices assembled over the
+	edges and the fill of their factorizations. The Hilbert order sorts the
+	vertices along the Hilbert curve of their bounding cube. Each order is
+	a vector, order[k] is the element placed k-th.
+	\code
+	std::vector<int> order;
+	COrdering::rcm( offsets, adjacency, order );
+	\endcode
+*/
+class COrdering
+{
+public:
+	enum { RCM = 0, HILBERT = 1 };
+
+	/*!
+		reverse Cuthill-McKee order of a graph, component by component
+		\param offsets the neighbors of the vertex i are adjacency[offsets[i]] to adjacency[offsets[i+1]-1]
+		\param adjacency the neighbors of the vertices
+		\param order the vertices in the new order
+	*/
+	static void rcm( const std::vector<int> & offsets, const std::vector<int> & adjacency, std::vector<int> & order )
+	{
+		int n = (int)offsets.size() - 1;
+		order.clear();
+		if( n <= 0 ) return;
+		order.reserve( n );
+
+		std::vector<int> degree( n );
+		for( int i = 0; i < n; i ++ ) degree[i] = offsets[i + 1] - offsets[i];
+
+		// the components start from their vertices of lowest degree
+		std::vector<int> seeds( n );
+		for( int i = 0; i < n; i ++ ) seeds[i] = i;
+		std::stable_sort( seeds.begin(), seeds.end(), [&]( int a, int b ) { return degree[a] < degree[b]; } );
+
+		std::vector<char> placed( n, 0 );
+		std::vector<int>  stamp( n, -1 );
+		std::vector<int>  queue;
+		int pass = 0;
+		for( int s = 0; s < n; s ++ )
+		{
+			if( placed[seeds[s]] ) continue;
+			int root = _peripheral( seeds[s], offsets, adjacency, degree, stamp, pass, queue );
+
+			// Cuthill-McKee, the neighbors by increasing degree
+			size_t head = order.size();
+			order.push_back( root );
+			placed[root] = 1;
+			while( head < order.size() )
+			{
+				int v = order[head ++];
+				size_t first = order.size();
+				for( int k = offsets[v]; k < offsets[v + 1]; k ++ )
+				{
+					int u = adjacency[k];
+					if( placed[u] ) continue;
+					placed[u] = 1;
+					order.push_back( u );
+				}
+				std::stable_sort( order.begin() + first, order.end(), [&]( int a, int b ) { return degree[a] < degree[b]; } );
+			}
+		}
+		std::reverse( order.begin(), order.end() );
+	};
+
+	/*!
+		order of points along the Hilbert curve of their bounding cube
+		\param points x y z of each point
+		\param order the points in the new order
+	*/
+	static void hilbert( const std::vector<double> & points, std::vector<int> & order )
+	{
+		int n = (int)( points.size() / 3 );
+		order.clear();
+		if( n <= 0 ) return;
+
+		double lo[3], hi[3];
+		for( int j = 0; j < 3; j ++ ) lo[j] = hi[j] = points[j];
+		for( int i = 1; i < n; i ++ )
+			for( int j = 0; j < 3; j ++ )
+			{
+				double x = points[3 * i + j];
+				lo[j] = ( x < lo[j] ) ? x : lo[j];
+				hi[j] = ( x > hi[j] ) ? x : hi[j];
+			}
+		// a cube, the curve keeps its shape along the longest axis
+		double extent = 0;
+		for( int j = 0; j < 3; j ++ ) extent = ( hi[j] - lo[j] > extent ) ? hi[j] - lo[j] : extent;
+		double scale = ( extent > 0 ) ? ( ( 1u << BITS ) - 1 ) / extent : 0;
+
+		std::vector< std::pair<unsigned long long, int> > keys( n );
+		for( int i = 0; i < n; i ++ )
+		{
+			unsigned int x[3];
+			for( int j = 0; j < 3; j ++ ) x[j] = (unsigned int)( ( points[3 * i + j] - lo[j] ) * scale );
+			keys[i] = std::make_pair( _hilbert_key( x ), i );
+		}
+		std::sort( keys.begin(), keys.end() );
+
+		order.resize( n );
+		for( int i = 0; i < n; i ++ ) order[i] = keys[i].second;
+	};
+
+	/*!
+		order of the faces by their first vertex in the vertex order, keeping
+		the order of the faces which share it
+		\param offsets the vertices of the face i are indices[offsets[i]] to indices[offsets[i+1]-1]
+		\param indices the vertices of the faces
+		\param rank the position of each vertex in the vertex order
+		\param order the faces in the new order
+	*/
+	static void faces( const std::vector<int> & offsets, const std::vector<int> & indices, const std::vector<int> & rank, std::vector<int> & order )
+	{
+		int nf = (int)offsets.size() - 1;
+		order.clear();
+		if( nf <= 0 ) return;
+
+		// counting sort on the first vertex, which is stable
+		std::vector<int> key( nf ), count( rank.size() + 1, 0 );
+		for( int i = 0; i < nf; i ++ )
+		{
+			int r = (int)rank.size();
+			for( int k = offsets[i]; k < offsets[i + 1]; k ++ ) r = ( rank[indices[k]] < r ) ? rank[indices[k]] : r;
+			key[i] = r;
+			count[r] ++;
+		}
+		int sum = 0;
+		for( size_t r = 0; r < count.size(); r ++ )
+		{
+			int c = count[r];
+			count[r] = sum;
+			sum += c;
+		}
+		order.resize( nf );
+		for( int i = 0; i < nf; i ++ ) order[count[key[i]] ++] = i;
+	};
+
+	/*!
+		bandwidth of a graph in an order, the largest distance between the
+		positions of two neighbors
+		\param rank the position of each vertex in the order
+	*/
+	static int bandwidth( const std::vector<int> & offsets, const std::vector<int> & adjacency, const std::vector<int> & rank )
+	{
+		int b = 0;
+		for( int i = 0; i + 1 < (int)offsets.size(); i ++ )
+			for( int k = offsets[i]; k < offsets[i + 1]; k ++ )
+			{
+				int d = rank[i] - rank[adjacency[k]];
+				b = ( d > b ) ? d : b;
+			}
+		return b;
+	};
+
+protected:
+	/*! bits of each coordinate of the Hilbert curve */
+	enum { BITS = 21 };
+
+	/*!
+		pseudo-peripheral vertex of the component of a vertex, by the
+		George-Liu iteration: restart from the lowest degree vertex of the
+		last level while the eccentricity grows
+	*/
+	static int _peripheral( int root, const std::vector<int> & offsets, const std::vector<int> & adjacency,
+		const std::vector<int> & degree, std::vector<int> & stamp, int & pass, std::vector<int> & queue )
+	{
+		int best = root, eccentricity = -1;
+		for( int iteration = 0; iteration < 8; iteration ++ )
+		{
+			// breadth first search level by level
+			pass ++;
+			queue.clear();
+			queue.push_back( root );
+			stamp[root] = pass;
+			size_t head = 0, last = 0;
+			int levels = 0;
+			while( head < queue.size() )
+			{
+				last = head;
+				size_t end = queue.size();
+				for( ; head < end; head ++ )
+				{
+					int v = queue[head];
+					for( int k = offsets[v]; k < offsets[v + 1]; k ++ )
+					{
+						int u = adjacency[k];
+						if( stamp[u] == pass ) continue;
+						stamp[u] = pass;
+						queue.push_back( u );
+					}
+				}
+				levels ++;
+			}
+			if( levels <= eccentricity ) break;
+			best = root;
+			eccentricity = levels;
+
+			int next = queue[last];
+			for( size_t i = last + 1; i < queue.size(); i ++ ) if( degree[queue[i]] < degree[next] ) next = queue[i];
+			if( next == root ) break;
+			root = next;
+		}
+		return best;
+	};
+
+	/*!
+		position on the Hilbert curve of a point of the 2^BITS grid, by
+		Skilling's transform of the axes to the transposed index
+	*/
+	static unsigned long long _hilbert_key( unsigned int x[3] )
+	{
+		unsigned int m = 1u << ( BITS - 1 ), p, q, t;
+		for( q = m; q > 1; q >>= 1 )
+		{
+			p = q - 1;
+			for( int i = 0; i < 3; i ++ )
+			{
+				if( x[i] & q ) x[0] ^= p;
+				else
+				{
+					t = ( x[0] ^ x[i] ) & p;
+					x[0] ^= t;
+					x[i] ^= t;
+				}
+			}
+		}
+		// Gray encode
+		for( int i = 1; i < 3; i ++ ) x[i] ^= x[i - 1];
+		t = 0;
+		for( q = m; q > 1; q >>= 1 ) if( x[2] & q ) t ^= q - 1;
+		for( int i = 0; i < 3; i ++ ) x[i] ^= t;
+
+		// interleave the bits, the highest of x[0] first
+		unsigned long long key = 0;
+		for( int b = BITS - 1; b >= 0; b -- )
+			for( int i = 0; i < 3; i ++ ) key = ( key << 1 ) | ( ( x[i] >> b ) & 1 );
+		return key;
+	};
+};
+
+}
+#endif
@@ -0,0 +1,212 @@
+/*!
+*      \file Topology.h
+*      \brief Connected components, boundary loops and genus of a mesh
+*
+*/
+
+
+#ifndef _TOPOLOGY_H_
+#define _TOPOLOGY_H_
+
+#include <unordered_map>
+#include <vector>
+
+#include "../Mesh/BaseMesh.h"
+#include "../Mesh/Iterators.h"
+
+namespace MeshLib
+{
+/*!
+	\brief CComponent Topology of one connected component.
+*/
+struct CComponent
+{
+	/*! number of vertices, edges, faces and boundary loops */
+	int vertices;
+	int edges;
+	int faces;
+	int boundaries;
+
+	CComponent() : vertices(0), edges(0), faces(0), boundaries(0) {};
+
+	/*! Euler characteristic V - E + F */
+	int euler() { return vertices - edges + faces; };
+	/*! genus, from V - E + F = 2 - 2g - b */
+	int genus() { return ( 2 - euler() - boundaries ) / 2; };
+};
+
+/*!
+	\brief CTopology Topology analyzer class.
+
+	Labels the connected components by union-find over the edges, and the
+	boundary loops by union-find over the boundary edges, in linear time,
+	without tracing the loops. The genus of each component follows from
+	its Euler characteristic.
+
+	\tparam CVertex Vertex type
+	\tparam CEdge   Edge   type
+	\tparam CFace   Face   type
+	\tparam CHalfEdge HalfEdge type
+*/
+
+template<typename CVertex, typename CEdge, typename CFace, typename CHalfEdge>
+class CTopology
+{
+public:
+	/*!
+	CTopology constructor, analyzes the mesh
+	\param pMesh pointer to the current mesh
+	*/
+	CTopology( CBaseMesh<CVertex, CEdge, CFace, CHalfEdge> * pMesh );
+
+	/*!
+	The connected components.
+	*/
+	std::vector<CComponent> & components() { return m_components; };
+	/*!
+	The component of each vertex, in the order of the vertex list.
+	*/
+	std::vector<int> & vertex_component() { return m_vertex_component; };
+
+	/*! Euler characteristic of the whole mesh */
+	int euler();
+	/*! sum of the genera of the components */
+	int genus();
+	/*! total number of boundary loops */
+	int boundaries();
+
+	/*! one component without boundary */
+	bool is_closed() { return m_components.size() == 1 && m_components[0].boundaries == 0; };
+	/*! one component of genus zero with one boundary loop */
+	bool is_disk() { return m_components.size() == 1 && m_components[0].boundaries == 1 && m_components[0].genus() == 0; };
+
+protected:
+	/*! root of the set of i, halving the path */
+	int _find( std::vector<int> & parent, int i );
+	/*! merge the sets of i and j */
+	void _union( std::vector<int> & parent, int i, int j );
+
+protected:
+	/*!
+		Pointer to the current mesh.
+	*/
+	CBaseMesh<CVertex,CEdge,CFace,CHalfEdge>		* m_pMesh;
+	/*!
+		The connected components.
+	*/
+	std::vector<CComponent>							  m_components;
+	/*!
+		The component of each vertex.
+	*/
+	std::vector<int>								  m_vertex_component;
+};
+
+template<typename CVertex, typename CEdge, typename CFace, typename CHalfEdge>
+int CTopology<CVertex, CEdge, CFace, CHalfEdge>::_find( std::vector<int> & parent, int i )
+{
+	while( parent[i] != i )
+	{
+		parent[i] = parent[parent[i]];
+		i = parent[i];
+	}
+	return i;
+}
+
+template<typename CVertex, typename CEdge, typename CFace, typename CHalfEdge>
+void CTopology<CVertex, CEdge, CFace, CHalfEdge>::_union( std::vector<int> & parent, int i, int j )
+{
+	i = _find( parent, i );
+	j = _find( parent, j );
+	if( i == j ) return;
+	//the smaller index becomes the root, so the roots are found in vertex order
+	if( i < j ) parent[j] = i; else parent[i] = j;
+}
+
+template<typename CVertex, typename CEdge, typename CFace, typename CHalfEdge>
+CTopology<CVertex, CEdge, CFace, CHalfEdge>::CTopology( CBaseMesh<CVertex, CEdge, CFace, CHalfEdge> * pMesh )
+{
+	m_pMesh = pMesh;
+
+	//index the vertices
+	const int nv = m_pMesh->numVertices();
+	std::unordered_map<CVertex*, int> index;
+	index.reserve( nv );
+	for( MeshVertexIterator<CVertex, CEdge, CFace, CHalfEdge> viter( m_pMesh ); !viter.end(); viter ++ )
+	{
+		int i = (int)index.size();
+		index[*viter] = i;
+	}
+
+	//components by the edges, boundary loops by the boundary edges
+	std::vector<int> parent( nv ), loop( nv );
+	std::vector<bool> on_boundary( nv, false );
+	for( int i = 0; i < nv; i ++ )
+	{
+		parent[i] = i;
+		loop[i] = i;
+	}
+	for( MeshEdgeIterator<CVertex, CEdge, CFace, CHalfEdge> eiter( m_pMesh ); !eiter.end(); eiter ++ )
+	{
+		CEdge * e = *eiter;
+		int i = index[m_pMesh->edgeVertex1( e )];
+		int j = index[m_pMesh->edgeVertex2( e )];
+		_union( parent, i, j );
+		if( !m_pMesh->isBoundary( e ) ) continue;
+		_union( loop, i, j );
+		on_boundary[i] = true;
+		on_boundary[j] = true;
+	}
+
+	//number the components in vertex order, then count
+	m_vertex_component.assign( nv, -1 );
+	for( int i = 0; i < nv; i ++ )
+	{
+		int r = _find( parent, i );
+		if( m_vertex_component[r] < 0 )
+		{
+			m_vertex_component[r] = (int)m_components.size();
+			m_components.push_back( CComponent() );
+		}
+		m_vertex_component[i] = m_vertex_component[r];
+
+		CComponent & c = m_components[m_vertex_component[i]];
+		c.vertices ++;
+		if( on_boundary[i] && _find( loop, i ) == i ) c.boundaries ++;
+	}
+	for( MeshEdgeIterator<CVertex, CEdge, CFace, CHalfEdge> eiter( m_pMesh ); !eiter.end(); eiter ++ )
+	{
+		m_components[m_vertex_component[index[m_pMesh->edgeVertex1( *eiter )]]].edges ++;
+	}
+	for( MeshFaceIterator<CVertex, CEdge, CFace, CHalfEdge> fiter( m_pMesh ); !fiter.end(); fiter ++ )
+	{
+		CHalfEdge * he = m_pMesh->faceHalfedge( *fiter );
+		m_components[m_vertex_component[index[m_pMesh->halfedgeTarget( he )]]].faces ++;
+	}
+}
+
+template<typename CVertex, typename CEdge, typename CFace, typename CHalfEdge>
+int CTopology<CVertex, CEdge, CFace, CHalfEdge>::euler()
+{
+	int chi = 0;
+	for( size_t i = 0; i < m_components.size(); i ++ ) chi += m_components[i].euler();
+	return chi;
+}
+
+template<typename CVertex, typename CEdge, typename CFace, typename CHalfEdge>
+int CTopology<CVertex, CEdge, CFace, CHalfEdge>::genus()
+{
+	int g = 0;
+	for( size_t i = 0; i < m_components.size(); i ++ ) g += m_components[i].genus();
+	return g;
+}
+
+template<typename CVertex, typename CEdge, typename CFace, typename CHalfEdge>
+int CTopology<CVertex, CEdge, CFace, CHalfEdge>::boundaries()
+{
+	int b = 0;
+	for( size_t i = 0; i < m_components.size(); i ++ ) b += m_components[i].boundaries;
+	return b;
+}
+
+}
+#endif
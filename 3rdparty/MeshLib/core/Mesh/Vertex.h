@@ -12,6 +12,7 @@
 #include <stdlib.h>
 #include <string>
 #include <list>
+#include <vector>
 #include "../Geometry/Point.h"
 #include "../Geometry/Point2.h"
 #include "HalfEdge.h"
@@ -30,7 +31,7 @@ namespace MeshLib{
 	  /*!
 	  CVertex constructor
 	  */
-      CVertex(){ m_halfedge = NULL; m_boundary = false; };
+      CVertex(){ m_halfedge = NULL; m_boundary = false; m_handle = -1; };
 	  /*!
 	  CVertex destructor 
 	  */
@@ -68,6 +69,9 @@ namespace MeshLib{
 	/*! Vertex id. 
 	*/
     int  & id() { return m_id; };
+	/*! Slot of the vertex in the mesh vertex array. 
+	*/
+    int  & handle() { return m_handle; };
 	/*! Whether the vertex is on the boundary. 
 	*/
     bool & boundary() { return m_boundary;};
@@ -80,12 +84,15 @@ namespace MeshLib{
 
 	/*!	Adjacent edges, temporarily used for loading the mesh
 	 */
-	std::list<CEdge*> & edges() { return m_edges; };
+	std::vector<CEdge*> & edges() { return m_edges; };
   protected:
 
     /*! Vertex ID. 
 	*/
     int    m_id ;
+    /*! Slot in the mesh vertex array. 
+	*/
+    int    m_handle;
     /*! Vertex position point. 
 	*/
     CPoint m_point;
@@ -107,7 +114,7 @@ namespace MeshLib{
 
 	/*! List of adjacent edges, such that current vertex is the end vertex of the edge with smaller id
 	 */
-	std::list<CEdge*> m_edges;
+	std::vector<CEdge*> m_edges;
 
   }; //class CVertex
 
@@ -0,0 +1,289 @@
+/*!
+*      \file attributes.h
+*      \brief Typed attribute columns, the traits of the elements kept as numbers instead of strings
+*
+*/
+
+#ifndef _MESHLIB_ATTRIBUTES_H_
+#define _MESHLIB_ATTRIBUTES_H_
+
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "parser.h"
+
+namespace MeshLib
+{
+
+/*!
+ *	\brief CAttributeColumn, one trait of the elements, key=(x y ...), or a key alone
+ *
+ *	The rows are the elements, by their handles or ids, the numbers of the
+ *	row i are values[i*width] to values[i*width+width-1].
+ */
+struct CAttributeColumn
+{
+	CAttributeColumn( const char * key, size_t n, int w ) : name( key, n ), width( w ) {};
+
+	/*! whether the row has the trait */
+	bool has( size_t row ) const { return row < set.size() && set[row] != 0; };
+
+	/*! the numbers of a row which has the trait */
+	const double * get( size_t row ) const { return width > 0 ? &values[row * width] : NULL; };
+
+	std::string                name;
+	/*! numbers per row, 0 for a key alone, as sharp */
+	int                        width;
+	std::vector<double>        values;
+	/*! whether each row has the trait */
+	std::vector<unsigned char> set;
+};
+
+/*!
+ *	\brief CAttributeTable class, the traits of a kind of elements as typed columns
+ *
+ *	parse() moves the tokens of a trait string into the columns of their
+ *	keys, format() writes them back. A token goes to a column only if its
+ *	numbers are written back as they were read, "%g", so a string which has
+ *	been parsed and formatted is the same, but for the order of its
+ *	tokens; the other tokens stay in the string.
+ *	\code
+ *	double uv[2];
+ *	if( table.get( pV->handle(), "uv", uv, 2 ) == 2 ) ...
+ *	\endcode
+ */
+class CAttributeTable
+{
+public:
+	enum { MAX_WIDTH = 16 };
+
+	CAttributeTable() : m_limit( (size_t) -1 ) {};
+
+	/*! number of columns */
+	size_t size() const { return m_columns.size(); };
+
+	/*! the i-th column */
+	CAttributeColumn & operator[]( size_t i ) { return m_columns[i]; };
+
+	/*! remove all the columns */
+	void clear() { m_columns.clear(); };
+
+	/*! the rows from the limit on are not stored, their traits stay in the strings */
+	void limit( size_t rows ) { m_limit = rows; };
+
+	/*! the column of a key, NULL if there is none */
+	CAttributeColumn * find( const char * key ) { return _find( key, strlen( key ) ); };
+
+	/*! whether a row has a trait */
+	bool has( size_t row, const char * key )
+	{
+		CAttributeColumn * c = find( key );
+		return c != NULL && c->has( row );
+	};
+
+	/*!
+	 *	read the numbers of a trait of a row
+	 *	\param v the numbers
+	 *	\param n the number of numbers to read at most
+	 *	\return the number of numbers read, -1 if the row has not the trait
+	 */
+	int get( size_t row, const char * key, double * v, int n )
+	{
+		CAttributeColumn * c = find( key );
+		if( c == NULL || !c->has( row ) ) return -1;
+		int k = ( n < c->width ) ? n : c->width;
+		memcpy( v, c->get( row ), k * sizeof( double ) );
+		return k;
+	};
+
+	/*!
+	 *	set a trait of a row, the column is created with the width n
+	 *	\return false if the column of the key has another width
+	 */
+	bool set( size_t row, const char * key, const double * v, int n )
+	{
+		CAttributeColumn * c = _column( key, strlen( key ), n );
+		if( c == NULL ) return false;
+		_set( *c, row, v );
+		return true;
+	};
+
+	/*! remove a trait of a row */
+	void remove( size_t row, const char * key )
+	{
+		CAttributeColumn * c = find( key );
+		if( c != NULL && c->has( row ) ) c->set[row] = 0;
+	};
+
+	/*!
+	 *	move the traits of a string to a row, the row loses the traits the
+	 *	string has not, the string keeps the tokens which do not fit a column
+	 *	\param row the row
+	 *	\param str the trait string
+	 */
+	void parse( size_t row, std::string & str )
+	{
+		if( row >= m_limit ) return;
+		for( size_t i = 0; i < m_columns.size(); i ++ ) if( m_columns[i].has( row ) ) m_columns[i].set[row] = 0;
+		if( str.empty() ) return;
+
+		std::string rest;
+		double v[MAX_WIDTH];
+		CTokenizer tokenizer( str );
+		CTokenView token;
+		while( tokenizer.next( token ) )
+		{
+			int n = 0;
+			bool typed = token.m_key_size > 0;
+			if( typed && token.m_value != NULL )
+			{
+				n = token.numbers( v, MAX_WIDTH );
+				typed = n > 0 && _same( token, v, n );
+			}
+			CAttributeColumn * c = typed ? _column( token.m_key, token.m_key_size, n ) : NULL;
+			// a key twice in a string stays in it
+			if( c != NULL && !c->has( row ) )
+			{
+				_set( *c, row, v );
+				continue;
+			}
+			if( !rest.empty() ) rest += ' ';
+			rest.append( token.m_key, token.m_key_size );
+			if( token.m_value == NULL ) continue;
+			rest += '=';
+			rest.append( token.m_value, token.m_value_size );
+		}
+		// the memory of the string goes with it
+		str.swap( rest );
+	};
+
+	/*!
+	 *	append the traits of a row to a string, but the keys the string already has
+	 *	\param row the row
+	 *	\param str the trait string
+	 */
+	void format( size_t row, std::string & str ) const
+	{
+		size_t n = m_columns.size();
+		size_t end = str.size();
+		for( size_t i = 0; i < n; i ++ )
+		{
+			const CAttributeColumn & c = m_columns[i];
+			if( !c.has( row ) || ( end > 0 && _has_key( str.c_str(), c.name ) ) ) continue;
+			if( c.width > 0 )
+			{
+				CParser::_appendToken( str, c.name.c_str(), c.get( row ), c.width );
+				continue;
+			}
+			if( !str.empty() ) str += ' ';
+			str += c.name;
+		}
+	};
+
+	/*!
+	 *	drop the rows which are not live, keeping the order, as the handles
+	 *	of CElementArray::compact
+	 *	\param live whether each row is live
+	 */
+	void compact( const std::vector<bool> & live )
+	{
+		for( size_t k = 0; k < m_columns.size(); k ++ )
+		{
+			CAttributeColumn & c = m_columns[k];
+			size_t w = c.width;
+			size_t n = 0;
+			for( size_t i = 0; i < live.size(); i ++ )
+			{
+				if( !live[i] ) continue;
+				if( i < c.set.size() )
+				{
+					c.set[n] = c.set[i];
+					for( size_t j = 0; j < w; j ++ ) c.values[n * w + j] = c.values[i * w + j];
+				}
+				else if( n < c.set.size() ) c.set[n] = 0;
+				n ++;
+			}
+			if( n < c.set.size() )
+			{
+				c.set.resize( n );
+				c.values.resize( n * w );
+			}
+		}
+	};
+
+	/*! bytes held by the columns */
+	size_t bytes() const
+	{
+		size_t n = 0;
+		for( size_t i = 0; i < m_columns.size(); i ++ ) n += m_columns[i].values.capacity() * sizeof( double ) + m_columns[i].set.capacity();
+		return n;
+	};
+
+protected:
+	CAttributeColumn * _find( const char * key, size_t n )
+	{
+		for( size_t i = 0; i < m_columns.size(); i ++ )
+		{
+			const std::string & name = m_columns[i].name;
+			if( name.size() == n && memcmp( name.data(), key, n ) == 0 ) return &m_columns[i];
+		}
+		return NULL;
+	};
+
+	/*! the column of a key, created if there is none, NULL if it has another width */
+	CAttributeColumn * _column( const char * key, size_t n, int width )
+	{
+		CAttributeColumn * c = _find( key, n );
+		if( c == NULL )
+		{
+			m_columns.push_back( CAttributeColumn( key, n, width ) );
+			return &m_columns.back();
+		}
+		return ( c->width == width ) ? c : NULL;
+	};
+
+	static void _set( CAttributeColumn & c, size_t row, const double * v )
+	{
+		if( row >= c.set.size() )
+		{
+			c.set.resize( row + 1, 0 );
+			c.values.resize( ( row + 1 ) * c.width );
+		}
+		c.set[row] = 1;
+		for( int j = 0; j < c.width; j ++ ) c.values[row * c.width + j] = v[j];
+	};
+
+	/*! whether the numbers written back are the value of the token */
+	static bool _same( const CTokenView & token, const double * v, int n )
+	{
+		const char * pt  = token.m_value;
+		const char * end = token.m_value + token.m_value_size;
+		if( pt == end || *pt ++ != '(' ) return false;
+		char buffer[32];
+		for( int i = 0; i < n; i ++ )
+		{
+			if( i > 0 && ( pt == end || *pt ++ != ' ' ) ) return false;
+			int k = CTextBuffer::format( buffer, sizeof( buffer ), v[i] );
+			if( end - pt < k || memcmp( pt, buffer, k ) != 0 ) return false;
+			pt += k;
+		}
+		return end - pt == 1 && *pt == ')';
+	};
+
+	/*! whether a trait string has a key */
+	static bool _has_key( const char * str, const std::string & key )
+	{
+		CTokenizer tokenizer( str );
+		CTokenView token;
+		while( tokenizer.next( token ) ) if( token.is( key.c_str() ) ) return true;
+		return false;
+	};
+
+	std::vector<CAttributeColumn> m_columns;
+	/*! rows stored */
+	size_t                        m_limit;
+};
+
+}
+#endif
@@ -0,0 +1,580 @@
+/*!
+*      \file binary.h
+*      \brief Binary mesh files, .mb, typed columns read by memory mapping
+*
+*/
+
+#ifndef _MESHLIB_BINARY_H_
+#define _MESHLIB_BINARY_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "scanner.h"
+#include "parser.h"
+
+namespace MeshLib
+{
+
+/*
+ *	Layout of a .mb file, all the numbers are little endian
+ *
+ *	CBinaryHeader
+ *	CBinaryColumn  x header.columns
+ *	column data, each column starts on a multiple of 8 bytes
+ *
+ *	A column has one row per element of its kind, a row is width values of
+ *	its type. The columns of a mesh are
+ *
+ *	MB_VERTEX       "id" INT32, "point" FLOAT64 x 3
+ *	MB_FACE         "id" INT32, "degree" INT32, absent if all the faces are triangles
+ *	MB_FACE_VERTEX  "vertex" INT32, vertex row of each corner, face after face
+ *	MB_EDGE         "vertex" INT32 x 2, vertex rows of the edges which have traits
+ *	MB_CORNER       "corner" INT32 x 2, vertex row and face row of the corners which have traits
+ *
+ *	and the traits of the vertices, faces, edges and corners. The column
+ *	"trait" is the TEXT of the trait strings. Common traits, uv=(u v), rgb,
+ *	normal, sharp, ..., are lifted out of the strings into typed columns
+ *	named "trait:" and their key, FLOAT64 for values and BIT for flags. The
+ *	trait string of a row is its text followed by the lifted tokens, in
+ *	the order of the columns.
+ *
+ *	A TEXT column is rows + 1 UINT64 offsets, followed by the bytes.
+ *	A BIT column is one bit per row, the lowest bit of the first byte first.
+ */
+
+/*! version of the .mb files written */
+#define MB_VERSION 1
+
+/*! kinds of rows */
+enum { MB_VERTEX = 0, MB_FACE, MB_FACE_VERTEX, MB_EDGE, MB_CORNER, MB_ELEMENTS };
+
+/*! types of the column values */
+enum { MB_INT32 = 0, MB_FLOAT64, MB_BIT, MB_TEXT };
+
+/*!
+ *	\brief CBinaryHeader, the first bytes of a .mb file
+ */
+struct CBinaryHeader
+{
+	/*! "MESHBIN" */
+	char     magic[8];
+	/*! MB_VERSION */
+	uint32_t version;
+	/*! number of columns */
+	uint32_t columns;
+	/*! 0x01020304, to detect the byte order */
+	uint32_t endian;
+	uint32_t reserved;
+	/*! number of rows of each kind */
+	uint64_t rows[MB_ELEMENTS];
+};
+
+/*!
+ *	\brief CBinaryColumn, the description of a column
+ */
+struct CBinaryColumn
+{
+	/*! name of the column, zero terminated */
+	char     name[24];
+	/*! kind of the rows, MB_VERTEX ... */
+	uint32_t element;
+	/*! type of the values, MB_INT32 ... */
+	uint32_t type;
+	/*! number of values in a row */
+	uint32_t width;
+	uint32_t reserved;
+	/*! first byte of the data, from the beginning of the file */
+	uint64_t offset;
+	/*! size of the data in bytes */
+	uint64_t size;
+};
+
+/*!
+ *	\brief CBinaryTrait, a trait lifted into a typed column
+ */
+struct CBinaryTrait
+{
+	/*! kind of the rows */
+	int          element;
+	/*! key of the token */
+	const char * key;
+	/*! number of values, 0 for a flag */
+	int          width;
+};
+
+/*!
+ *	the traits written to typed columns, when all the rows have the same
+ *	value shape, flags may be missing
+ */
+static const CBinaryTrait g_binary_traits[] =
+{
+	{ MB_VERTEX, "uv",     2 },
+	{ MB_VERTEX, "rgb",    3 },
+	{ MB_VERTEX, "normal", 3 },
+	{ MB_FACE,   "rgb",    3 },
+	{ MB_FACE,   "normal", 3 },
+	{ MB_EDGE,   "sharp",  0 },
+	{ MB_EDGE,   "l",      1 },
+	{ MB_EDGE,   "weight", 1 },
+	{ MB_CORNER, "uv",     2 },
+};
+
+/*!
+ *	\brief CBinaryWriter class, collects the columns of a mesh and writes a .mb file
+ */
+class CBinaryWriter
+{
+public:
+	CBinaryWriter() { memset( m_rows, 0, sizeof( m_rows ) ); };
+
+	/*! set the number of rows of a kind */
+	void rows( int element, uint64_t n ) { m_rows[element] = n; };
+
+	/*!
+	 *	add a column, the data is copied
+	 *	\param size size of the data in bytes
+	 */
+	void column( int element, const char * name, int type, int width, const void * data, size_t size )
+	{
+		m_columns.push_back( CColumn() );
+		CColumn & c = m_columns.back();
+		memset( &c.desc, 0, sizeof( c.desc ) );
+		strncpy( c.desc.name, name, sizeof( c.desc.name ) - 1 );
+		c.desc.element = element;
+		c.desc.type    = type;
+		c.desc.width   = width;
+		c.desc.size    = size;
+		c.data.assign( (const char*) data, (const char*) data + size );
+	};
+
+	/*! add a column of the values of a vector */
+	template<typename T>
+	void column( int element, const char * name, int type, int width, const std::vector<T> & values )
+	{
+		column( element, name, type, width, values.empty() ? NULL : &values[0], values.size() * sizeof( T ) );
+	};
+
+	/*!
+	 *	add the trait columns of the rows of a kind
+	 *	\param strings the trait string of each row
+	 */
+	void traits( int element, const std::vector<const std::string*> & strings )
+	{
+		size_t n = strings.size();
+		if( n == 0 ) return;
+
+		// the lifted keys, narrowed down until every row ends with them, in order
+		std::vector<const CBinaryTrait*> keys;
+		for( size_t k = 0; k < sizeof( g_binary_traits ) / sizeof( g_binary_traits[0] ); k ++ )
+		{
+			if( g_binary_traits[k].element == element ) keys.push_back( &g_binary_traits[k] );
+		}
+
+		std::vector<char> failed;
+		while( !keys.empty() )
+		{
+			failed.assign( keys.size(), 0 );
+			for( size_t i = 0; i < n; i ++ ) _match( *strings[i], keys, failed, NULL );
+
+			std::vector<const CBinaryTrait*> kept;
+			for( size_t k = 0; k < keys.size(); k ++ )
+			{
+				if( !failed[k] ) kept.push_back( keys[k] );
+			}
+			if( kept.size() == keys.size() ) break;
+			keys.swap( kept );
+		}
+
+		// split the strings into the text and the lifted values
+		std::vector<uint64_t> offsets( 1, 0 );
+		std::vector<char>     text;
+		std::vector< std::vector<double> >  values( keys.size() );
+		std::vector< std::vector<uint8_t> > bits( keys.size() );
+		for( size_t k = 0; k < keys.size(); k ++ )
+		{
+			if( keys[k]->width > 0 ) values[k].reserve( n * keys[k]->width );
+			else bits[k].assign( ( n + 7 ) / 8, 0 );
+		}
+
+		failed.assign( keys.size(), 0 );
+		CRow row;
+		for( size_t i = 0; i < n; i ++ )
+		{
+			_match( *strings[i], keys, failed, &row );
+			text.insert( text.end(), strings[i]->c_str(), strings[i]->c_str() + row.text );
+			offsets.push_back( text.size() );
+			for( size_t k = 0; k < keys.size(); k ++ )
+			{
+				if( keys[k]->width > 0 ) values[k].insert( values[k].end(), row.values[k].begin(), row.values[k].end() );
+				else if( row.present[k] ) bits[k][i / 8] |= (uint8_t)( 1 << ( i % 8 ) );
+			}
+		}
+
+		if( !text.empty() )
+		{
+			std::vector<char> data( offsets.size() * sizeof( uint64_t ) + text.size() );
+			memcpy( &data[0], &offsets[0], offsets.size() * sizeof( uint64_t ) );
+			memcpy( &data[0] + offsets.size() * sizeof( uint64_t ), &text[0], text.size() );
+			column( element, "trait", MB_TEXT, 1, &data[0], data.size() );
+		}
+		for( size_t k = 0; k < keys.size(); k ++ )
+		{
+			std::string name = std::string( "trait:" ) + keys[k]->key;
+			if( keys[k]->width > 0 )
+				column( element, name.c_str(), MB_FLOAT64, keys[k]->width, values[k].empty() ? NULL : &values[k][0], values[k].size() * sizeof( double ) );
+			else if( std::count( bits[k].begin(), bits[k].end(), 0 ) < (ptrdiff_t) bits[k].size() )
+				column( element, name.c_str(), MB_BIT, 1, &bits[k][0], bits[k].size() );
+		}
+	};
+
+	/*!
+	 *	write the file
+	 *	\return false if the file could not be written
+	 */
+	bool write( const char * output )
+	{
+		FILE * fp = fopen( output, "wb" );
+		if( fp == NULL )
+		{
+			fprintf( stderr, "Error in opening file %s\n", output );
+			return false;
+		}
+
+		CBinaryHeader header;
+		memset( &header, 0, sizeof( header ) );
+		memcpy( header.magic, "MESHBIN", 8 );
+		header.version = MB_VERSION;
+		header.columns = (uint32_t) m_columns.size();
+		header.endian  = 0x01020304;
+		memcpy( header.rows, m_rows, sizeof( m_rows ) );
+
+		uint64_t offset = sizeof( CBinaryHeader ) + m_columns.size() * sizeof( CBinaryColumn );
+		for( size_t i = 0; i < m_columns.size(); i ++ )
+		{
+			offset = ( offset + 7 ) & ~(uint64_t) 7;
+			m_columns[i].desc.offset = offset;
+			offset += m_columns[i].desc.size;
+		}
+
+		bool ok = fwrite( &header, sizeof( header ), 1, fp ) == 1;
+		for( size_t i = 0; ok && i < m_columns.size(); i ++ )
+		{
+			ok = fwrite( &m_columns[i].desc, sizeof( CBinaryColumn ), 1, fp ) == 1;
+		}
+		uint64_t written = sizeof( CBinaryHeader ) + m_columns.size() * sizeof( CBinaryColumn );
+		for( size_t i = 0; ok && i < m_columns.size(); i ++ )
+		{
+			static const char zeros[8] = { 0 };
+			size_t pad = (size_t)( m_columns[i].desc.offset - written );
+			if( pad > 0 ) ok = fwrite( zeros, 1, pad, fp ) == pad;
+			if( ok && !m_columns[i].data.empty() ) ok = fwrite( &m_columns[i].data[0], 1, m_columns[i].data.size(), fp ) == m_columns[i].data.size();
+			written = m_columns[i].desc.offset + m_columns[i].desc.size;
+		}
+		if( fclose( fp ) != 0 ) ok = false;
+
+		if( !ok ) fprintf( stderr, "Error in writing file %s\n", output );
+		return ok;
+	};
+
+protected:
+	struct CColumn
+	{
+		CBinaryColumn     desc;
+		std::vector<char> data;
+	};
+
+	/*! a trait string split by _match */
+	struct CRow
+	{
+		/*! length of the text kept as text */
+		size_t text;
+		/*! values of the lifted keys */
+		std::vector< std::vector<double> > values;
+		/*! whether the lifted flags are present */
+		std::vector<char> present;
+	};
+
+	/*!
+	 *	check that a trait string is its text followed by the tokens of the
+	 *	keys, in order, with the values written as _appendToken writes them,
+	 *	so it can be rebuilt byte for byte, the keys which do not fit are
+	 *	marked failed
+	 *	\param row if not NULL, the split string
+	 */
+	static void _match( const std::string & str, const std::vector<const CBinaryTrait*> & keys, std::vector<char> & failed, CRow * row )
+	{
+		CParser parser( str );
+		std::vector<char> matched( keys.size(), 0 );
+		std::vector< std::vector<double> > values( keys.size() );
+
+		// match the keys backwards against the last tokens
+		int t = (int) parser.size() - 1;
+		int k = (int) keys.size() - 1;
+		std::string token;
+		while( k >= 0 )
+		{
+			if( t >= 0 && parser[t].is( keys[k]->key ) && _lift( parser[t], *keys[k], values[k], token ) )
+			{
+				matched[k] = 1;
+				t --;
+				k --;
+				continue;
+			}
+			if( keys[k]->width > 0 ) break;
+			k --;
+		}
+
+		// the tokens before are text, where the keys may not appear
+		for( int i = 0; i <= t; i ++ )
+		{
+			for( size_t j = 0; j < keys.size(); j ++ )
+			{
+				if( parser[i].is( keys[j]->key ) ) failed[j] = 1;
+			}
+		}
+		for( size_t j = 0; j < keys.size(); j ++ )
+		{
+			if( !matched[j] && keys[j]->width > 0 ) failed[j] = 1;
+		}
+
+		// the text is the string up to the first lifted token, without the blanks
+		size_t text = str.size();
+		if( t + 1 < (int) parser.size() ) text = parser[t + 1].m_key - str.c_str();
+		while( text > 0 && str[text - 1] == ' ' ) text --;
+
+		std::string rebuilt( str, 0, text );
+		for( size_t j = 0; j < keys.size(); j ++ )
+		{
+			if( !matched[j] ) continue;
+			if( keys[j]->width > 0 )
+			{
+				CParser::_appendToken( rebuilt, keys[j]->key, &values[j][0], keys[j]->width );
+				continue;
+			}
+			if( !rebuilt.empty() ) rebuilt += ' ';
+			rebuilt += keys[j]->key;
+		}
+		if( rebuilt != str )
+		{
+			for( size_t j = 0; j < keys.size(); j ++ )
+			{
+				if( matched[j] ) failed[j] = 1;
+			}
+		}
+
+		if( row == NULL ) return;
+		row->text = text;
+		row->values.swap( values );
+		row->present.swap( matched );
+	};
+
+	/*! read the values of a token, false if they would not be written back the same */
+	static bool _lift( const CTokenView & view, const CBinaryTrait & key, std::vector<double> & values, std::string & token )
+	{
+		if( key.width == 0 ) return view.m_value == NULL;
+		if( view.m_value == NULL ) return false;
+
+		values.assign( key.width, 0 );
+		if( view.numbers( &values[0], key.width ) != key.width ) return false;
+
+		token.clear();
+		CParser::_appendToken( token, key.key, &values[0], key.width );
+		size_t size = view.m_value + view.m_value_size - view.m_key;
+		return token.size() == size && memcmp( token.c_str(), view.m_key, size ) == 0;
+	};
+
+	/*! the columns, in the order they are written */
+	std::vector<CColumn> m_columns;
+	/*! number of rows of each kind */
+	uint64_t             m_rows[MB_ELEMENTS];
+};
+
+/*!
+ *	\brief CBinaryReader class, maps a .mb file and gives its columns in place
+ */
+class CBinaryReader
+{
+public:
+	CBinaryReader() : m_header( NULL ), m_columns( NULL )
+	{
+		for( int e = 0; e < MB_ELEMENTS; e ++ ) m_text[e] = NULL;
+	};
+
+	/*!
+	 *	map and check a .mb file
+	 *	\return false if the file cannot be read
+	 */
+	bool open( const char * input )
+	{
+		close();
+		if( !m_file.open( input ) )
+		{
+			fprintf( stderr, "Error in opening file %s\n", input );
+			return false;
+		}
+		if( !_check() )
+		{
+			fprintf( stderr, "Error in reading file %s, not a valid version %d .mb file\n", input, MB_VERSION );
+			close();
+			return false;
+		}
+		return true;
+	};
+
+	/*! unmap the file */
+	void close()
+	{
+		m_file.close();
+		m_header  = NULL;
+		m_columns = NULL;
+		for( int e = 0; e < MB_ELEMENTS; e ++ )
+		{
+			m_text[e] = NULL;
+			m_traits[e].clear();
+		}
+	};
+
+	/*! number of rows of a kind */
+	size_t rows( int element ) const { return (size_t) m_header->rows[element]; };
+
+	/*! the description of a column, NULL if there is none */
+	const CBinaryColumn * find( int element, const char * name ) const
+	{
+		for( uint32_t i = 0; i < m_header->columns; i ++ )
+		{
+			if( m_columns[i].element == (uint32_t) element && strcmp( m_columns[i].name, name ) == 0 ) return m_columns + i;
+		}
+		return NULL;
+	};
+
+	/*! the values of an INT32 column, NULL if there is none of that width */
+	const int32_t * int32( int element, const char * name, int width ) const
+	{
+		return (const int32_t*) _data( element, name, MB_INT32, width );
+	};
+
+	/*! the values of a FLOAT64 column, NULL if there is none of that width */
+	const double * float64( int element, const char * name, int width ) const
+	{
+		return (const double*) _data( element, name, MB_FLOAT64, width );
+	};
+
+	/*!
+	 *	rebuild the trait string of a row
+	 *	\param str the trait string
+	 */
+	void trait( int element, size_t row, std::string & str ) const
+	{
+		str.clear();
+		if( m_text[element] != NULL )
+		{
+			const uint64_t * offsets = m_text[element];
+			const char * bytes = (const char*)( offsets + rows( element ) + 1 );
+			str.assign( bytes + offsets[row], bytes + offsets[row + 1] );
+		}
+		const std::vector<CTrait> & traits = m_traits[element];
+		for( size_t k = 0; k < traits.size(); k ++ )
+		{
+			const CTrait & t = traits[k];
+			if( t.width > 0 )
+			{
+				CParser::_appendToken( str, t.key, t.values + row * t.width, t.width );
+				continue;
+			}
+			if( !( t.bits[row / 8] & ( 1 << ( row % 8 ) ) ) ) continue;
+			if( !str.empty() ) str += ' ';
+			str += t.key;
+		}
+	};
+
+protected:
+	/*! a lifted trait column */
+	struct CTrait
+	{
+		const char *    key;
+		int             width;
+		const double *  values;
+		const uint8_t * bits;
+	};
+
+	/*! the data of a column, if its type and width are the ones expected */
+	const void * _data( int element, const char * name, int type, int width ) const
+	{
+		const CBinaryColumn * c = find( element, name );
+		if( c == NULL || c->type != (uint32_t) type || c->width != (uint32_t) width ) return NULL;
+		return m_file.begin() + c->offset;
+	};
+
+	/*! check the header and that all the columns lie in the file */
+	bool _check()
+	{
+		size_t size = m_file.size();
+		if( size < sizeof( CBinaryHeader ) ) return false;
+		m_header = (const CBinaryHeader*) m_file.begin();
+		if( memcmp( m_header->magic, "MESHBIN", 8 ) != 0 || m_header->version != MB_VERSION || m_header->endian != 0x01020304 ) return false;
+		if( m_header->columns > ( size - sizeof( CBinaryHeader ) ) / sizeof( CBinaryColumn ) ) return false;
+		for( int e = 0; e < MB_ELEMENTS; e ++ )
+		{
+			if( m_header->rows[e] >= 0x7fffffff ) return false;
+		}
+		m_columns = (const CBinaryColumn*)( m_file.begin() + sizeof( CBinaryHeader ) );
+
+		for( uint32_t i = 0; i < m_header->columns; i ++ )
+		{
+			const CBinaryColumn & c = m_columns[i];
+			if( c.element >= MB_ELEMENTS || c.offset % 8 != 0 || c.offset > size || c.size > size - c.offset ) return false;
+			if( memchr( c.name, 0, sizeof( c.name ) ) == NULL || c.width == 0 || c.width > 64 ) return false;
+
+			uint64_t n = m_header->rows[c.element];
+			switch( c.type )
+			{
+			case MB_INT32:   if( c.size != n * c.width * 4 ) return false; break;
+			case MB_FLOAT64: if( c.size != n * c.width * 8 ) return false; break;
+			case MB_BIT:     if( c.width != 1 || c.size != ( n + 7 ) / 8 ) return false; break;
+			case MB_TEXT:
+				{
+					if( c.size < ( n + 1 ) * 8 ) return false;
+					const uint64_t * offsets = (const uint64_t*)( m_file.begin() + c.offset );
+					if( offsets[0] != 0 || offsets[n] != c.size - ( n + 1 ) * 8 ) return false;
+					for( uint64_t r = 0; r < n; r ++ )
+					{
+						if( offsets[r] > offsets[r + 1] ) return false;
+					}
+				}
+				break;
+			default: return false;
+			}
+
+			if( strcmp( c.name, "trait" ) == 0 && c.type == MB_TEXT )
+			{
+				m_text[c.element] = (const uint64_t*)( m_file.begin() + c.offset );
+			}
+			else if( strncmp( c.name, "trait:", 6 ) == 0 && ( c.type == MB_FLOAT64 || c.type == MB_BIT ) )
+			{
+				CTrait t;
+				t.key    = c.name + 6;
+				t.width  = ( c.type == MB_FLOAT64 ) ? (int) c.width : 0;
+				t.values = (const double*)( m_file.begin() + c.offset );
+				t.bits   = (const uint8_t*)( m_file.begin() + c.offset );
+				m_traits[c.element].push_back( t );
+			}
+		}
+		return true;
+	};
+
+	CMappedFile             m_file;
+	const CBinaryHeader *   m_header;
+	const CBinaryColumn *   m_columns;
+	/*! the offsets of the text column of each kind, NULL if there is none */
+	const uint64_t *        m_text[MB_ELEMENTS];
+	/*! the lifted trait columns of each kind, in order */
+	std::vector<CTrait>     m_traits[MB_ELEMENTS];
+};
+
+}
+#endif
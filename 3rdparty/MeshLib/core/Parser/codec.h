@@ -0,0 +1,957 @@
+/*!
+*      \file codec.h
+*      \brief Compressed mesh files, .mc, quantized geometry and coded connectivity
+*
+*/
+
+#ifndef _MESHLIB_CODEC_H_
+#define _MESHLIB_CODEC_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+#include <vector>
+
+#include "scanner.h"
+
+#define MC_VERSION 1
+
+namespace MeshLib
+{
+
+/*
+ *	Layout of a .mc file
+ *
+ *	CCodecHeader
+ *	the streams ids, codes, indices, geometry and traits, of the sizes given by the header
+ *
+ *	The streams are bytes and varints, 7 bits per byte, the signed ones
+ *	zigzag coded.
+ *
+ *	The vertices are numbered in the order the faces first use them, the
+ *	vertices used by no face come last. Each point is quantized on a grid
+ *	of 2^bits steps over the bounding box, and coded as the difference to
+ *	a prediction: the parallelogram a + b - d when the vertex comes with a
+ *	triangle across the edge ab of an earlier triangle abd, the previous
+ *	vertex otherwise.
+ *
+ *	A triangle is coded by one byte when it shares an edge with one of the
+ *	last faces, its high nibble is that edge, 0 to 14 in a FIFO of the
+ *	last edges, its low nibble the third vertex: 0 a new vertex, 1 to 14 a
+ *	vertex of a FIFO of the last new or explicit vertices, 15 an explicit
+ *	vertex, its difference to the previous explicit vertex in the indices
+ *	stream. Otherwise the high nibble is 15 and the three vertices are
+ *	coded by three nibbles.
+ *	A face which is not a triangle is coded by one nibble per vertex, the
+ *	degrees of the faces precede them when the mesh is not all triangles.
+ *	A triangle may start at another of its vertices, its orientation is
+ *	kept.
+ *
+ *	The ids are runs of consecutive ids, the vertices in their coded
+ *	order and the faces in the order of the file. The traits are kept as
+ *	text.
+ *
+ *	Each stream is then entropy coded, the bytes by their frequencies in
+ *	the stream, CCodecEntropy.
+ */
+
+/*! streams of a .mc file */
+enum { MC_IDS, MC_CODES, MC_INDICES, MC_GEOMETRY, MC_TRAITS, MC_STREAMS };
+
+/*! flags of a .mc file */
+enum { MC_TRIANGLES = 1, MC_VERTEX_TRAITS = 2, MC_FACE_TRAITS = 4 };
+
+/*!
+ *	\brief CCodecHeader, the header of a .mc file
+ */
+struct CCodecHeader
+{
+	char     magic[8];
+	uint32_t version;
+	/*! 0x01020304 written by the machine */
+	uint32_t endian;
+	/*! bits of the quantized coordinates */
+	uint32_t bits;
+	uint32_t flags;
+	uint64_t vertices;
+	uint64_t faces;
+	uint64_t edges;
+	uint64_t corners;
+	/*! a coordinate is origin + q * step */
+	double   origin[3];
+	double   step[3];
+	uint64_t sizes[MC_STREAMS];
+};
+
+/*!
+ *	\brief CCodecMesh, the content of a .mc file in arrays
+ *
+ *	The corners of the face i are indices[offsets[i]] to indices[offsets[i+1]-1],
+ *	vertex indices counted from 0. The traits are empty, or one per element.
+ */
+struct CCodecMesh
+{
+	CCodecMesh() : offsets( 1, 0 ) {};
+
+	/*! number of vertices */
+	size_t vertices() const { return vertex_ids.size(); };
+	/*! number of faces */
+	size_t faces()    const { return face_ids.size(); };
+
+	void clear()
+	{
+		vertex_ids.clear();
+		points.clear();
+		vertex_traits.clear();
+		face_ids.clear();
+		offsets.assign( 1, 0 );
+		indices.clear();
+		face_traits.clear();
+		edges.clear();
+		edge_traits.clear();
+		corners.clear();
+		corner_traits.clear();
+	};
+
+	std::vector<int>         vertex_ids;
+	/*! x y z */
+	std::vector<double>      points;
+	std::vector<std::string> vertex_traits;
+
+	std::vector<int>         face_ids;
+	std::vector<int>         offsets;
+	std::vector<int>         indices;
+	std::vector<std::string> face_traits;
+
+	/*! the vertex indices of the edges which have traits, two per edge */
+	std::vector<int>         edges;
+	std::vector<std::string> edge_traits;
+
+	/*! the vertex and face indices of the corners which have traits */
+	std::vector<int>         corners;
+	std::vector<std::string> corner_traits;
+};
+
+/*!
+ *	\brief CCodecOutput, bytes and varints appended to a stream
+ */
+class CCodecOutput
+{
+public:
+	void byte( uint8_t b ) { m_bytes.push_back( b ); };
+
+	void uint( uint64_t v )
+	{
+		while( v >= 0x80 )
+		{
+			m_bytes.push_back( (uint8_t)( v | 0x80 ) );
+			v >>= 7;
+		}
+		m_bytes.push_back( (uint8_t) v );
+	};
+
+	void sint( int64_t v ) { uint( ( (uint64_t) v << 1 ) ^ (uint64_t)( v >> 63 ) ); };
+
+	void text( const std::string & s )
+	{
+		uint( s.size() );
+		m_bytes.insert( m_bytes.end(), s.begin(), s.end() );
+	};
+
+	std::vector<uint8_t> m_bytes;
+};
+
+/*!
+ *	\brief CCodecInput, bytes and varints read from a stream, reading past its end fails
+ */
+class CCodecInput
+{
+public:
+	CCodecInput() : m_pt( NULL ), m_end( NULL ), m_good( true ) {};
+	CCodecInput( const uint8_t * begin, const uint8_t * end ) : m_pt( begin ), m_end( end ), m_good( true ) {};
+
+	/*! whether no read has failed */
+	bool good() const { return m_good; };
+
+	/*! number of bytes read from begin */
+	size_t offset( const uint8_t * begin ) const { return (size_t)( m_pt - begin ); };
+
+	uint8_t byte()
+	{
+		if( m_pt == m_end ) { m_good = false; return 0; }
+		return *m_pt ++;
+	};
+
+	uint64_t uint()
+	{
+		uint64_t v = 0;
+		for( int shift = 0; shift < 64; shift += 7 )
+		{
+			if( m_pt == m_end ) break;
+			uint8_t b = *m_pt ++;
+			v |= (uint64_t)( b & 0x7F ) << shift;
+			if( !( b & 0x80 ) ) return v;
+		}
+		m_good = false;
+		return 0;
+	};
+
+	int64_t sint()
+	{
+		uint64_t v = uint();
+		return (int64_t)( v >> 1 ) ^ -(int64_t)( v & 1 );
+	};
+
+	void text( std::string & s )
+	{
+		uint64_t n = uint();
+		if( n > (uint64_t)( m_end - m_pt ) ) { m_good = false; s.clear(); return; }
+		s.assign( (const char*) m_pt, (size_t) n );
+		m_pt += n;
+	};
+
+protected:
+	const uint8_t * m_pt;
+	const uint8_t * m_end;
+	bool            m_good;
+};
+
+/*!
+ *	\brief CCodecEntropy, order 0 rANS coding of a stream of bytes
+ *
+ *	A coded stream is its size, then a mode: 0 the bytes, 1 a byte repeated,
+ *	2 the 256 frequencies of the bytes, out of 4096, and the rANS state
+ *	followed by its renormalization bytes.
+ */
+class CCodecEntropy
+{
+public:
+	enum { SCALE_BITS = 12, SCALE = 1 << SCALE_BITS };
+
+	/*! code the bytes in */
+	static void encode( const std::vector<uint8_t> & in, CCodecOutput & out )
+	{
+		size_t n = in.size();
+		out.uint( n );
+		if( n == 0 ) return;
+
+		uint32_t count[256] = { 0 };
+		for( size_t i = 0; i < n; i ++ ) count[in[i]] ++;
+		int symbols = 0;
+		for( int c = 0; c < 256; c ++ ) if( count[c] > 0 ) symbols ++;
+
+		if( symbols == 1 )
+		{
+			out.byte( 1 );
+			out.byte( in[0] );
+			return;
+		}
+
+		uint32_t freq[256], start[257];
+		_normalize( count, n, freq );
+		start[0] = 0;
+		for( int c = 0; c < 256; c ++ ) start[c + 1] = start[c] + freq[c];
+
+		// the symbols are coded from the last, the bytes come out reversed
+		std::vector<uint8_t> bytes;
+		bytes.reserve( n / 2 + 16 );
+		uint32_t x = LOWER;
+		for( size_t i = n; i -- > 0; )
+		{
+			uint32_t f = freq[in[i]];
+			uint32_t limit = ( ( LOWER >> SCALE_BITS ) << 8 ) * f;
+			while( x >= limit ) { bytes.push_back( (uint8_t) x ); x >>= 8; }
+			x = ( ( x / f ) << SCALE_BITS ) + ( x % f ) + start[in[i]];
+		}
+		// the state, first in the stream
+		for( int k = 3; k >= 0; k -- ) bytes.push_back( (uint8_t)( x >> ( 8 * k ) ) );
+
+		CCodecOutput table;
+		for( int c = 0; c < 256; c ++ ) table.uint( freq[c] );
+		if( table.m_bytes.size() + bytes.size() >= n )
+		{
+			out.byte( 0 );
+			out.m_bytes.insert( out.m_bytes.end(), in.begin(), in.end() );
+			return;
+		}
+		out.byte( 2 );
+		out.m_bytes.insert( out.m_bytes.end(), table.m_bytes.begin(), table.m_bytes.end() );
+		out.m_bytes.insert( out.m_bytes.end(), bytes.rbegin(), bytes.rend() );
+	};
+
+	/*!
+	 *	decode a coded stream
+	 *	\param limit the largest size of the decoded stream
+	 *	\return false if the stream is not valid
+	 */
+	static bool decode( const uint8_t * begin, const uint8_t * end, size_t limit, std::vector<uint8_t> & out )
+	{
+		out.clear();
+		CCodecInput in( begin, end );
+		uint64_t n = in.uint();
+		if( !in.good() || n > limit ) return false;
+		if( n == 0 ) return true;
+
+		uint8_t mode = in.byte();
+		if( mode == 0 )
+		{
+			if( n != (uint64_t)( end - begin ) - in.offset( begin ) ) return false;
+			out.assign( end - n, end );
+			return true;
+		}
+		if( mode == 1 )
+		{
+			out.assign( (size_t) n, in.byte() );
+			return in.good();
+		}
+		if( mode != 2 ) return false;
+
+		uint32_t freq[256], start[257];
+		start[0] = 0;
+		for( int c = 0; c < 256; c ++ )
+		{
+			uint64_t f = in.uint();
+			if( f >= SCALE ) return false;
+			freq[c] = (uint32_t) f;
+			start[c + 1] = start[c] + freq[c];
+		}
+		if( !in.good() || start[256] != SCALE ) return false;
+
+		uint8_t symbol[SCALE];
+		for( int c = 0; c < 256; c ++ ) memset( symbol + start[c], c, freq[c] );
+
+		const uint8_t * p = begin + in.offset( begin );
+		if( end - p < 4 ) return false;
+		uint32_t x = p[0] | (uint32_t) p[1] << 8 | (uint32_t) p[2] << 16 | (uint32_t) p[3] << 24;
+		p += 4;
+
+		out.resize( (size_t) n );
+		for( size_t i = 0; i < n; i ++ )
+		{
+			uint32_t slot = x & ( SCALE - 1 );
+			uint8_t  c = symbol[slot];
+			out[i] = c;
+			x = freq[c] * ( x >> SCALE_BITS ) + slot - start[c];
+			while( x < LOWER )
+			{
+				if( p == end ) return false;
+				x = ( x << 8 ) | *p ++;
+			}
+		}
+		return p == end;
+	};
+
+protected:
+	enum { LOWER = 1u << 23 };
+
+	/*! frequencies out of SCALE, at least 1 for the bytes which occur */
+	static void _normalize( const uint32_t * count, size_t n, uint32_t * freq )
+	{
+		uint32_t sum = 0;
+		for( int c = 0; c < 256; c ++ )
+		{
+			freq[c] = (uint32_t)( (uint64_t) count[c] * SCALE / n );
+			if( count[c] > 0 && freq[c] == 0 ) freq[c] = 1;
+			sum += freq[c];
+		}
+		while( sum != SCALE )
+		{
+			int largest = 0;
+			for( int c = 1; c < 256; c ++ ) if( freq[c] > freq[largest] ) largest = c;
+			if( sum < SCALE ) { freq[largest] += SCALE - sum; sum = SCALE; }
+			else { freq[largest] --; sum --; }
+		}
+	};
+};
+
+/*!
+ *	\brief CCodecState, the FIFOs of edges and vertices shared by the coder and the decoder
+ */
+class CCodecState
+{
+public:
+	enum { EDGES = 15, VERTICES = 14, ESCAPE = 15 };
+
+	CCodecState() : m_edge( 0 ), m_vertex( 0 )
+	{
+		for( int i = 0; i < 16; i ++ ) { m_edges[i][0] = m_edges[i][1] = m_edges[i][2] = -1; m_vertices[i] = -1; }
+	};
+
+	/*! the k-th last edge, a to b of a triangle of third vertex c */
+	const int * edge( int k ) const { return m_edges[( m_edge - 1 - k ) & 15]; };
+
+	/*! the k-th last vertex */
+	int vertex( int k ) const { return m_vertices[( m_vertex - 1 - k ) & 15]; };
+
+	void push_edge( int a, int b, int c )
+	{
+		int * e = m_edges[m_edge ++ & 15];
+		e[0] = a; e[1] = b; e[2] = c;
+	};
+
+	void push_vertex( int v ) { m_vertices[m_vertex ++ & 15] = v; };
+
+	/*! position of a vertex in the FIFO, -1 if it is not there */
+	int find_vertex( int v ) const
+	{
+		for( int k = 0; k < VERTICES; k ++ ) if( vertex( k ) == v ) return k;
+		return -1;
+	};
+
+	/*! push the edges of a face */
+	void push_face( const int * v, int d )
+	{
+		for( int k = 0; k < d; k ++ ) push_edge( v[k], v[( k + 1 ) % d], v[( k + d - 1 ) % d] );
+	};
+
+protected:
+	int      m_edges[16][3];
+	int      m_vertices[16];
+	unsigned m_edge;
+	unsigned m_vertex;
+};
+
+/*!
+ *	\brief CCodecWriter class, compresses a CCodecMesh into a .mc file
+ */
+class CCodecWriter
+{
+public:
+	/*!
+	 *	write a .mc file
+	 *	\param output the file name
+	 *	\param mesh the mesh, the indices have to be valid
+	 *	\param bits bits of the quantized coordinates, 1 to 30
+	 *	\return false if the file cannot be written
+	 */
+	bool write( const char * output, const CCodecMesh & mesh, int bits = 16 )
+	{
+		if( bits < 1 )  bits = 1;
+		if( bits > 30 ) bits = 30;
+
+		CCodecHeader header;
+		memset( &header, 0, sizeof( header ) );
+		memcpy( header.magic, "MESHCDC", 8 );
+		header.version  = MC_VERSION;
+		header.endian   = 0x01020304;
+		header.bits     = (uint32_t) bits;
+		header.vertices = mesh.vertices();
+		header.faces    = mesh.faces();
+		header.edges    = mesh.edge_traits.size();
+		header.corners  = mesh.corner_traits.size();
+
+		bool triangles = true;
+		for( size_t f = 0; f < mesh.faces(); f ++ ) if( mesh.offsets[f + 1] - mesh.offsets[f] != 3 ) triangles = false;
+		if( triangles ) header.flags |= MC_TRIANGLES;
+
+		_quantize( mesh, bits, header );
+		_faces( mesh, triangles );
+		_ids( mesh );
+		_traits( mesh, header );
+
+		FILE * fp = fopen( output, "wb" );
+		if( fp == NULL )
+		{
+			fprintf( stderr, "Error in opening file %s\n", output );
+			return false;
+		}
+		CCodecOutput coded[MC_STREAMS];
+#pragma omp parallel for
+		for( int s = 0; s < MC_STREAMS; s ++ ) CCodecEntropy::encode( m_streams[s].m_bytes, coded[s] );
+
+		for( int s = 0; s < MC_STREAMS; s ++ ) header.sizes[s] = coded[s].m_bytes.size();
+		bool ok = fwrite( &header, sizeof( header ), 1, fp ) == 1;
+		for( int s = 0; ok && s < MC_STREAMS; s ++ )
+		{
+			const std::vector<uint8_t> & bytes = coded[s].m_bytes;
+			if( !bytes.empty() ) ok = fwrite( &bytes[0], 1, bytes.size(), fp ) == bytes.size();
+		}
+		if( fclose( fp ) != 0 ) ok = false;
+		if( !ok ) fprintf( stderr, "Error in writing file %s\n", output );
+		return ok;
+	};
+
+protected:
+	/*! quantize the points */
+	void _quantize( const CCodecMesh & mesh, int bits, CCodecHeader & header )
+	{
+		size_t n = mesh.vertices();
+		double lower[3] = { 0, 0, 0 }, upper[3] = { 0, 0, 0 };
+		for( size_t i = 0; i < n; i ++ )
+		{
+			for( int k = 0; k < 3; k ++ )
+			{
+				double x = mesh.points[3 * i + k];
+				if( i == 0 || x < lower[k] ) lower[k] = x;
+				if( i == 0 || x > upper[k] ) upper[k] = x;
+			}
+		}
+		double levels = (double)( ( 1u << bits ) - 1 );
+		for( int k = 0; k < 3; k ++ )
+		{
+			header.origin[k] = lower[k];
+			header.step[k]   = ( upper[k] > lower[k] ) ? ( upper[k] - lower[k] ) / levels : 1.0;
+		}
+
+		m_q.resize( 3 * n );
+		for( size_t i = 0; i < n; i ++ )
+		{
+			for( int k = 0; k < 3; k ++ ) m_q[3 * i + k] = (int64_t) floor( ( mesh.points[3 * i + k] - lower[k] ) / header.step[k] + 0.5 );
+		}
+	};
+
+	/*! code a point from its prediction */
+	void _point( int v, const int64_t * prediction )
+	{
+		const int64_t * q = &m_q[3 * v];
+		for( int k = 0; k < 3; k ++ ) m_streams[MC_GEOMETRY].sint( q[k] - prediction[k] );
+		memcpy( m_last, q, sizeof( m_last ) );
+	};
+
+	/*! a new vertex, numbered next */
+	void _new_vertex( int v, const int64_t * prediction )
+	{
+		m_index[v] = (int) m_order.size();
+		m_order.push_back( v );
+		_point( v, prediction );
+	};
+
+	/*! the nibble of a vertex which does not come with an edge */
+	int _vertex( int v )
+	{
+		if( m_index[v] < 0 )
+		{
+			_new_vertex( v, m_last );
+			m_state.push_vertex( m_index[v] );
+			return 0;
+		}
+		int k = m_state.find_vertex( m_index[v] );
+		if( k >= 0 ) return 1 + k;
+		_explicit( m_index[v] );
+		return CCodecState::ESCAPE;
+	};
+
+	/*! a vertex coded by its index */
+	void _explicit( int index )
+	{
+		m_streams[MC_INDICES].sint( (int64_t) index - m_explicit );
+		m_explicit = index;
+		m_state.push_vertex( index );
+	};
+
+	/*! code the faces, the vertices are numbered on the way */
+	void _faces( const CCodecMesh & mesh, bool triangles )
+	{
+		size_t n = mesh.vertices();
+		m_index.assign( n, -1 );
+		m_order.clear();
+		m_order.reserve( n );
+		m_last[0] = m_last[1] = m_last[2] = 0;
+		m_explicit = 0;
+		m_state = CCodecState();
+
+		CCodecOutput & codes = m_streams[MC_CODES];
+		std::vector<int> face;
+		std::vector<int> nibbles;
+
+		for( size_t f = 0; f < mesh.faces(); f ++ )
+		{
+			const int * t = &mesh.indices[mesh.offsets[f]];
+			int d = mesh.offsets[f + 1] - mesh.offsets[f];
+			if( !triangles ) codes.uint( d );
+
+			if( d == 3 && _triangle( t ) ) continue;
+
+			// a face coded vertex by vertex
+			nibbles.resize( d + 1 );
+			face.resize( d );
+			for( int k = 0; k < d; k ++ )
+			{
+				nibbles[k] = _vertex( t[k] );
+				face[k] = m_index[t[k]];
+			}
+			if( d == 3 )
+			{
+				codes.byte( (uint8_t)( 0xF0 | nibbles[0] ) );
+				codes.byte( (uint8_t)( ( nibbles[1] << 4 ) | nibbles[2] ) );
+			}
+			else
+			{
+				nibbles[d] = 0;
+				for( int k = 0; k < d; k += 2 ) codes.byte( (uint8_t)( ( nibbles[k] << 4 ) | nibbles[k + 1] ) );
+			}
+			m_state.push_face( &face[0], d );
+		}
+
+		// the vertices used by no face
+		for( size_t v = 0; v < n; v ++ )
+		{
+			if( m_index[v] < 0 ) _new_vertex( (int) v, m_last );
+		}
+	};
+
+	/*! code a triangle across an edge of the FIFO, false if it has none */
+	bool _triangle( const int * t )
+	{
+		for( int e = 0; e < CCodecState::EDGES; e ++ )
+		{
+			const int * edge = m_state.edge( e );
+			if( edge[0] < 0 ) break;
+			for( int r = 0; r < 3; r ++ )
+			{
+				int a = m_index[t[r]], b = m_index[t[( r + 1 ) % 3]];
+				if( a != edge[1] || b != edge[0] || a < 0 ) continue;
+
+				int c = t[( r + 2 ) % 3];
+				int nibble;
+				if( m_index[c] < 0 )
+				{
+					// the parallelogram prediction
+					const int64_t * qa = &m_q[3 * m_order[a]];
+					const int64_t * qb = &m_q[3 * m_order[b]];
+					const int64_t * qd = &m_q[3 * m_order[edge[2]]];
+					int64_t prediction[3];
+					for( int k = 0; k < 3; k ++ ) prediction[k] = qa[k] + qb[k] - qd[k];
+					_new_vertex( c, prediction );
+					m_state.push_vertex( m_index[c] );
+					nibble = 0;
+				}
+				else
+				{
+					int k = m_state.find_vertex( m_index[c] );
+					if( k >= 0 ) nibble = 1 + k;
+					else
+					{
+						_explicit( m_index[c] );
+						nibble = CCodecState::ESCAPE;
+					}
+				}
+				m_streams[MC_CODES].byte( (uint8_t)( ( e << 4 ) | nibble ) );
+
+				int face[3] = { a, b, m_index[c] };
+				m_state.push_face( face, 3 );
+				return true;
+			}
+		}
+		return false;
+	};
+
+	/*! runs of consecutive ids */
+	static void _runs( CCodecOutput & out, const std::vector<int> & ids, const std::vector<int> * order )
+	{
+		size_t n = ids.size();
+		int64_t previous = 0;
+		for( size_t i = 0; i < n; )
+		{
+			int64_t id = ids[order ? ( *order )[i] : i];
+			size_t run = 1;
+			while( i + run < n && (int64_t) ids[order ? ( *order )[i + run] : i + run] == id + (int64_t) run ) run ++;
+			out.sint( id - previous );
+			out.uint( run );
+			previous = id + (int64_t) run - 1;
+			i += run;
+		}
+	};
+
+	void _ids( const CCodecMesh & mesh )
+	{
+		_runs( m_streams[MC_IDS], mesh.vertex_ids, &m_order );
+		_runs( m_streams[MC_IDS], mesh.face_ids, NULL );
+	};
+
+	static bool _any( const std::vector<std::string> & traits )
+	{
+		for( size_t i = 0; i < traits.size(); i ++ ) if( !traits[i].empty() ) return true;
+		return false;
+	};
+
+	void _traits( const CCodecMesh & mesh, CCodecHeader & header )
+	{
+		CCodecOutput & out = m_streams[MC_TRAITS];
+		if( mesh.vertex_traits.size() == mesh.vertices() && _any( mesh.vertex_traits ) )
+		{
+			header.flags |= MC_VERTEX_TRAITS;
+			for( size_t i = 0; i < m_order.size(); i ++ ) out.text( mesh.vertex_traits[m_order[i]] );
+		}
+		if( mesh.face_traits.size() == mesh.faces() && _any( mesh.face_traits ) )
+		{
+			header.flags |= MC_FACE_TRAITS;
+			for( size_t i = 0; i < mesh.faces(); i ++ ) out.text( mesh.face_traits[i] );
+		}
+		for( size_t i = 0; i < mesh.edge_traits.size(); i ++ )
+		{
+			out.uint( m_index[mesh.edges[2 * i]] );
+			out.uint( m_index[mesh.edges[2 * i + 1]] );
+			out.text( mesh.edge_traits[i] );
+		}
+		for( size_t i = 0; i < mesh.corner_traits.size(); i ++ )
+		{
+			out.uint( m_index[mesh.corners[2 * i]] );
+			out.uint( mesh.corners[2 * i + 1] );
+			out.text( mesh.corner_traits[i] );
+		}
+	};
+
+	CCodecOutput         m_streams[MC_STREAMS];
+	CCodecState          m_state;
+	/*! quantized points */
+	std::vector<int64_t> m_q;
+	/*! coded number of each vertex, -1 before its first face */
+	std::vector<int>     m_index;
+	/*! the vertices in the coded order */
+	std::vector<int>     m_order;
+	/*! last coded point */
+	int64_t              m_last[3];
+	/*! last explicit vertex */
+	int                  m_explicit;
+};
+
+/*!
+ *	\brief CCodecReader class, decompresses a .mc file into a CCodecMesh in one pass
+ */
+class CCodecReader
+{
+public:
+	/*!
+	 *	read a .mc file
+	 *	\param input the file name
+	 *	\param mesh the mesh, the vertices in their coded order
+	 *	\return false if the file cannot be read
+	 */
+	bool read( const char * input, CCodecMesh & mesh )
+	{
+		mesh.clear();
+		CMappedFile file;
+		if( !file.open( input ) )
+		{
+			fprintf( stderr, "Error in opening file %s\n", input );
+			return false;
+		}
+		if( !_open( file ) || !_decode( mesh ) )
+		{
+			fprintf( stderr, "Error in reading file %s, not a valid version %d .mc file\n", input, MC_VERSION );
+			mesh.clear();
+			return false;
+		}
+		return true;
+	};
+
+protected:
+	bool _open( const CMappedFile & file )
+	{
+		if( file.size() < sizeof( CCodecHeader ) ) return false;
+		memcpy( &m_header, file.begin(), sizeof( CCodecHeader ) );
+		if( memcmp( m_header.magic, "MESHCDC", 8 ) != 0 || m_header.version != MC_VERSION || m_header.endian != 0x01020304 ) return false;
+		if( m_header.bits < 1 || m_header.bits > 30 ) return false;
+		if( m_header.vertices > 0x7FFFFFFF || m_header.faces > 0x7FFFFFFF ) return false;
+
+		const uint8_t * begin[MC_STREAMS + 1];
+		begin[0] = (const uint8_t*) file.begin() + sizeof( CCodecHeader );
+		const uint8_t * end = (const uint8_t*) file.end();
+		for( int s = 0; s < MC_STREAMS; s ++ )
+		{
+			if( m_header.sizes[s] > (uint64_t)( end - begin[s] ) ) return false;
+			begin[s + 1] = begin[s] + m_header.sizes[s];
+		}
+
+		// a byte costs at least 1/4096 of a bit
+		size_t limit = ( file.size() + 1024 ) << 15;
+		bool valid[MC_STREAMS];
+#pragma omp parallel for
+		for( int s = 0; s < MC_STREAMS; s ++ ) valid[s] = CCodecEntropy::decode( begin[s], begin[s + 1], limit, m_bytes[s] );
+
+		for( int s = 0; s < MC_STREAMS; s ++ )
+		{
+			if( !valid[s] ) return false;
+			const uint8_t * p = m_bytes[s].empty() ? NULL : &m_bytes[s][0];
+			m_streams[s] = CCodecInput( p, p + m_bytes[s].size() );
+		}
+		// every vertex and face takes at least a byte
+		return m_header.vertices <= m_bytes[MC_GEOMETRY].size() && m_header.faces <= m_bytes[MC_CODES].size();
+	};
+
+	/*! decode a point from its prediction */
+	void _point( const int64_t * prediction )
+	{
+		for( int k = 0; k < 3; k ++ ) m_last[k] = prediction[k] + m_streams[MC_GEOMETRY].sint();
+		m_q.insert( m_q.end(), m_last, m_last + 3 );
+	};
+
+	/*! the vertex of a nibble which does not come with an edge, -1 if it is not valid */
+	int _vertex( int nibble )
+	{
+		int v;
+		if( nibble == 0 )
+		{
+			v = (int)( m_q.size() / 3 );
+			if( (uint64_t) v >= m_header.vertices ) return -1;
+			_point( m_last );
+		}
+		else if( nibble == CCodecState::ESCAPE )
+		{
+			int64_t index = m_explicit + m_streams[MC_INDICES].sint();
+			if( index < 0 || index >= (int64_t)( m_q.size() / 3 ) ) return -1;
+			v = m_explicit = (int) index;
+		}
+		else
+		{
+			v = m_state.vertex( nibble - 1 );
+			return v;
+		}
+		m_state.push_vertex( v );
+		return v;
+	};
+
+	bool _decode( CCodecMesh & mesh )
+	{
+		size_t nv = (size_t) m_header.vertices;
+		size_t nf = (size_t) m_header.faces;
+		bool triangles = ( m_header.flags & MC_TRIANGLES ) != 0;
+
+		m_q.clear();
+		m_q.reserve( 3 * nv );
+		m_last[0] = m_last[1] = m_last[2] = 0;
+		m_explicit = 0;
+		m_state = CCodecState();
+
+		mesh.offsets.reserve( nf + 1 );
+		mesh.indices.reserve( 3 * nf );
+
+		CCodecInput & codes = m_streams[MC_CODES];
+		std::vector<int> face;
+		for( size_t f = 0; f < nf; f ++ )
+		{
+			uint64_t d = triangles ? 3 : codes.uint();
+			if( d < 3 || d > nv ) return false;
+
+			face.resize( (size_t) d );
+			uint8_t byte = codes.byte();
+			if( d == 3 && ( byte >> 4 ) != 0xF )
+			{
+				const int * edge = m_state.edge( byte >> 4 );
+				if( edge[0] < 0 ) return false;
+				face[0] = edge[1];
+				face[1] = edge[0];
+
+				int nibble = byte & 15;
+				if( nibble == 0 )
+				{
+					face[2] = (int)( m_q.size() / 3 );
+					if( (uint64_t) face[2] >= nv ) return false;
+					int64_t prediction[3];
+					for( int k = 0; k < 3; k ++ ) prediction[k] = m_q[3 * face[0] + k] + m_q[3 * face[1] + k] - m_q[3 * edge[2] + k];
+					_point( prediction );
+					m_state.push_vertex( face[2] );
+				}
+				else
+				{
+					face[2] = _vertex( nibble );
+				}
+			}
+			else if( d == 3 )
+			{
+				face[0] = _vertex( byte & 15 );
+				byte = codes.byte();
+				face[1] = _vertex( byte >> 4 );
+				face[2] = _vertex( byte & 15 );
+			}
+			else
+			{
+				for( size_t k = 0; k < d; k += 2 )
+				{
+					if( k > 0 ) byte = codes.byte();
+					face[k] = _vertex( byte >> 4 );
+					if( k + 1 < d ) face[k + 1] = _vertex( byte & 15 );
+				}
+			}
+
+			for( size_t k = 0; k < d; k ++ )
+			{
+				if( face[k] < 0 ) return false;
+				mesh.indices.push_back( face[k] );
+			}
+			mesh.offsets.push_back( (int) mesh.indices.size() );
+			m_state.push_face( &face[0], (int) d );
+			if( !codes.good() || !m_streams[MC_INDICES].good() || !m_streams[MC_GEOMETRY].good() ) return false;
+		}
+
+		// the vertices used by no face
+		while( m_q.size() < 3 * nv ) _point( m_last );
+		if( !m_streams[MC_GEOMETRY].good() ) return false;
+
+		mesh.points.resize( 3 * nv );
+		for( size_t i = 0; i < nv; i ++ )
+		{
+			for( int k = 0; k < 3; k ++ ) mesh.points[3 * i + k] = m_header.origin[k] + (double) m_q[3 * i + k] * m_header.step[k];
+		}
+
+		return _ids( mesh.vertex_ids, nv ) && _ids( mesh.face_ids, nf ) && _traits( mesh );
+	};
+
+	bool _ids( std::vector<int> & ids, size_t n )
+	{
+		CCodecInput & in = m_streams[MC_IDS];
+		ids.reserve( n );
+		int64_t previous = 0;
+		while( ids.size() < n )
+		{
+			int64_t  id  = previous + in.sint();
+			uint64_t run = in.uint();
+			if( !in.good() || run == 0 || run > n - ids.size() ) return false;
+			for( uint64_t k = 0; k < run; k ++ ) ids.push_back( (int)( id + (int64_t) k ) );
+			previous = id + (int64_t) run - 1;
+		}
+		return true;
+	};
+
+	bool _traits( CCodecMesh & mesh )
+	{
+		CCodecInput & in = m_streams[MC_TRAITS];
+		if( m_header.flags & MC_VERTEX_TRAITS )
+		{
+			mesh.vertex_traits.resize( mesh.vertices() );
+			for( size_t i = 0; i < mesh.vertices(); i ++ ) in.text( mesh.vertex_traits[i] );
+		}
+		if( m_header.flags & MC_FACE_TRAITS )
+		{
+			mesh.face_traits.resize( mesh.faces() );
+			for( size_t i = 0; i < mesh.faces(); i ++ ) in.text( mesh.face_traits[i] );
+		}
+		for( uint64_t i = 0; i < m_header.edges && in.good(); i ++ )
+		{
+			uint64_t v0 = in.uint(), v1 = in.uint();
+			if( v0 >= mesh.vertices() || v1 >= mesh.vertices() ) return false;
+			mesh.edges.push_back( (int) v0 );
+			mesh.edges.push_back( (int) v1 );
+			mesh.edge_traits.push_back( std::string() );
+			in.text( mesh.edge_traits.back() );
+		}
+		for( uint64_t i = 0; i < m_header.corners && in.good(); i ++ )
+		{
+			uint64_t v = in.uint(), f = in.uint();
+			if( v >= mesh.vertices() || f >= mesh.faces() ) return false;
+			mesh.corners.push_back( (int) v );
+			mesh.corners.push_back( (int) f );
+			mesh.corner_traits.push_back( std::string() );
+			in.text( mesh.corner_traits.back() );
+		}
+		return in.good();
+	};
+
+	CCodecHeader         m_header;
+	/*! the decoded streams */
+	std::vector<uint8_t> m_bytes[MC_STREAMS];
+	CCodecInput          m_streams[MC_STREAMS];
+	CCodecState          m_state;
+	/*! quantized points decoded so far */
+	std::vector<int64_t> m_q;
+	/*! last decoded point */
+	int64_t              m_last[3];
+	/*! last explicit vertex */
+	int                  m_explicit;
+};
+
+}
+#endif
@@ -0,0 +1,560 @@
+/*!
+*      \file ply.h
+*      \brief Reading and writing of .ply files, ascii and binary
+*
+*/
+
+#ifndef _MESHLIB_PLY_H_
+#define _MESHLIB_PLY_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "scanner.h"
+#include "writer.h"
+
+namespace MeshLib
+{
+
+/*!
+ *	\brief CPlyMesh, the vertices and the faces of a .ply file in arrays
+ *
+ *	The arrays of the optional properties are empty when the file has not
+ *	got them. The corners of the face i are indices[offsets[i]] to
+ *	indices[offsets[i+1]-1], vertex indices counted from 0.
+ */
+struct CPlyMesh
+{
+	CPlyMesh() : offsets( 1, 0 ) {};
+
+	/*! number of vertices */
+	size_t vertices() const { return points.size() / 3; };
+	/*! number of faces */
+	size_t faces()    const { return offsets.size() - 1; };
+
+	void clear()
+	{
+		points.clear();
+		normals.clear();
+		uvs.clear();
+		rgbs.clear();
+		offsets.assign( 1, 0 );
+		indices.clear();
+	};
+
+	/*! x y z */
+	std::vector<double> points;
+	/*! nx ny nz */
+	std::vector<double> normals;
+	/*! u v */
+	std::vector<double> uvs;
+	/*! red green blue, in [0, 1] */
+	std::vector<double> rgbs;
+	std::vector<int>    offsets;
+	std::vector<int>    indices;
+};
+
+/*!
+ *	\brief CPlyReader class, reads a .ply file into a CPlyMesh
+ *
+ *	The file is mapped, the body, ascii, binary little or big endian, is
+ *	decoded directly into the arrays, allocated once from the counts of the
+ *	header. The vertex properties x y z, nx ny nz, u v (or s t, texture_u
+ *	texture_v) and red green blue, and the face list vertex_indices (or
+ *	vertex_index) are read, the other properties and elements are skipped.
+ */
+class CPlyReader
+{
+public:
+	/*!
+	 *	read a .ply file
+	 *	\param input the file name
+	 *	\param mesh the vertices and faces
+	 *	\return false if the file cannot be read
+	 */
+	bool read( const char * input, CPlyMesh & mesh )
+	{
+		mesh.clear();
+		CMappedFile file;
+		if( !file.open( input ) )
+		{
+			fprintf( stderr, "Error in opening file %s\n", input );
+			return false;
+		}
+		const char * body = _header( file.begin(), file.end() );
+		if( body == NULL )
+		{
+			fprintf( stderr, "Error in reading file %s, invalid .ply header\n", input );
+			return false;
+		}
+		_allocate( mesh );
+
+		bool ok = ( m_format == PLY_ASCII ) ? _read_ascii( body, file.end(), mesh ) : _read_binary( body, file.end(), mesh );
+		for( size_t i = 0; ok && i < mesh.indices.size(); i ++ )
+		{
+			ok = mesh.indices[i] >= 0 && (size_t) mesh.indices[i] < mesh.vertices();
+		}
+		if( !ok )
+		{
+			fprintf( stderr, "Error in reading file %s, invalid .ply body\n", input );
+			mesh.clear();
+		}
+		return ok;
+	};
+
+protected:
+	enum { PLY_ASCII, PLY_LITTLE_ENDIAN, PLY_BIG_ENDIAN };
+	enum { PLY_CHAR, PLY_UCHAR, PLY_SHORT, PLY_USHORT, PLY_INT, PLY_UINT, PLY_FLOAT, PLY_DOUBLE, PLY_NONE };
+	enum { ELEMENT_VERTEX, ELEMENT_FACE, ELEMENT_OTHER };
+	/*! where a property is stored */
+	enum { SKIP, X, Y, Z, NX, NY, NZ, U, V, RED, GREEN, BLUE, INDICES };
+
+	struct CProperty
+	{
+		/*! type of the values */
+		int type;
+		/*! type of the count of a list, PLY_NONE for a scalar */
+		int count;
+		int target;
+	};
+
+	struct CElement
+	{
+		int                    kind;
+		size_t                 count;
+		std::vector<CProperty> properties;
+	};
+
+	static int _type( const char * w, size_t n )
+	{
+		static const char * names[] = { "char", "uchar", "short", "ushort", "int", "uint", "float", "double",
+										"int8", "uint8", "int16", "uint16", "int32", "uint32", "float32", "float64" };
+		for( int i = 0; i < 16; i ++ )
+		{
+			if( strlen( names[i] ) == n && memcmp( names[i], w, n ) == 0 ) return i % 8;
+		}
+		return PLY_NONE;
+	};
+
+	static size_t _size( int type )
+	{
+		static const size_t sizes[] = { 1, 1, 2, 2, 4, 4, 4, 8 };
+		return sizes[type];
+	};
+
+	static bool _is( const char * w, size_t n, const char * name )
+	{
+		return strlen( name ) == n && memcmp( name, w, n ) == 0;
+	};
+
+	static int _target( int kind, const char * w, size_t n )
+	{
+		if( kind == ELEMENT_FACE )
+		{
+			return ( _is( w, n, "vertex_indices" ) || _is( w, n, "vertex_index" ) ) ? INDICES : SKIP;
+		}
+		if( kind != ELEMENT_VERTEX ) return SKIP;
+
+		static const char * names[] = { "x", "y", "z", "nx", "ny", "nz", "u", "v", "red", "green", "blue",
+										"s", "t", "texture_u", "texture_v", "diffuse_red", "diffuse_green", "diffuse_blue" };
+		static const int targets[]  = { X, Y, Z, NX, NY, NZ, U, V, RED, GREEN, BLUE,
+										U, V, U, V, RED, GREEN, BLUE };
+		for( int i = 0; i < 18; i ++ )
+		{
+			if( _is( w, n, names[i] ) ) return targets[i];
+		}
+		return SKIP;
+	};
+
+	/*!
+	 *	read the header
+	 *	\return the first byte of the body, NULL if the header is not valid
+	 */
+	const char * _header( const char * begin, const char * end )
+	{
+		m_elements.clear();
+		m_format = -1;
+
+		bool first = true;
+		for( const char * line = begin; line < end; )
+		{
+			const char * eol  = (const char*) memchr( line, '\n', end - line );
+			const char * next = ( eol == NULL ) ? end : eol + 1;
+			CScanner scanner( line, ( eol == NULL ) ? end : eol );
+			line = next;
+
+			const char * w;
+			size_t n;
+			if( !scanner.word( w, n ) )
+			{
+				if( first ) return NULL;
+				continue;
+			}
+			if( first )
+			{
+				if( !_is( w, n, "ply" ) ) return NULL;
+				first = false;
+				continue;
+			}
+
+			if( _is( w, n, "format" ) )
+			{
+				if( !scanner.word( w, n ) ) return NULL;
+				if( _is( w, n, "ascii" ) )                     m_format = PLY_ASCII;
+				else if( _is( w, n, "binary_little_endian" ) ) m_format = PLY_LITTLE_ENDIAN;
+				else if( _is( w, n, "binary_big_endian" ) )    m_format = PLY_BIG_ENDIAN;
+				else return NULL;
+				continue;
+			}
+
+			if( _is( w, n, "element" ) )
+			{
+				int count = 0;
+				if( !scanner.word( w, n ) || !scanner.parse_int( count ) || count < 0 ) return NULL;
+				CElement element;
+				element.kind  = _is( w, n, "vertex" ) ? ELEMENT_VERTEX : ( _is( w, n, "face" ) ? ELEMENT_FACE : ELEMENT_OTHER );
+				element.count = (size_t) count;
+				m_elements.push_back( element );
+				continue;
+			}
+
+			if( _is( w, n, "property" ) )
+			{
+				if( m_elements.empty() || !scanner.word( w, n ) ) return NULL;
+				CProperty property;
+				property.count = PLY_NONE;
+				if( _is( w, n, "list" ) )
+				{
+					if( !scanner.word( w, n ) ) return NULL;
+					property.count = _type( w, n );
+					if( property.count == PLY_NONE || !scanner.word( w, n ) ) return NULL;
+				}
+				property.type = _type( w, n );
+				if( property.type == PLY_NONE || !scanner.word( w, n ) ) return NULL;
+
+				CElement & element = m_elements.back();
+				property.target = _target( element.kind, w, n );
+				// the indices are a list, the vertex properties are scalars
+				if( ( property.target == INDICES ) != ( property.count != PLY_NONE ) ) property.target = SKIP;
+				element.properties.push_back( property );
+				continue;
+			}
+
+			if( _is( w, n, "end_header" ) ) return ( m_format < 0 ) ? NULL : next;
+			// comment, obj_info
+		}
+		return NULL;
+	};
+
+	/*! allocate the arrays of the vertex properties */
+	void _allocate( CPlyMesh & mesh )
+	{
+		for( size_t e = 0; e < m_elements.size(); e ++ )
+		{
+			const CElement & element = m_elements[e];
+			if( element.kind == ELEMENT_VERTEX )
+			{
+				size_t n = element.count;
+				mesh.points.assign( 3 * n, 0.0 );
+				for( size_t i = 0; i < element.properties.size(); i ++ )
+				{
+					int t = element.properties[i].target;
+					if( t >= NX && t <= NZ )      mesh.normals.assign( 3 * n, 0.0 );
+					if( t >= U && t <= V )        mesh.uvs.assign( 2 * n, 0.0 );
+					if( t >= RED && t <= BLUE )   mesh.rgbs.assign( 3 * n, 0.0 );
+				}
+			}
+			if( element.kind == ELEMENT_FACE )
+			{
+				mesh.offsets.reserve( element.count + 1 );
+				mesh.indices.reserve( 3 * element.count );
+			}
+		}
+	};
+
+	/*! store the value of a vertex property */
+	static void _store( CPlyMesh & mesh, size_t i, const CProperty & property, double value )
+	{
+		switch( property.target )
+		{
+		case X: case Y: case Z:
+			mesh.points[3 * i + property.target - X] = value;
+			break;
+		case NX: case NY: case NZ:
+			mesh.normals[3 * i + property.target - NX] = value;
+			break;
+		case U: case V:
+			mesh.uvs[2 * i + property.target - U] = value;
+			break;
+		case RED: case GREEN: case BLUE:
+			// the integer colors are in [0, 255]
+			if( property.type != PLY_FLOAT && property.type != PLY_DOUBLE ) value /= 255.0;
+			mesh.rgbs[3 * i + property.target - RED] = value;
+			break;
+		}
+	};
+
+	/*! decode a binary value */
+	static double _value( const char * p, int type, bool swap )
+	{
+		unsigned char b[8];
+		size_t s = _size( type );
+		if( swap ) { for( size_t i = 0; i < s; i ++ ) b[i] = (unsigned char) p[s - 1 - i]; }
+		else       memcpy( b, p, s );
+
+		switch( type )
+		{
+		case PLY_CHAR:   { int8_t   x; memcpy( &x, b, 1 ); return x; }
+		case PLY_UCHAR:  { uint8_t  x; memcpy( &x, b, 1 ); return x; }
+		case PLY_SHORT:  { int16_t  x; memcpy( &x, b, 2 ); return x; }
+		case PLY_USHORT: { uint16_t x; memcpy( &x, b, 2 ); return x; }
+		case PLY_INT:    { int32_t  x; memcpy( &x, b, 4 ); return x; }
+		case PLY_UINT:   { uint32_t x; memcpy( &x, b, 4 ); return x; }
+		case PLY_FLOAT:  { float    x; memcpy( &x, b, 4 ); return x; }
+		default:         { double   x; memcpy( &x, b, 8 ); return x; }
+		}
+	};
+
+	bool _read_binary( const char * p, const char * end, CPlyMesh & mesh )
+	{
+		uint16_t one = 1;
+		bool little = ( *(const char*) &one == 1 );
+		bool swap = ( m_format == PLY_LITTLE_ENDIAN ) != little;
+
+		for( size_t e = 0; e < m_elements.size(); e ++ )
+		{
+			const CElement & element = m_elements[e];
+			const std::vector<CProperty> & properties = element.properties;
+
+			for( size_t i = 0; i < element.count; i ++ )
+			{
+				for( size_t k = 0; k < properties.size(); k ++ )
+				{
+					const CProperty & property = properties[k];
+					size_t s = _size( property.type );
+					if( property.count == PLY_NONE )
+					{
+						if( (size_t)( end - p ) < s ) return false;
+						if( property.target != SKIP ) _store( mesh, i, property, _value( p, property.type, swap ) );
+						p += s;
+						continue;
+					}
+
+					size_t c = _size( property.count );
+					if( (size_t)( end - p ) < c ) return false;
+					double count = _value( p, property.count, swap );
+					p += c;
+					if( count < 0 || count > (double)( end - p ) / s ) return false;
+					size_t n = (size_t) count;
+					if( property.target == INDICES )
+					{
+						if( n < 3 ) return false;
+						for( size_t j = 0; j < n; j ++ )
+						{
+							// the indices out of range are rejected with the invalid ones
+							double index = _value( p + j * s, property.type, swap );
+							mesh.indices.push_back( ( index >= 0 && index < 2147483647.0 ) ? (int) index : -1 );
+						}
+						mesh.offsets.push_back( (int) mesh.indices.size() );
+					}
+					p += n * s;
+				}
+			}
+		}
+		return true;
+	};
+
+	bool _read_ascii( const char * p, const char * end, CPlyMesh & mesh )
+	{
+		CScanner scanner( p, end );
+		for( size_t e = 0; e < m_elements.size(); e ++ )
+		{
+			const CElement & element = m_elements[e];
+			const std::vector<CProperty> & properties = element.properties;
+
+			for( size_t i = 0; i < element.count; i ++ )
+			{
+				// skip the empty lines
+				while( !scanner.end() && scanner.end_of_line() ) scanner.next_line();
+				if( scanner.end() ) return false;
+
+				for( size_t k = 0; k < properties.size(); k ++ )
+				{
+					const CProperty & property = properties[k];
+					if( property.count == PLY_NONE )
+					{
+						float x = 0;
+						if( !scanner.parse_float( x ) ) return false;
+						if( property.target != SKIP ) _store( mesh, i, property, x );
+						continue;
+					}
+
+					int n = 0;
+					if( !scanner.parse_int( n ) || n < 0 ) return false;
+					if( property.target != INDICES )
+					{
+						for( int j = 0; j < n; j ++ )
+						{
+							float x;
+							if( !scanner.parse_float( x ) ) return false;
+						}
+						continue;
+					}
+					if( n < 3 ) return false;
+					for( int j = 0; j < n; j ++ )
+					{
+						int index = 0;
+						if( !scanner.parse_int( index ) ) return false;
+						mesh.indices.push_back( index );
+					}
+					mesh.offsets.push_back( (int) mesh.indices.size() );
+				}
+				scanner.next_line();
+			}
+		}
+		return true;
+	};
+
+	/*! ascii, little or big endian */
+	int                   m_format;
+	std::vector<CElement> m_elements;
+};
+
+/*!
+ *	\brief CPlyWriter class, writes a CPlyMesh to a .ply file
+ *
+ *	The points, normals and uvs are written as doubles, the colors as uchar
+ *	red green blue, the faces as a list vertex_indices.
+ */
+class CPlyWriter
+{
+public:
+	/*!
+	 *	write a .ply file
+	 *	\param output the file name
+	 *	\param mesh the vertices and faces
+	 *	\param binary binary little endian, or ascii
+	 *	\return false if the file cannot be written
+	 */
+	static bool write( const char * output, const CPlyMesh & mesh, bool binary )
+	{
+		int degree = 0;
+		for( size_t i = 0; i < mesh.faces(); i ++ )
+		{
+			int d = mesh.offsets[i + 1] - mesh.offsets[i];
+			if( d > degree ) degree = d;
+		}
+		bool small = ( degree < 256 );
+
+		CTextBuffer header;
+		header << "ply\n";
+		header << "format " << ( binary ? "binary_little_endian" : "ascii" ) << " 1.0\n";
+		header << "element vertex " << mesh.vertices() << '\n';
+		header << "property double x\nproperty double y\nproperty double z\n";
+		if( !mesh.normals.empty() ) header << "property double nx\nproperty double ny\nproperty double nz\n";
+		if( !mesh.uvs.empty() )     header << "property double u\nproperty double v\n";
+		if( !mesh.rgbs.empty() )    header << "property uchar red\nproperty uchar green\nproperty uchar blue\n";
+		header << "element face " << mesh.faces() << '\n';
+		header << "property list " << ( small ? "uchar" : "int" ) << " int vertex_indices\n";
+		header << "end_header\n";
+
+		bool ok = binary ? _write_binary( output, header, mesh, small ) : _write_ascii( output, header, mesh );
+		if( !ok ) fprintf( stderr, "Error in writing file %s\n", output );
+		return ok;
+	};
+
+protected:
+	static unsigned char _color( double c )
+	{
+		c = c * 255.0 + 0.5;
+		return (unsigned char)( ( c < 0 ) ? 0 : ( c > 255 ? 255 : c ) );
+	};
+
+	static bool _write_ascii( const char * output, const CTextBuffer & header, const CPlyMesh & mesh )
+	{
+		CTextFile file;
+		if( !file.open( output ) ) return false;
+		file.write( header );
+
+		file.rows( mesh.vertices(), [&]( size_t i, CTextBuffer & os )
+		{
+			os << mesh.points[3 * i] << ' ' << mesh.points[3 * i + 1] << ' ' << mesh.points[3 * i + 2];
+			if( !mesh.normals.empty() ) os << ' ' << mesh.normals[3 * i] << ' ' << mesh.normals[3 * i + 1] << ' ' << mesh.normals[3 * i + 2];
+			if( !mesh.uvs.empty() )     os << ' ' << mesh.uvs[2 * i] << ' ' << mesh.uvs[2 * i + 1];
+			if( !mesh.rgbs.empty() )
+			{
+				for( int k = 0; k < 3; k ++ ) os << ' ' << (int) _color( mesh.rgbs[3 * i + k] );
+			}
+			os << '\n';
+		} );
+
+		file.rows( mesh.faces(), [&]( size_t i, CTextBuffer & os )
+		{
+			os << mesh.offsets[i + 1] - mesh.offsets[i];
+			for( int j = mesh.offsets[i]; j < mesh.offsets[i + 1]; j ++ ) os << ' ' << mesh.indices[j];
+			os << '\n';
+		} );
+
+		return file.close();
+	};
+
+	/*! append a value, little endian */
+	template<typename T>
+	static void _put( std::vector<char> & buffer, T value )
+	{
+		char b[sizeof( T )];
+		memcpy( b, &value, sizeof( T ) );
+		uint16_t one = 1;
+		if( *(const char*) &one != 1 )
+		{
+			for( size_t i = 0; i < sizeof( T ) / 2; i ++ ) { char c = b[i]; b[i] = b[sizeof( T ) - 1 - i]; b[sizeof( T ) - 1 - i] = c; }
+		}
+		buffer.insert( buffer.end(), b, b + sizeof( T ) );
+	};
+
+	static bool _flush( FILE * fp, std::vector<char> & buffer, size_t at_least )
+	{
+		if( buffer.size() < at_least || buffer.empty() ) return true;
+		bool ok = fwrite( &buffer[0], 1, buffer.size(), fp ) == buffer.size();
+		buffer.clear();
+		return ok;
+	};
+
+	static bool _write_binary( const char * output, const CTextBuffer & header, const CPlyMesh & mesh, bool small )
+	{
+		FILE * fp = fopen( output, "wb" );
+		if( fp == NULL ) return false;
+
+		bool ok = fwrite( header.data(), 1, header.size(), fp ) == header.size();
+		std::vector<char> buffer;
+		buffer.reserve( 1 << 20 );
+
+		for( size_t i = 0; ok && i < mesh.vertices(); i ++ )
+		{
+			for( int k = 0; k < 3; k ++ ) _put( buffer, mesh.points[3 * i + k] );
+			if( !mesh.normals.empty() ) { for( int k = 0; k < 3; k ++ ) _put( buffer, mesh.normals[3 * i + k] ); }
+			if( !mesh.uvs.empty() )     { for( int k = 0; k < 2; k ++ ) _put( buffer, mesh.uvs[2 * i + k] ); }
+			if( !mesh.rgbs.empty() )    { for( int k = 0; k < 3; k ++ ) _put( buffer, _color( mesh.rgbs[3 * i + k] ) ); }
+			ok = _flush( fp, buffer, 1 << 20 );
+		}
+
+		for( size_t i = 0; ok && i < mesh.faces(); i ++ )
+		{
+			int d = mesh.offsets[i + 1] - mesh.offsets[i];
+			if( small ) _put( buffer, (uint8_t) d );
+			else        _put( buffer, (int32_t) d );
+			for( int j = mesh.offsets[i]; j < mesh.offsets[i + 1]; j ++ ) _put( buffer, (int32_t) mesh.indices[j] );
+			ok = _flush( fp, buffer, 1 << 20 );
+		}
+
+		if( ok ) ok = _flush( fp, buffer, 0 );
+		if( fclose( fp ) != 0 ) ok = false;
+		return ok;
+	};
+};
+
+}
+#endif
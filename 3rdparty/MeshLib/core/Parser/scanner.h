@@ -0,0 +1,317 @@
+/*!
+*      \file scanner.h
+*      \brief Memory mapped input and scanning of the mesh files
+*
+*/
+
+#ifndef _MESHLIB_SCANNER_H_
+#define _MESHLIB_SCANNER_H_
+
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#if ( defined(_MSVC_LANG) && _MSVC_LANG >= 201703L ) || __cplusplus >= 201703L
+#include <charconv>
+#endif
+
+namespace MeshLib
+{
+
+/*!
+ *	\brief CMappedFile class, a whole file mapped read only into memory
+ */
+class CMappedFile
+{
+public:
+	CMappedFile() : m_data( NULL ), m_size( 0 )
+#if defined(_WIN32)
+		, m_file( INVALID_HANDLE_VALUE ), m_mapping( NULL )
+#endif
+	{};
+	~CMappedFile() { close(); };
+
+	/*!
+	 *	map a file
+	 *	\param name the file name
+	 *	\return whether the file has been opened, an empty file is mapped to nothing
+	 */
+	bool open( const char * name )
+	{
+		close();
+#if defined(_WIN32)
+		m_file = CreateFileA( name, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL );
+		if( m_file == INVALID_HANDLE_VALUE ) return false;
+		LARGE_INTEGER size;
+		if( !GetFileSizeEx( m_file, &size ) ) { close(); return false; }
+		m_size = (size_t) size.QuadPart;
+		if( m_size == 0 ) return true;
+		m_mapping = CreateFileMappingA( m_file, NULL, PAGE_READONLY, 0, 0, NULL );
+		if( m_mapping == NULL ) { close(); return false; }
+		m_data = (const char*) MapViewOfFile( m_mapping, FILE_MAP_READ, 0, 0, 0 );
+		if( m_data == NULL ) { close(); return false; }
+#else
+		int fd = ::open( name, O_RDONLY );
+		if( fd < 0 ) return false;
+		struct stat st;
+		if( fstat( fd, &st ) != 0 || !S_ISREG( st.st_mode ) ) { ::close( fd ); return false; }
+		m_size = (size_t) st.st_size;
+		if( m_size > 0 )
+		{
+			void * p = mmap( NULL, m_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+			if( p == MAP_FAILED ) { ::close( fd ); m_size = 0; return false; }
+			madvise( p, m_size, MADV_SEQUENTIAL );
+			m_data = (const char*) p;
+		}
+		::close( fd );
+#endif
+		return true;
+	};
+
+	/*! unmap the file */
+	void close()
+	{
+#if defined(_WIN32)
+		if( m_data != NULL ) UnmapViewOfFile( m_data );
+		if( m_mapping != NULL ) CloseHandle( m_mapping );
+		if( m_file != INVALID_HANDLE_VALUE ) CloseHandle( m_file );
+		m_mapping = NULL;
+		m_file = INVALID_HANDLE_VALUE;
+#else
+		if( m_data != NULL ) munmap( (void*) m_data, m_size );
+#endif
+		m_data = NULL;
+		m_size = 0;
+	};
+
+	/*! first byte of the file */
+	const char * begin() const { return m_data; };
+	/*! past the last byte of the file */
+	const char * end()   const { return m_data + m_size; };
+	/*! size of the file in bytes */
+	size_t       size()  const { return m_size; };
+
+protected:
+	CMappedFile( const CMappedFile & );
+	CMappedFile & operator=( const CMappedFile & );
+
+	const char * m_data;
+	size_t       m_size;
+#if defined(_WIN32)
+	HANDLE       m_file;
+	HANDLE       m_mapping;
+#endif
+};
+
+/*!
+ *	\brief CScanner class, reads the words and numbers of a text buffer line by line
+ *
+ *	The buffer is not copied and needs no terminating zero. The words of a
+ *	line are separated by blanks, a scan never goes past the end of the line,
+ *	next_line() moves to the next one.
+ */
+class CScanner
+{
+public:
+	/*!
+	 *	\brief CScanner constructor
+	 *	\param begin first byte of the text
+	 *	\param end past the last byte of the text
+	 */
+	CScanner( const char * begin, const char * end ) : m_pt( begin ), m_end( end ) {};
+
+	/*! whether the whole text has been read */
+	bool end() const { return m_pt >= m_end; };
+
+	/*! move to the beginning of the next line */
+	void next_line()
+	{
+		const char * p = (const char*) memchr( m_pt, '\n', m_end - m_pt );
+		m_pt = ( p == NULL ) ? m_end : p + 1;
+	};
+
+	/*! skip the blanks, stop at the end of the line */
+	void skip_blank()
+	{
+		while( m_pt < m_end && ( *m_pt == ' ' || *m_pt == '\t' || *m_pt == '\r' ) ) m_pt ++;
+	};
+
+	/*! whether the line has been read */
+	bool end_of_line()
+	{
+		for( ; m_pt < m_end; m_pt ++ )
+		{
+			char c = *m_pt;
+			if( c != ' ' && c != '\t' && c != '\r' ) return c == '\n';
+		}
+		return true;
+	};
+
+	/*! the current character, after the blanks */
+	char peek()
+	{
+		return end_of_line() ? '\n' : *m_pt;
+	};
+
+	/*!
+	 *	read the next word of the line
+	 *	\param word its first character
+	 *	\param n its length
+	 *	\return false at the end of the line
+	 */
+	bool word( const char * & word, size_t & n )
+	{
+		if( end_of_line() ) return false;
+		word = m_pt;
+		while( m_pt < m_end && !_blank( *m_pt ) ) m_pt ++;
+		n = m_pt - word;
+		return true;
+	};
+
+	/*! whether the next word of the line is key, the word is read */
+	bool keyword( const char * key )
+	{
+		const char * w;
+		size_t n;
+		if( !word( w, n ) ) return false;
+		return n == strlen( key ) && memcmp( w, key, n ) == 0;
+	};
+
+	/*! read an integer, false if the next word does not start with one */
+	bool parse_int( int & value )
+	{
+		if( end_of_line() ) return false;
+		const char * p = m_pt;
+		bool negative = ( *p == '-' );
+		if( negative ) p ++;
+		if( p == m_end || (unsigned)( *p - '0' ) > 9 ) return _parse_c( value );
+		unsigned int u = 0;
+		while( p < m_end && (unsigned)( *p - '0' ) <= 9 ) u = u * 10 + ( *p ++ - '0' );
+		value = negative ? -(int) u : (int) u;
+		m_pt = p;
+		return true;
+	};
+
+	/*! read a float, false if the next word does not start with one */
+	bool parse_float( float & value )
+	{
+		if( end_of_line() ) return false;
+		if( _parse_short( value ) ) return true;
+#if defined(__cpp_lib_to_chars)
+		std::from_chars_result r = std::from_chars( m_pt, m_end, value );
+		if( r.ec == std::errc() )
+		{
+			m_pt = r.ptr;
+			return true;
+		}
+#endif
+		return _parse_c( value );
+	};
+
+	/*! skip one character, if it is c */
+	bool skip( char c )
+	{
+		if( m_pt < m_end && *m_pt == c ) { m_pt ++; return true; }
+		return false;
+	};
+
+	/*!
+	 *	read the trait string of the line, between the first '{' and the
+	 *	first '}' after it, the rest of the line is read
+	 *	\param str the trait string, unchanged if there is none
+	 */
+	void trait( std::string & str )
+	{
+		const char * eol = (const char*) memchr( m_pt, '\n', m_end - m_pt );
+		if( eol == NULL ) eol = m_end;
+		const char * sp = (const char*) memchr( m_pt, '{', eol - m_pt );
+		const char * ep = ( sp == NULL ) ? NULL : (const char*) memchr( sp, '}', eol - sp );
+		if( ep != NULL ) str.assign( sp + 1, ep );
+		m_pt = eol;
+	};
+
+protected:
+	static bool _blank( char c ) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; };
+
+	/*!
+	 *	the short decimals written by the mesh files, at most 7 digits and no
+	 *	exponent, are a float integer times or over an exact power of ten, so
+	 *	one division rounds them correctly, the others are left to the library
+	 */
+	bool _parse_short( float & value )
+	{
+		static const float power[] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f };
+		const char * p = m_pt;
+		bool negative = ( *p == '-' );
+		if( negative ) p ++;
+		unsigned int m = 0;
+		int digits = 0, decimals = 0;
+		while( p < m_end && (unsigned)( *p - '0' ) <= 9 ) { m = m * 10 + ( *p ++ - '0' ); digits ++; }
+		if( p < m_end && *p == '.' )
+		{
+			p ++;
+			while( p < m_end && (unsigned)( *p - '0' ) <= 9 ) { m = m * 10 + ( *p ++ - '0' ); digits ++; decimals ++; }
+		}
+		if( digits == 0 || digits > 7 || decimals > 10 ) return false;
+		if( p < m_end && ( *p == 'e' || *p == 'E' || *p == '.' ) ) return false;
+		float f = (float) m / power[decimals];
+		value = negative ? -f : f;
+		m_pt = p;
+		return true;
+	};
+
+	/*! copy the next number to a terminated buffer for the C library */
+	size_t _copy( char * buffer, size_t size )
+	{
+		size_t n = 0;
+		while( m_pt + n < m_end && n < size - 1 && !_blank( m_pt[n] ) && m_pt[n] != '/' && m_pt[n] != '{' ) n ++;
+		memcpy( buffer, m_pt, n );
+		buffer[n] = 0;
+		return n;
+	};
+
+	bool _parse_c( int & value )
+	{
+		char buffer[64], * e;
+		_copy( buffer, sizeof( buffer ) );
+		long l = strtol( buffer, &e, 10 );
+		if( e == buffer ) return false;
+		value = (int) l;
+		m_pt += e - buffer;
+		return true;
+	};
+
+	bool _parse_c( float & value )
+	{
+		char buffer[64], * e;
+		_copy( buffer, sizeof( buffer ) );
+		float f = strtof( buffer, &e );
+		if( e == buffer ) return false;
+		value = f;
+		m_pt += e - buffer;
+		return true;
+	};
+
+	/*! current position */
+	const char * m_pt;
+	/*! past the last byte */
+	const char * m_end;
+};
+
+}
+#endif
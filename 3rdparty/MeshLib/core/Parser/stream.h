@@ -0,0 +1,288 @@
+/*!
+*      \file stream.h
+*      \brief Streaming of the vertices and faces of .m and .mb files in chunks
+*
+*/
+
+#ifndef _MESHLIB_STREAM_H_
+#define _MESHLIB_STREAM_H_
+
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "../Geometry/Point.h"
+#include "strutil.h"
+#include "scanner.h"
+#include "binary.h"
+
+namespace MeshLib
+{
+
+/*!
+ *	\brief CVertexChunk, consecutive vertices of a mesh file
+ */
+struct CVertexChunk
+{
+	/*! number of vertices */
+	size_t size() const { return ids.size(); };
+
+	void clear()
+	{
+		ids.clear();
+		points.clear();
+		traits.clear();
+	};
+
+	std::vector<int>         ids;
+	std::vector<CPoint>      points;
+	/*! trait strings, empty unless the stream reads the traits */
+	std::vector<std::string> traits;
+};
+
+/*!
+ *	\brief CFaceChunk, consecutive faces of a mesh file
+ *
+ *	The vertices of the face i are vertices[offsets[i]] to vertices[offsets[i+1]-1],
+ *	given by their ids.
+ */
+struct CFaceChunk
+{
+	CFaceChunk() { clear(); };
+
+	/*! number of faces */
+	size_t size() const { return ids.size(); };
+
+	/*! number of vertices of the face i */
+	int degree( size_t i ) const { return offsets[i + 1] - offsets[i]; };
+
+	/*! vertex id of the k-th corner of the face i */
+	int vertex( size_t i, int k ) const { return vertices[offsets[i] + k]; };
+
+	void clear()
+	{
+		ids.clear();
+		offsets.assign( 1, 0 );
+		vertices.clear();
+		traits.clear();
+	};
+
+	std::vector<int>         ids;
+	std::vector<int>         offsets;
+	std::vector<int>         vertices;
+	/*! trait strings, empty unless the stream reads the traits */
+	std::vector<std::string> traits;
+};
+
+/*!
+ *	\brief CMeshStream class, reads a mesh file chunk by chunk without building a mesh
+ *
+ *	The file is mapped, only the current chunk is held in memory, so a pass
+ *	over a mesh larger than the memory, its bounding box, its area or a
+ *	sample of its points, costs a few chunks. The chunks come in the order
+ *	of the file, the edges and the corners are skipped.
+ *
+ *	\code
+ *	CMeshStream stream;
+ *	if( stream.open( "city.mb" ) )
+ *		stream.read( []( const CVertexChunk & v ) { ... }, []( const CFaceChunk & f ) { ... } );
+ *	\endcode
+ *
+ *	A face refers to its vertices by id; a pass which needs their points,
+ *	as the area, keeps the points of the first pass, 24 bytes per vertex.
+ */
+class CMeshStream
+{
+public:
+	CMeshStream() : m_chunk( 65536 ), m_traits( false ), m_binary( false ) {};
+
+	/*! number of elements of a chunk */
+	void chunk( size_t n ) { m_chunk = ( n > 0 ) ? n : 1; };
+
+	/*! whether the trait strings are read, they are not by default */
+	void traits( bool read ) { m_traits = read; };
+
+	/*!
+	 *	open a .mb file, or an .m file for any other extension
+	 *	\return false if the file cannot be read
+	 */
+	bool open( const char * input )
+	{
+		close();
+		m_binary = strutil::endsWith( std::string( input ), ".mb" );
+		if( m_binary ) return m_reader.open( input );
+		if( !m_file.open( input ) )
+		{
+			fprintf( stderr, "Error in opening file %s\n", input );
+			return false;
+		}
+		return true;
+	};
+
+	/*! unmap the file */
+	void close()
+	{
+		m_file.close();
+		m_reader.close();
+	};
+
+	/*!
+	 *	one pass over the file, it can be read again
+	 *	\param vertices vertices( const CVertexChunk & ) is called for each chunk of vertices
+	 *	\param faces faces( const CFaceChunk & ) is called for each chunk of faces
+	 */
+	template<typename VF, typename FF>
+	void read( VF vertices, FF faces )
+	{
+		m_vertices.clear();
+		m_faces.clear();
+		if( m_binary ) _read_mb( vertices, faces );
+		else           _read_m( vertices, faces );
+		if( m_vertices.size() > 0 ) vertices( m_vertices );
+		if( m_faces.size() > 0 )    faces( m_faces );
+		m_vertices.clear();
+		m_faces.clear();
+	};
+
+protected:
+	CMeshStream( const CMeshStream & );
+	CMeshStream & operator=( const CMeshStream & );
+
+	template<typename VF, typename FF>
+	void _read_m( VF & vertices, FF & faces )
+	{
+		if( m_file.size() == 0 ) return;
+
+		for( CScanner scanner( m_file.begin(), m_file.end() ); !scanner.end(); scanner.next_line() )
+		{
+			const char * word;
+			size_t n;
+			if( !scanner.word( word, n ) ) continue;
+
+			if( n == 6 && memcmp( word, "Vertex", 6 ) == 0 )
+			{
+				// the faces before the vertex come first
+				if( m_faces.size() > 0 ) { faces( m_faces ); m_faces.clear(); }
+
+				int id = 0;
+				scanner.parse_int( id );
+
+				CPoint p;
+				for( int i = 0; i < 3; i ++ )
+				{
+					float x = 0;
+					scanner.parse_float( x );
+					p[i] = x;
+				}
+				m_vertices.ids.push_back( id );
+				m_vertices.points.push_back( p );
+				if( m_traits )
+				{
+					m_vertices.traits.push_back( std::string() );
+					scanner.trait( m_vertices.traits.back() );
+				}
+
+				if( m_vertices.size() >= m_chunk ) { vertices( m_vertices ); m_vertices.clear(); }
+				continue;
+			}
+
+			if( n == 4 && memcmp( word, "Face", 4 ) == 0 )
+			{
+				if( m_vertices.size() > 0 ) { vertices( m_vertices ); m_vertices.clear(); }
+
+				int id = 0;
+				scanner.parse_int( id );
+
+				int vid;
+				while( scanner.peek() != '{' && scanner.parse_int( vid ) ) m_faces.vertices.push_back( vid );
+				m_faces.ids.push_back( id );
+				m_faces.offsets.push_back( (int) m_faces.vertices.size() );
+				if( m_traits )
+				{
+					m_faces.traits.push_back( std::string() );
+					scanner.trait( m_faces.traits.back() );
+				}
+
+				if( m_faces.size() >= m_chunk ) { faces( m_faces ); m_faces.clear(); }
+				continue;
+			}
+		}
+	};
+
+	template<typename VF, typename FF>
+	void _read_mb( VF & vertices, FF & faces )
+	{
+		size_t nv = m_reader.rows( MB_VERTEX );
+		size_t nf = m_reader.rows( MB_FACE );
+		size_t nc = m_reader.rows( MB_FACE_VERTEX );
+
+		const int32_t * vids   = m_reader.int32( MB_VERTEX, "id", 1 );
+		const double  * points = m_reader.float64( MB_VERTEX, "point", 3 );
+		const int32_t * fids   = m_reader.int32( MB_FACE, "id", 1 );
+		const int32_t * degree = m_reader.int32( MB_FACE, "degree", 1 );
+		const int32_t * fv     = m_reader.int32( MB_FACE_VERTEX, "vertex", 1 );
+		if( vids == NULL || points == NULL || ( nf > 0 && ( fids == NULL || fv == NULL ) ) )
+		{
+			fprintf( stderr, "Error in reading the .mb file, missing columns\n" );
+			return;
+		}
+
+		for( size_t i = 0; i < nv; i ++ )
+		{
+			const double * p = points + 3 * i;
+			m_vertices.ids.push_back( vids[i] );
+			m_vertices.points.push_back( CPoint( p[0], p[1], p[2] ) );
+			if( m_traits )
+			{
+				m_vertices.traits.push_back( std::string() );
+				m_reader.trait( MB_VERTEX, i, m_vertices.traits.back() );
+			}
+			if( m_vertices.size() >= m_chunk ) { vertices( m_vertices ); m_vertices.clear(); }
+		}
+		if( m_vertices.size() > 0 ) { vertices( m_vertices ); m_vertices.clear(); }
+
+		size_t c = 0;
+		for( size_t i = 0; i < nf; i ++ )
+		{
+			int d = ( degree != NULL ) ? degree[i] : 3;
+			if( d < 3 || c + d > nc )
+			{
+				fprintf( stderr, "Error in reading the .mb file, invalid face %d\n", fids[i] );
+				return;
+			}
+			for( int k = 0; k < d; k ++, c ++ )
+			{
+				if( fv[c] < 0 || (size_t) fv[c] >= nv )
+				{
+					fprintf( stderr, "Error in reading the .mb file, invalid face %d\n", fids[i] );
+					return;
+				}
+				m_faces.vertices.push_back( vids[fv[c]] );
+			}
+			m_faces.ids.push_back( fids[i] );
+			m_faces.offsets.push_back( (int) m_faces.vertices.size() );
+			if( m_traits )
+			{
+				m_faces.traits.push_back( std::string() );
+				m_reader.trait( MB_FACE, i, m_faces.traits.back() );
+			}
+			if( m_faces.size() >= m_chunk ) { faces( m_faces ); m_faces.clear(); }
+		}
+	};
+
+	/*! number of elements of a chunk */
+	size_t        m_chunk;
+	/*! whether the trait strings are read */
+	bool          m_traits;
+	/*! whether the file is a .mb file */
+	bool          m_binary;
+
+	CMappedFile   m_file;
+	CBinaryReader m_reader;
+
+	CVertexChunk  m_vertices;
+	CFaceChunk    m_faces;
+};
+
+}
+#endif
@@ -0,0 +1,197 @@
+/*!
+*      \file writer.h
+*      \brief Buffered output of the mesh files, the rows are formatted in parallel
+*
+*/
+
+#ifndef _MESHLIB_WRITER_H_
+#define _MESHLIB_WRITER_H_
+
+#include <stdio.h>
+#include <math.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+namespace MeshLib
+{
+
+/*!
+ *	\brief CTextBuffer class, text formatted as an ostream with the default flags does
+ *
+ *	The numbers are written as "%d" and "%g", the short decimals of the mesh
+ *	files directly, the others through the C library.
+ */
+class CTextBuffer
+{
+public:
+	/*! empty the buffer, its memory is kept */
+	void clear() { m_text.clear(); };
+
+	/*! the text */
+	const char * data() const { return m_text.data(); };
+	/*! length of the text */
+	size_t       size() const { return m_text.size(); };
+
+	CTextBuffer & operator<<( char c )                { m_text += c; return *this; };
+	CTextBuffer & operator<<( const char * s )        { m_text += s; return *this; };
+	CTextBuffer & operator<<( const std::string & s ) { m_text += s; return *this; };
+
+	CTextBuffer & operator<<( int v )
+	{
+		char buffer[16];
+		int k = sizeof( buffer );
+		unsigned int u = ( v < 0 ) ? 0u - (unsigned int) v : (unsigned int) v;
+		do { buffer[-- k] = (char)( '0' + u % 10 ); u /= 10; } while( u > 0 );
+		if( v < 0 ) buffer[-- k] = '-';
+		m_text.append( buffer + k, sizeof( buffer ) - k );
+		return *this;
+	};
+
+	CTextBuffer & operator<<( size_t v )
+	{
+		char buffer[24];
+		int k = sizeof( buffer );
+		do { buffer[-- k] = (char)( '0' + v % 10 ); v /= 10; } while( v > 0 );
+		m_text.append( buffer + k, sizeof( buffer ) - k );
+		return *this;
+	};
+
+	CTextBuffer & operator<<( double v )
+	{
+		char buffer[32];
+		int k = format( buffer, sizeof( buffer ), v );
+		m_text.append( buffer, k );
+		return *this;
+	};
+
+	/*!
+	 *	write a number as an ostream does, "%g", the short decimals of the
+	 *	mesh files, six digits at most in fixed notation, are written directly
+	 *	\return the number of characters
+	 */
+	static int format( char * buffer, size_t size, double v )
+	{
+		static const double power[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9 };
+		double a = ( v < 0 ) ? -v : v;
+		if( a >= 1e-4 && a < 1e6 )
+		{
+			// a lies in [10^x, 10^(x+1)), six significant digits are p = 5 - x decimals
+			int p = 0;
+			while( p < 9 && a * power[p] < 1e5 ) p ++;
+			double r = floor( a * power[p] + 0.5 );
+			// r / 10^p is the decimal of v, so it is what printf would round v to
+			if( r / power[p] == a )
+			{
+				char digits[16];
+				int n = 0;
+				unsigned long d = (unsigned long) r;
+				do { digits[n ++] = (char)( '0' + d % 10 ); d /= 10; } while( d > 0 );
+				while( n <= p ) digits[n ++] = '0';
+				int trim = 0;
+				while( trim < p && digits[trim] == '0' ) trim ++;
+
+				int k = 0;
+				if( v < 0 ) buffer[k ++] = '-';
+				for( int i = n - 1; i >= p; i -- ) buffer[k ++] = digits[i];
+				if( trim < p ) buffer[k ++] = '.';
+				for( int i = p - 1; i >= trim; i -- ) buffer[k ++] = digits[i];
+				buffer[k] = 0;
+				return k;
+			}
+		}
+		return snprintf( buffer, size, "%g", v );
+	};
+
+protected:
+	std::string m_text;
+};
+
+/*!
+ *	\brief CTextFile class, a text file written by large sequential writes
+ *
+ *	rows() formats blocks of rows in parallel, each chunk of rows into
+ *	its own buffer, then writes the buffers in the order of the rows, so
+ *	the file is the same as the one written row after row.
+ */
+class CTextFile
+{
+public:
+	CTextFile() : m_file( NULL ), m_good( true ), m_chunks( CHUNKS ) {};
+	~CTextFile() { close(); };
+
+	/*!
+	 *	open a file for writing, in text mode as an fstream
+	 *	\param name the file name
+	 *	\return whether the file has been opened
+	 */
+	bool open( const char * name )
+	{
+		close();
+		m_file = fopen( name, "w" );
+		m_good = ( m_file != NULL );
+		if( m_file != NULL ) setvbuf( m_file, NULL, _IOFBF, 1 << 20 );
+		return m_good;
+	};
+
+	/*! flush and close the file, false if a write has failed */
+	bool close()
+	{
+		if( m_file == NULL ) return m_good;
+		if( fclose( m_file ) != 0 ) m_good = false;
+		m_file = NULL;
+		return m_good;
+	};
+
+	/*! whether all the writes have succeeded */
+	bool good() const { return m_good; };
+
+	/*! write the text of a buffer */
+	void write( const CTextBuffer & buffer )
+	{
+		if( m_file == NULL || buffer.size() == 0 ) return;
+		if( fwrite( buffer.data(), 1, buffer.size(), m_file ) != buffer.size() ) m_good = false;
+	};
+
+	/*!
+	 *	write n rows
+	 *	\param n the number of rows
+	 *	\param format format( i, buffer ) appends the row i to the buffer, it is
+	 *	called from several threads at once, and may append nothing
+	 */
+	template<typename F>
+	void rows( size_t n, F format )
+	{
+		size_t chunks = ( n + ROWS - 1 ) / ROWS;
+		for( size_t first = 0; first < chunks; first += CHUNKS )
+		{
+			int m = (int)( ( chunks - first < CHUNKS ) ? chunks - first : CHUNKS );
+
+#pragma omp parallel for schedule(dynamic)
+			for( int c = 0; c < m; c ++ )
+			{
+				CTextBuffer & buffer = m_chunks[c];
+				buffer.clear();
+				size_t begin = ( first + c ) * ROWS;
+				size_t end   = ( begin + ROWS < n ) ? begin + ROWS : n;
+				for( size_t i = begin; i < end; i ++ ) format( i, buffer );
+			}
+
+			for( int c = 0; c < m; c ++ ) write( m_chunks[c] );
+		}
+	};
+
+protected:
+	/*! rows of a chunk, and chunks formatted at once */
+	static const size_t ROWS = 4096, CHUNKS = 64;
+
+	CTextFile( const CTextFile & );
+	CTextFile & operator=( const CTextFile & );
+
+	FILE *                   m_file;
+	bool                     m_good;
+	std::vector<CTextBuffer> m_chunks;
+};
+
+}
+#endif
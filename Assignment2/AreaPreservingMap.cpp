@@ -0,0 +1,117 @@
+#include <chrono>
+
+#include "AreaPreservingMap.h"
+
+bool MeshLib::CAreaPreservingMap::set_mesh(CHarmonicMapMesh* pMesh, bool mapped)
+{
+    using M = CHarmonicMapMesh;
+
+    // only topological disks, one component of genus zero with one boundary
+    m_pMesh = NULL;
+    M::CTopology topology(pMesh);
+    if (!topology.is_disk())
+    {
+        std::cerr << "Only topological disk accepted! " << topology.components().size() << " components, genus "
+                  << topology.genus() << ", " << topology.boundaries() << " boundaries" << std::endl;
+        return false;
+    }
+    m_pMesh = pMesh;
+    m_mapped = mapped;
+    return true;
+}
+
+bool MeshLib::CAreaPreservingMap::map(double epsilon)
+{
+    if (!m_pMesh)
+    {
+        std::cerr << "Should set mesh first!" << std::endl;
+        return false;
+    }
+
+    typedef std::chrono::steady_clock clock;
+    m_timings.clear();
+
+    clock::time_point t0 = clock::now();
+    bool success = _harmonic_map();
+    clock::time_point t1 = clock::now();
+    if (success)
+        _measure();
+    clock::time_point t2 = clock::now();
+    if (success)
+        success = _transport(epsilon);
+    clock::time_point t3 = clock::now();
+    if (success)
+        _compose();
+    clock::time_point t4 = clock::now();
+
+    m_timings.push_back(std::make_pair("harmonic map", std::chrono::duration<double, std::milli>(t1 - t0).count()));
+    m_timings.push_back(std::make_pair("measure", std::chrono::duration<double, std::milli>(t2 - t1).count()));
+    m_timings.push_back(std::make_pair("optimal transport", std::chrono::duration<double, std::milli>(t3 - t2).count()));
+    m_timings.push_back(std::make_pair("compose", std::chrono::duration<double, std::milli>(t4 - t3).count()));
+    for (size_t k = 0; k < m_timings.size(); k++)
+        printf("Stage %-18s %10.3f ms\n", m_timings[k].first.c_str(), m_timings[k].second);
+
+    return success;
+}
+
+bool MeshLib::CAreaPreservingMap::_harmonic_map()
+{
+    if (m_mapped)
+        return true;
+    if (!m_harmonic_map.set_mesh(m_pMesh))
+        return false;
+    return m_harmonic_map.map();
+}
+
+void MeshLib::CAreaPreservingMap::_measure()
+{
+    using M = CHarmonicMapMesh;
+
+    const int nv = m_pMesh->numVertices();
+    m_verts.resize(nv);
+    m_sites.resize(nv);
+    m_mass.assign(nv, 0.0);
+
+    int vid = 0;
+    for (M::MeshVertexIterator viter(m_pMesh); !viter.end(); ++viter)
+    {
+        M::CVertex* pV = *viter;
+        pV->idx() = vid;
+        m_verts[vid] = pV;
+        m_sites[vid] = pV->uv();
+        vid++;
+    }
+
+    // the vertex area is one third of the areas of its faces
+    for (M::MeshFaceIterator fiter(m_pMesh); !fiter.end(); ++fiter)
+    {
+        M::CFace* pF = *fiter;
+        M::CHalfEdge* pH = m_pMesh->faceHalfedge(pF);
+        M::CVertex* pV[3];
+        for (int k = 0; k < 3; k++)
+        {
+            pV[k] = m_pMesh->halfedgeTarget(pH);
+            pH = m_pMesh->halfedgeNext(pH);
+        }
+
+        CPoint n = (pV[1]->point() - pV[0]->point()) ^ (pV[2]->point() - pV[0]->point());
+        double area = n.norm() / 2.0;
+        for (int k = 0; k < 3; k++)
+            m_mass[pV[k]->idx()] += area / 3.0;
+    }
+}
+
+bool MeshLib::CAreaPreservingMap::_transport(double epsilon)
+{
+    m_transport.set_sites(m_sites, m_mass);
+    bool success = m_transport.solve(epsilon) >= 0;
+    m_error = m_transport.error();
+    return success;
+}
+
+void MeshLib::CAreaPreservingMap::_compose()
+{
+    std::vector<CPoint2>& centroids = m_transport.centroids();
+    for (size_t i = 0; i < m_verts.size(); i++)
+        m_verts[i]->uv() = centroids[i];
+}
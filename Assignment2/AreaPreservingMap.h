@@ -0,0 +1,103 @@
+#ifndef _AREA_PRESERVING_MAP_H_
+#define _AREA_PRESERVING_MAP_H_
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "HarmonicMap.h"
+#include "DiskOptimalTransport.h"
+
+namespace MeshLib
+{
+
+/*! \brief CAreaPreservingMap class
+ *
+ *   Area-preserving map of a topological disk to the unit disk. The
+ *   harmonic map gives the sites in the disk, the vertex areas of the
+ *   surface give their masses, and the semi-discrete optimal transport
+ *   from the uniform disk moves each vertex to the centroid of its power
+ *   cell. The time of each stage is recorded.
+ */
+class CAreaPreservingMap
+{
+  public:
+    /*!
+     *  CAreaPreservingMap constructor
+     */
+    CAreaPreservingMap() : m_pMesh(NULL), m_mapped(false), m_error(0) {};
+
+    /*!
+     *  Set mesh
+     *  \param pMesh input topological disk
+     *  \param mapped whether the vertex uv is already the harmonic map,
+     *  then the first stage is skipped
+     *  \return false if the mesh is not a topological disk
+     */
+    bool set_mesh(CHarmonicMapMesh* pMesh, bool mapped = false);
+
+    /*!
+     *  Run all the stages, the result is written to the vertex uv
+     *  \param epsilon relative area error threshold of the transport
+     *  \return false if some stage fails
+     */
+    bool map(double epsilon = 1e-4);
+
+    /*!
+     *  Name and milliseconds of each stage of the last map
+     */
+    std::vector<std::pair<std::string, double>>& timings() { return m_timings; };
+
+    /*!
+     *  Relative l1 error of the cell areas after the last transport
+     */
+    double area_error() { return m_error; };
+
+  protected:
+    /*!
+     *  Stage 1, harmonic map to the unit disk, unless the uv is mapped
+     *  \return false if the equations are not solved
+     */
+    bool _harmonic_map();
+
+    /*!
+     *  Stage 2, the sites and the vertex areas as their masses
+     */
+    void _measure();
+
+    /*!
+     *  Stage 3, semi-discrete optimal transport
+     */
+    bool _transport(double epsilon);
+
+    /*!
+     *  Stage 4, compose the maps, move each vertex to its cell centroid
+     */
+    void _compose();
+
+  protected:
+    /*! the input mesh */
+    CHarmonicMapMesh* m_pMesh;
+
+    /*! whether the uv of the input mesh is the harmonic map */
+    bool m_mapped;
+
+    /*! harmonic map */
+    CHarmonicMap m_harmonic_map;
+
+    /*! optimal transport */
+    CDiskOptimalTransport m_transport;
+
+    /*! vertices, sites and masses, in the same order */
+    std::vector<CHarmonicMapVertex*> m_verts;
+    std::vector<CPoint2> m_sites;
+    std::vector<double> m_mass;
+
+    /*! time of each stage */
+    std::vector<std::pair<std::string, double>> m_timings;
+
+    /*! relative area error of the last transport */
+    double m_error;
+};
+}
+#endif // !_AREA_PRESERVING_MAP_H_
@@ -0,0 +1,530 @@
+#include <math.h>
+#include <float.h>
+#include <stdio.h>
+#include <algorithm>
+#include <iostream>
+
+#include <Eigen/Sparse>
+
+#include "DiskOptimalTransport.h"
+
+#ifndef M_PI
+#define M_PI 3.141592653589793238462643383279
+#endif
+
+namespace MeshLib
+{
+/*!
+ *  Clip a convex polygon by the half plane a x + b y <= c. The label of
+ *  the k-th edge, from the k-th vertex to the next, is stored in pl[k].
+ */
+static void _clip_polygon(std::vector<double>& px, std::vector<double>& py, std::vector<int>& pl,
+                          std::vector<double>& qx, std::vector<double>& qy, std::vector<int>& ql,
+                          double a, double b, double c, int label)
+{
+    const int m = (int)px.size();
+
+    bool outside = false;
+    for (int k = 0; k < m && !outside; k++)
+        outside = (a * px[k] + b * py[k] > c);
+    if (!outside)
+        return;
+
+    qx.clear();
+    qy.clear();
+    ql.clear();
+    for (int k = 0; k < m; k++)
+    {
+        int n = (k + 1 < m) ? k + 1 : 0;
+        double dk = a * px[k] + b * py[k] - c;
+        double dn = a * px[n] + b * py[n] - c;
+
+        if (dk <= 0)
+        {
+            qx.push_back(px[k]);
+            qy.push_back(py[k]);
+            ql.push_back(pl[k]);
+        }
+        if ((dk <= 0) != (dn <= 0))
+        {
+            double t = dk / (dk - dn);
+            qx.push_back(px[k] + t * (px[n] - px[k]));
+            qy.push_back(py[k] + t * (py[n] - py[k]));
+            // entering the half plane continues the old edge, leaving it starts the cut
+            ql.push_back((dk <= 0) ? label : pl[k]);
+        }
+    }
+    px.swap(qx);
+    py.swap(qy);
+    pl.swap(ql);
+}
+}
+
+MeshLib::CDiskOptimalTransport::CDiskOptimalTransport(int segments) : m_segments(segments)
+{
+    m_disk_area = m_segments / 2.0 * sin(2.0 * M_PI / m_segments);
+    m_normals.resize(m_segments);
+    for (int k = 0; k < m_segments; k++)
+    {
+        double theta = 2.0 * M_PI * (k + 0.5) / m_segments;
+        m_normals[k] = CPoint2(cos(theta), sin(theta));
+    }
+}
+
+void MeshLib::CDiskOptimalTransport::set_sites(const std::vector<CPoint2>& sites, const std::vector<double>& mass)
+{
+    m_site = sites;
+    m_mass = mass;
+
+    // scale the masses to the area of the disk polygon
+    double total = 0;
+    for (size_t i = 0; i < m_mass.size(); i++)
+        total += m_mass[i];
+    for (size_t i = 0; i < m_mass.size(); i++)
+        m_mass[i] *= m_disk_area / total;
+
+    const int n = (int)m_site.size();
+    m_weight.assign(n, 0.0);
+    m_area.resize(n);
+    m_centroid.resize(n);
+    m_adjacency.resize(n);
+
+    _sort_sites();
+}
+
+void MeshLib::CDiskOptimalTransport::_sort_sites()
+{
+    const int n = (int)m_site.size();
+
+    // about two sites per bucket, covering [-1, 1]^2
+    int grid = (int)sqrt(n / 2.0);
+    grid = (grid < 1) ? 1 : grid;
+    const double h = 2.0 / grid;
+
+    std::vector<int> bucket(n);
+    std::vector<int> offsets(grid * grid + 1, 0);
+    for (int i = 0; i < n; i++)
+    {
+        int gx = std::min(std::max((int)((m_site[i][0] + 1.0) / h), 0), grid - 1);
+        int gy = std::min(std::max((int)((m_site[i][1] + 1.0) / h), 0), grid - 1);
+        // odd rows run backward
+        if (gy % 2)
+            gx = grid - 1 - gx;
+        bucket[i] = gy * grid + gx;
+        offsets[bucket[i] + 1]++;
+    }
+    for (int b = 0; b < grid * grid; b++)
+        offsets[b + 1] += offsets[b];
+
+    m_order.resize(n);
+    for (int i = 0; i < n; i++)
+        m_order[offsets[bucket[i]]++] = i;
+}
+
+bool MeshLib::CDiskOptimalTransport::_triangulate(const std::vector<double>& weight)
+{
+    const int n = (int)m_site.size();
+
+    // lifted sites, z = x^2 + y^2 - w, the last three form the super triangle
+    std::vector<double> X(n + 3), Y(n + 3), Z(n + 3);
+    for (int i = 0; i < n; i++)
+    {
+        X[i] = m_site[i][0];
+        Y[i] = m_site[i][1];
+        Z[i] = X[i] * X[i] + Y[i] * Y[i] - weight[i];
+    }
+    const double L = 1e3;
+    X[n + 0] = -L;
+    Y[n + 0] = -L;
+    X[n + 1] = L;
+    Y[n + 1] = -L;
+    X[n + 2] = 0;
+    Y[n + 2] = L;
+    for (int k = n; k < n + 3; k++)
+        Z[k] = X[k] * X[k] + Y[k] * Y[k];
+
+    // triangle t has vertices tv[3t+k] in ccw order, tn[3t+k] is opposite to tv[3t+k]
+    std::vector<int> tv(3), tn(3, -1);
+    tv[0] = n;
+    tv[1] = n + 1;
+    tv[2] = n + 2;
+
+    auto orient = [&](int a, int b, int p) -> double {
+        return (X[b] - X[a]) * (Y[p] - Y[a]) - (Y[b] - Y[a]) * (X[p] - X[a]);
+    };
+    // positive if p conflicts with the orthogonal circle of the triangle t
+    auto power = [&](int t, int p) -> double {
+        int a = tv[3 * t], b = tv[3 * t + 1], c = tv[3 * t + 2];
+        double adx = X[a] - X[p], ady = Y[a] - Y[p], adz = Z[a] - Z[p];
+        double bdx = X[b] - X[p], bdy = Y[b] - Y[p], bdz = Z[b] - Z[p];
+        double cdx = X[c] - X[p], cdy = Y[c] - Y[p], cdz = Z[c] - Z[p];
+        return adx * (bdy * cdz - bdz * cdy) - ady * (bdx * cdz - bdz * cdx) + adz * (bdx * cdy - bdy * cdx);
+    };
+
+    std::vector<int> stamp(1, 0), dead(1, 0), free_tris;
+    std::vector<int> cavity, edges, created, start(n + 3, -1);
+
+    int last = 0;
+    for (int s = 0; s < n; s++)
+    {
+        const int p = m_order[s];
+
+        // 1. locate p by walking from the last triangle
+        int t = last;
+        for (int steps = 0; t >= 0; steps++)
+        {
+            if (steps > (int)stamp.size())
+            {
+                // the walk cycles on degenerate input, scan all the triangles
+                for (t = 0; t < (int)stamp.size(); t++)
+                {
+                    if (!dead[t] && orient(tv[3 * t], tv[3 * t + 1], p) >= 0 &&
+                        orient(tv[3 * t + 1], tv[3 * t + 2], p) >= 0 && orient(tv[3 * t + 2], tv[3 * t], p) >= 0)
+                        break;
+                }
+                break;
+            }
+            int k = 0;
+            for (; k < 3; k++)
+            {
+                int e = (k + steps) % 3;
+                if (orient(tv[3 * t + (e + 1) % 3], tv[3 * t + (e + 2) % 3], p) < 0)
+                {
+                    t = tn[3 * t + e];
+                    break;
+                }
+            }
+            if (k == 3)
+                break;
+        }
+        // hidden by the sites inserted before
+        if (t < 0 || t >= (int)stamp.size() || power(t, p) <= 0)
+            continue;
+
+        // 2. the cavity, triangles in conflict with p
+        cavity.clear();
+        cavity.push_back(t);
+        stamp[t] = s + 1;
+        for (size_t c = 0; c < cavity.size(); c++)
+        {
+            int u = cavity[c];
+            for (int k = 0; k < 3; k++)
+            {
+                int w = tn[3 * u + k];
+                if (w >= 0 && stamp[w] != s + 1 && power(w, p) > 0)
+                {
+                    stamp[w] = s + 1;
+                    cavity.push_back(w);
+                }
+            }
+        }
+
+        // 3. the boundary edges of the cavity, from va to vb with the outside triangle
+        edges.clear();
+        for (size_t c = 0; c < cavity.size(); c++)
+        {
+            int u = cavity[c];
+            for (int k = 0; k < 3; k++)
+            {
+                int w = tn[3 * u + k];
+                if (w >= 0 && stamp[w] == s + 1)
+                    continue;
+                edges.push_back(tv[3 * u + (k + 1) % 3]);
+                edges.push_back(tv[3 * u + (k + 2) % 3]);
+                edges.push_back(w);
+            }
+        }
+        for (size_t c = 0; c < cavity.size(); c++)
+        {
+            dead[cavity[c]] = 1;
+            free_tris.push_back(cavity[c]);
+        }
+
+        // 4. connect p to the boundary edges, reuse the dead triangles first
+        const int nb = (int)edges.size() / 3;
+        created.resize(nb);
+        for (int b = 0; b < nb; b++)
+        {
+            int nt;
+            if (!free_tris.empty())
+            {
+                nt = free_tris.back();
+                free_tris.pop_back();
+            }
+            else
+            {
+                nt = (int)stamp.size();
+                tv.resize(tv.size() + 3);
+                tn.resize(tn.size() + 3);
+                stamp.push_back(0);
+                dead.push_back(0);
+            }
+            int va = edges[3 * b], vb = edges[3 * b + 1], w = edges[3 * b + 2];
+            tv[3 * nt + 0] = va;
+            tv[3 * nt + 1] = vb;
+            tv[3 * nt + 2] = p;
+            tn[3 * nt + 2] = w;
+            dead[nt] = 0;
+            created[b] = nt;
+            start[va] = b;
+
+            // the outside triangle sees the edge from vb to va
+            if (w < 0)
+                continue;
+            for (int k = 0; k < 3; k++)
+            {
+                if (tv[3 * w + (k + 1) % 3] == vb && tv[3 * w + (k + 2) % 3] == va)
+                    tn[3 * w + k] = nt;
+            }
+        }
+
+        // 5. the edge from vb to p is shared with the triangle starting at vb
+        for (int b = 0; b < nb; b++)
+        {
+            int nt = created[b];
+            int next = created[start[edges[3 * b + 1]]];
+            tn[3 * nt + 0] = next;
+            tn[3 * next + 1] = nt;
+        }
+        last = created[0];
+    }
+
+    // 6. the neighbors of each site, every directed edge appears once
+    const int nt = (int)stamp.size();
+    std::vector<char> alive(n, 0);
+    m_neighbor_offsets.assign(n + 1, 0);
+    for (int t = 0; t < nt; t++)
+    {
+        if (dead[t])
+            continue;
+        for (int k = 0; k < 3; k++)
+        {
+            int a = tv[3 * t + k], b = tv[3 * t + (k + 1) % 3];
+            if (a < n)
+                alive[a] = 1;
+            if (a < n && b < n)
+                m_neighbor_offsets[a + 1]++;
+        }
+    }
+    for (int i = 0; i < n; i++)
+        m_neighbor_offsets[i + 1] += m_neighbor_offsets[i];
+    m_neighbors.resize(m_neighbor_offsets[n]);
+    std::vector<int> fill(m_neighbor_offsets.begin(), m_neighbor_offsets.end() - 1);
+    for (int t = 0; t < nt; t++)
+    {
+        if (dead[t])
+            continue;
+        for (int k = 0; k < 3; k++)
+        {
+            int a = tv[3 * t + k], b = tv[3 * t + (k + 1) % 3];
+            if (a < n && b < n)
+                m_neighbors[fill[a]++] = b;
+        }
+    }
+
+    for (int i = 0; i < n; i++)
+    {
+        if (!alive[i])
+            return false;
+    }
+    return true;
+}
+
+double MeshLib::CDiskOptimalTransport::_compute_cells(const std::vector<double>& weight)
+{
+    const int n = (int)m_site.size();
+    const double inner = cos(M_PI / m_segments);
+    const double sector = 2.0 * M_PI / m_segments;
+
+    // a hidden site has an empty cell
+    if (!_triangulate(weight))
+        return 0;
+
+    double min_area = DBL_MAX;
+
+#pragma omp parallel
+    {
+        std::vector<double> px, py, qx, qy;
+        std::vector<int> pl, ql, segments;
+        double local_min = DBL_MAX;
+
+#pragma omp for schedule(dynamic, 64)
+        for (int i = 0; i < n; i++)
+        {
+            const double xi = m_site[i][0], yi = m_site[i][1];
+            const double ni = xi * xi + yi * yi;
+
+            // 1. start from a box containing the disk
+            double bx[4] = { -2, 2, 2, -2 }, by[4] = { -2, -2, 2, 2 };
+            px.assign(bx, bx + 4);
+            py.assign(by, by + 4);
+            pl.assign(4, -1);
+
+            // 2. clip by the bisectors of the neighbors in the regular triangulation,
+            //    |x - y_i|^2 - w_i <= |x - y_j|^2 - w_j
+            for (int k = m_neighbor_offsets[i]; k < m_neighbor_offsets[i + 1] && !px.empty(); k++)
+            {
+                int j = m_neighbors[k];
+                double dx = m_site[j][0] - xi, dy = m_site[j][1] - yi;
+                double nj = m_site[j][0] * m_site[j][0] + m_site[j][1] * m_site[j][1];
+                _clip_polygon(px, py, pl, qx, qy, ql, 2 * dx, 2 * dy, nj - ni - weight[j] + weight[i], j);
+            }
+
+            // 3. clip by the segments of the disk polygon, only the segments
+            //    violated by some vertex can cut the convex cell
+            segments.clear();
+            for (size_t k = 0; k < px.size(); k++)
+            {
+                double norm = sqrt(px[k] * px[k] + py[k] * py[k]);
+                if (norm <= inner)
+                    continue;
+                double theta = atan2(py[k], px[k]);
+                double delta = acos(inner / norm);
+                int lo = (int)ceil((theta - delta) / sector - 0.5);
+                int hi = (int)floor((theta + delta) / sector - 0.5);
+                for (int s = lo; s <= hi; s++)
+                    segments.push_back(((s % m_segments) + m_segments) % m_segments);
+            }
+            std::sort(segments.begin(), segments.end());
+            segments.erase(std::unique(segments.begin(), segments.end()), segments.end());
+            for (size_t k = 0; k < segments.size() && !px.empty(); k++)
+            {
+                CPoint2& nk = m_normals[segments[k]];
+                _clip_polygon(px, py, pl, qx, qy, ql, nk[0], nk[1], inner, -2);
+            }
+
+            // 4. area, centroid and the Hessian coefficients
+            const int m = (int)px.size();
+            double area = 0, cx = 0, cy = 0;
+            std::vector<std::pair<int, double>>& adjacency = m_adjacency[i];
+            adjacency.clear();
+            for (int k = 0; k < m; k++)
+            {
+                int next = (k + 1 < m) ? k + 1 : 0;
+                double cross = px[k] * py[next] - px[next] * py[k];
+                area += cross;
+                cx += (px[k] + px[next]) * cross;
+                cy += (py[k] + py[next]) * cross;
+
+                int j = pl[k];
+                if (j < 0)
+                    continue;
+                double ex = px[next] - px[k], ey = py[next] - py[k];
+                double dx = m_site[j][0] - xi, dy = m_site[j][1] - yi;
+                adjacency.push_back(std::pair<int, double>(j, sqrt(ex * ex + ey * ey) / (2.0 * sqrt(dx * dx + dy * dy))));
+            }
+            area /= 2.0;
+            m_area[i] = area;
+            m_centroid[i] = (area > 0) ? CPoint2(cx / (6.0 * area), cy / (6.0 * area)) : m_site[i];
+            local_min = (area < local_min) ? area : local_min;
+        }
+
+#pragma omp critical
+        min_area = (local_min < min_area) ? local_min : min_area;
+    }
+    return min_area;
+}
+
+double MeshLib::CDiskOptimalTransport::_error(double& l2)
+{
+    const int n = (int)m_site.size();
+
+    double l1 = 0, sum = 0;
+    for (int i = 0; i < n; i++)
+    {
+        double d = m_area[i] - m_mass[i];
+        l1 += fabs(d);
+        sum += d * d;
+    }
+    l2 = sqrt(sum);
+    return l1 / m_disk_area;
+}
+
+int MeshLib::CDiskOptimalTransport::solve(double epsilon, int max_steps)
+{
+    const int n = (int)m_site.size();
+    if (n < 2)
+        return 0;
+
+    // the cells must keep a positive area during the damped steps
+    double min_mass = DBL_MAX;
+    for (int i = 0; i < n; i++)
+        min_mass = (m_mass[i] < min_mass) ? m_mass[i] : min_mass;
+    double min_area = _compute_cells(m_weight);
+    if (min_area <= 0)
+    {
+        std::cerr << "Empty power cell, duplicated sites?" << std::endl;
+        return -1;
+    }
+    const double threshold = 0.5 * std::min(min_area, min_mass);
+
+    std::vector<double> trial(n);
+    Eigen::VectorXd b(n - 1);
+    Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> solver;
+
+    int step = 0;
+    for (; step < max_steps; step++)
+    {
+        double l2;
+        double error = _error(l2);
+        printf("Current area error is %g\n", error);
+        if (error < epsilon)
+            break;
+
+        // Hessian of the cell areas, the weight of site 0 is fixed
+        std::vector<Eigen::Triplet<double>> coefficients;
+        coefficients.reserve(7 * n);
+        for (int i = 1; i < n; i++)
+        {
+            double sum = 0;
+            for (size_t k = 0; k < m_adjacency[i].size(); k++)
+            {
+                int j = m_adjacency[i][k].first;
+                double c = m_adjacency[i][k].second;
+                sum += c;
+                if (j > 0)
+                    coefficients.push_back(Eigen::Triplet<double>(i - 1, j - 1, -c));
+            }
+            coefficients.push_back(Eigen::Triplet<double>(i - 1, i - 1, sum));
+            b[i - 1] = m_mass[i] - m_area[i];
+        }
+        Eigen::SparseMatrix<double> H(n - 1, n - 1);
+        H.setFromTriplets(coefficients.begin(), coefficients.end());
+
+        solver.compute(H);
+        if (solver.info() != Eigen::Success)
+        {
+            std::cerr << "Hessian factorization failed!" << std::endl;
+            return -1;
+        }
+        Eigen::VectorXd dw = solver.solve(b);
+
+        // damping, keep the cells large enough and decrease the error
+        bool accepted = false;
+        for (double t = 1.0; t > 1e-6; t /= 2.0)
+        {
+            trial[0] = m_weight[0];
+            for (int i = 1; i < n; i++)
+                trial[i] = m_weight[i] + t * dw[i - 1];
+
+            if (_compute_cells(trial) < threshold)
+                continue;
+
+            double trial_l2;
+            _error(trial_l2);
+            if (trial_l2 <= (1.0 - t / 2.0) * l2)
+            {
+                accepted = true;
+                break;
+            }
+        }
+        if (!accepted)
+        {
+            _compute_cells(m_weight);
+            std::cerr << "Damped Newton step failed!" << std::endl;
+            return -1;
+        }
+        m_weight.swap(trial);
+    }
+    return step;
+}
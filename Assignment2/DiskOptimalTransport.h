@@ -0,0 +1,131 @@
+#ifndef _DISK_OPTIMAL_TRANSPORT_H_
+#define _DISK_OPTIMAL_TRANSPORT_H_
+
+#include <vector>
+
+#include "Geometry/Point2.h"
+
+namespace MeshLib
+{
+
+/*! \brief CDiskOptimalTransport class
+ *
+ *   Semi-discrete optimal transport from the uniform measure on the unit
+ *   disk to weighted sites. The disk is partitioned by the power diagram
+ *   of the sites, the power weights are solved by damped Newton's method
+ *   (Kitagawa, Merigot and Thibert) such that the area of each cell equals
+ *   the mass of its site. The disk is approximated by a regular polygon.
+ *
+ *   The neighbors of the power cells are found by the regular triangulation
+ *   of the sites, built incrementally in the order of a uniform grid. Then
+ *   each power cell is computed independently, by clipping a box with the
+ *   bisectors of its neighbors and the segments of the disk polygon.
+ */
+class CDiskOptimalTransport
+{
+  public:
+    /*!
+     *  CDiskOptimalTransport constructor
+     *  \param segments number of segments of the disk polygon
+     */
+    CDiskOptimalTransport(int segments = 1024);
+
+    /*!
+     *  Set the sites and their masses
+     *  \param sites positions of the sites in the unit disk
+     *  \param mass  masses of the sites, scaled to the area of the disk
+     */
+    void set_sites(const std::vector<CPoint2>& sites, const std::vector<double>& mass);
+
+    /*!
+     *  Damped Newton's method
+     *  \param epsilon relative error threshold of the cell areas
+     *  \param max_steps maximal number of Newton steps
+     *  \return number of Newton steps, -1 if it fails
+     */
+    int solve(double epsilon = 1e-4, int max_steps = 64);
+
+    /*!
+     *  Relative l1 error of the cell areas under the current weights
+     */
+    double error()
+    {
+        double l2;
+        return _error(l2);
+    };
+
+    /*!
+     *  Area of the disk polygon
+     */
+    double disk_area() { return m_disk_area; };
+
+    /*!
+     *  Centroids of the power cells
+     */
+    std::vector<CPoint2>& centroids() { return m_centroid; };
+
+    /*!
+     *  Power weights of the sites
+     */
+    std::vector<double>& weights() { return m_weight; };
+
+  protected:
+    /*!
+     *  Sort the sites by the buckets of a uniform grid, row by row in a snake order
+     */
+    void _sort_sites();
+
+    /*!
+     *  Regular triangulation of the weighted sites, Bowyer-Watson algorithm
+     *  inside a super triangle. The neighbors of the hidden sites are empty.
+     *  \param weight power weights
+     *  \return false if some site is hidden
+     */
+    bool _triangulate(const std::vector<double>& weight);
+
+    /*!
+     *  Compute the areas, centroids and adjacency of all the power cells
+     *  \param weight power weights
+     *  \return the minimal cell area, zero if some site is hidden
+     */
+    double _compute_cells(const std::vector<double>& weight);
+
+    /*!
+     *  Relative l1 error and l2 norm of the area differences
+     *  \param l2 output l2 norm
+     *  \return relative l1 error
+     */
+    double _error(double& l2);
+
+  protected:
+    /*! number of segments of the disk polygon */
+    int m_segments;
+
+    /*! area of the disk polygon */
+    double m_disk_area;
+
+    /*! outer normals of the segments of the disk polygon */
+    std::vector<CPoint2> m_normals;
+
+    /*! sites and their masses */
+    std::vector<CPoint2> m_site;
+    std::vector<double> m_mass;
+
+    /*! power weights */
+    std::vector<double> m_weight;
+
+    /*! areas and centroids of the power cells */
+    std::vector<double> m_area;
+    std::vector<CPoint2> m_centroid;
+
+    /*! offsets and sites of the neighbors in the regular triangulation */
+    std::vector<int> m_neighbor_offsets, m_neighbors;
+
+    /*! neighbors of each cell, and the Hessian coefficients, |edge| / (2 |y_i - y_j|) */
+    std::vector<std::vector<std::pair<int, double>>> m_adjacency;
+
+    /*! insertion order of the sites, bucket by bucket of a uniform grid */
+    std::vector<int> m_order;
+};
+}
+#endif // !_DISK_OPTIMAL_TRANSPORT_H_
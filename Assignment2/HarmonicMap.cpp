@@ -1,5 +1,6 @@
 #include <math.h>
 #include <float.h>
+#include <vector>
 
 #include <Eigen/Sparse>
 
@@ -9,15 +10,23 @@
 #define M_PI 3.141592653589793238462643383279
 #endif
 
-void MeshLib::CHarmonicMap::set_mesh(CHarmonicMapMesh* pMesh)
+bool MeshLib::CHarmonicMap::set_mesh(CHarmonicMapMesh* pMesh)
 {
     m_pMesh = pMesh;
     
     // 1. compute the weights of edges
-    _calculate_edge_weight();
+    if (!_calculate_edge_weight())
+    {
+        m_pMesh = NULL;
+        return false;
+    }
 
     // 2. map the boundary to unit circle
-    _set_boundary();
+    if (!_set_boundary())
+    {
+        m_pMesh = NULL;
+        return false;
+    }
 
     // 3. initialize the map of interior vertices to (0, 0)
     using M = CHarmonicMapMesh;
@@ -26,8 +35,9 @@ void MeshLib::CHarmonicMap::set_mesh(CHarmonicMapMesh* pMesh)
         M::CVertex* pV = *viter;
         if (pV->boundary())
             continue;
-		//insert your code here
+        pV->uv() = CPoint2(0, 0);
     }
+    return true;
 }
 
 double MeshLib::CHarmonicMap::step_one() 
@@ -54,7 +64,9 @@ double MeshLib::CHarmonicMap::step_one()
         {
             M::CVertex* pW = *vviter;
             M::CEdge* pE = m_pMesh->vertexEdge(pV, pW);
-			//insert your code here
+            double w = pE->weight();
+            sw += w;
+            suv += pW->uv() * w;
         }
         suv /= sw;
 
@@ -86,12 +98,12 @@ void MeshLib::CHarmonicMap::iterative_map(double epsilon)
     }
 }
 
-void MeshLib::CHarmonicMap::map() 
+bool MeshLib::CHarmonicMap::map() 
 {
     if (!m_pMesh)
     {
         std::cerr << "Should set mesh first!" << std::endl;
-        return;
+        return false;
     }
 
     using M = CHarmonicMapMesh;
@@ -132,12 +144,13 @@ void MeshLib::CHarmonicMap::map()
             M::CEdge* e = m_pMesh->vertexEdge(pV, pW);
             double w = e->weight();
 
-			//insert your code here
-			//construct one element of the matrix A and B, using 
-			//Eigen::Triplet<double>(i,j, val)
-			//there push_back the triplet to A or B coefficients
+            sw += w;
+            if (pW->boundary())
+                B_coefficients.push_back(Eigen::Triplet<double>(vid, wid, w));
+            else
+                A_coefficients.push_back(Eigen::Triplet<double>(vid, wid, -w));
         }
-		//insert the diagonal element
+        A_coefficients.push_back(Eigen::Triplet<double>(vid, vid, sw));
     }
 
     Eigen::SparseMatrix<double> A(interior_vertices, interior_vertices);
@@ -156,6 +169,7 @@ void MeshLib::CHarmonicMap::map()
     if (solver.info() != Eigen::Success)
     {
         std::cerr << "Waring: Eigen decomposition failed" << std::endl;
+        return false;
     }
 
     for (int k = 0; k < 2; k++)
@@ -178,6 +192,7 @@ void MeshLib::CHarmonicMap::map()
         if (solver.info() != Eigen::Success)
         {
             std::cerr << "Waring: Eigen decomposition failed" << std::endl;
+            return false;
         }
 
         // set the images of the harmonic map to interior vertices
@@ -190,55 +205,186 @@ void MeshLib::CHarmonicMap::map()
             pV->uv()[k] = x(id);
         }
     }
+    return true;
 }
 
-void MeshLib::CHarmonicMap::_calculate_edge_weight() 
+bool MeshLib::CHarmonicMap::_calculate_edge_weight() 
 {
     using M = CHarmonicMapMesh;
 
-    // 1. compute edge length
+    const int nv = m_pMesh->numVertices();
+    const int ne = m_pMesh->numEdges();
+    const int nf = m_pMesh->numFaces();
+
+    // 1. pack vertex positions into flat arrays, and index the edges
+    std::vector<double> px(nv), py(nv), pz(nv);
+    int vid = 0;
+    for (M::MeshVertexIterator viter(m_pMesh); !viter.end(); ++viter)
+    {
+        M::CVertex* pV = *viter;
+        CPoint& p = pV->point();
+        px[vid] = p[0];
+        py[vid] = p[1];
+        pz[vid] = p[2];
+        pV->idx() = vid++;
+    }
+
+    std::vector<M::CEdge*> edges(ne);
+    int eid = 0;
     for (M::MeshEdgeIterator eiter(m_pMesh); !eiter.end(); ++eiter)
     {
         M::CEdge* pE = *eiter;
-        M::CVertex* v1 = m_pMesh->edgeVertex1(pE);
-        M::CVertex* v2 = m_pMesh->edgeVertex2(pE);
-        pE->length() = (v1->point() - v2->point()).norm();
+        edges[eid] = pE;
+        pE->idx() = eid++;
     }
 
-    // 2. compute corner angle
+    // 2. pack face corners, corner k is the target of the k-th halfedge.
+    //    The halfedge of corner k is opposite to corner k + 1, so record
+    //    that slot on the edge side the halfedge occupies.
+    std::vector<int> fv(3 * nf);
+    std::vector<M::CHalfEdge*> fh(3 * nf);
+    std::vector<int> opposite(2 * ne, -1);
+    int fid = 0;
     for (M::MeshFaceIterator fiter(m_pMesh); !fiter.end(); ++fiter)
     {
         M::CFace* pF = *fiter;
-        M::CHalfEdge* pH[3];
-		//insert your code here
-		//use inverse cosine law to compute the corner angles
+        M::CHalfEdge* pH = m_pMesh->faceHalfedge(pF);
+        for (int k = 0; k < 3; k++)
+        {
+            int slot = 3 * fid + k;
+            fh[slot] = pH;
+            fv[slot] = m_pMesh->halfedgeTarget(pH)->idx();
+
+            M::CEdge* pE = m_pMesh->halfedgeEdge(pH);
+            int side = (m_pMesh->edgeHalfedge(pE, 0) == pH) ? 0 : 1;
+            opposite[2 * pE->idx() + side] = 3 * fid + (k + 1) % 3;
+
+            pH = m_pMesh->halfedgeNext(pH);
+        }
+        fid++;
     }
 
-    // 3. compute edge weight
-    for (M::MeshEdgeIterator eiter(m_pMesh); !eiter.end(); ++eiter)
+    // 3. gather the corner positions face by face (structure of arrays),
+    //    so that the kernel below streams through memory without
+    //    indirection and vectorizes across faces.
+    std::vector<double> cx[3], cy[3], cz[3];
+    for (int k = 0; k < 3; k++)
     {
-        M::CEdge* pE = *eiter;
-		//insert your code here
-		//set cotangent edge weight
+        cx[k].resize(nf);
+        cy[k].resize(nf);
+        cz[k].resize(nf);
+    }
+
+#pragma omp parallel for
+    for (int f = 0; f < nf; f++)
+    {
+        for (int k = 0; k < 3; k++)
+        {
+            const int i = fv[3 * f + k];
+            cx[k][f] = px[i];
+            cy[k][f] = py[i];
+            cz[k][f] = pz[i];
+        }
+    }
+
+    // 4. face kernel: cotangent of each corner from dot and cross
+    //    products, length of the edge of each halfedge. Only +, *, /
+    //    and sqrt, so the loop vectorizes across faces. A face with a
+    //    zero cross product has no cotangent, count them and reject
+    //    the mesh before any NaN reaches the weights.
+    std::vector<double> cot(3 * nf), dot(3 * nf), cross(3 * nf), length(3 * nf);
+    int degenerate = 0;
+
+    for (int k = 0; k < 3; k++)
+    {
+        const double* xi = cx[k].data();
+        const double* yi = cy[k].data();
+        const double* zi = cz[k].data();
+        const double* xj = cx[(k + 1) % 3].data();
+        const double* yj = cy[(k + 1) % 3].data();
+        const double* zj = cz[(k + 1) % 3].data();
+        const double* xl = cx[(k + 2) % 3].data();
+        const double* yl = cy[(k + 2) % 3].data();
+        const double* zl = cz[(k + 2) % 3].data();
+        double* pcot = cot.data();
+        double* pdot = dot.data();
+        double* pcross = cross.data();
+        double* plength = length.data();
+
+#pragma omp parallel for simd reduction(+ : degenerate)
+        for (int f = 0; f < nf; f++)
+        {
+            // edge vectors from corner vertex i to the other two vertices
+            const double ax = xj[f] - xi[f], ay = yj[f] - yi[f], az = zj[f] - zi[f];
+            const double bx = xl[f] - xi[f], by = yl[f] - yi[f], bz = zl[f] - zi[f];
+
+            const double d = ax * bx + ay * by + az * bz;
+            const double nx = ay * bz - az * by;
+            const double ny = az * bx - ax * bz;
+            const double nz = ax * by - ay * bx;
+            const double c = sqrt(nx * nx + ny * ny + nz * nz);
+
+            degenerate += (c > 0) ? 0 : 1;
+            pcot[3 * f + k] = d / ((c > 0) ? c : 1);
+            pdot[3 * f + k] = d;
+            pcross[3 * f + k] = c;
+            // halfedge k goes from vertex l to vertex i
+            plength[3 * f + k] = sqrt(bx * bx + by * by + bz * bz);
+        }
+    }
+
+    if (degenerate > 0)
+    {
+        std::cerr << "Degenerate mesh! " << degenerate << " corners of zero area faces" << std::endl;
+        return false;
+    }
+
+    // 5. corner angles in their own pass, atan2 does not vectorize, each
+    //    halfedge belongs to one face
+#pragma omp parallel for
+    for (int c = 0; c < 3 * nf; c++)
+    {
+        fh[c]->angle() = atan2(cross[c], dot[c]);
     }
+
+    // 6. gather edge length and cotangent weight from the opposite corners
+#pragma omp parallel for
+    for (int e = 0; e < ne; e++)
+    {
+        M::CEdge* pE = edges[e];
+        const int c0 = opposite[2 * e + 0];
+        const int c1 = opposite[2 * e + 1];
+
+        double w = cot[c0];
+        if (c1 >= 0)
+            w += cot[c1];
+
+        pE->length() = length[(c0 / 3) * 3 + (c0 + 2) % 3];
+        pE->weight() = 0.5 * w;
+    }
+    return true;
 }
 
-void MeshLib::CHarmonicMap::_set_boundary() 
+bool MeshLib::CHarmonicMap::_set_boundary() 
 {
     using M = CHarmonicMapMesh;
 
-    // 1. get the boundary half edge loop
-    M::CBoundary boundary(m_pMesh);
-    std::vector<M::CLoop*>& pLs = boundary.loops();
-    if (pLs.size() != 1)
+    // 1. check the topology before tracing the boundary loop
+    M::CTopology topology(m_pMesh);
+    if (!topology.is_disk())
     {
-        std::cerr << "Only topological disk accepted!" << std::endl;
-        exit(EXIT_FAILURE);
+        std::cerr << "Only topological disk accepted! " << topology.components().size() << " components, genus "
+                  << topology.genus() << ", " << topology.boundaries() << " boundaries" << std::endl;
+        return false;
     }
+
+    // 2. get the boundary half edge loop
+    M::CBoundary boundary(m_pMesh);
+    std::vector<M::CLoop*>& pLs = boundary.loops();
     M::CLoop* pL = pLs[0];
     std::list<M::CHalfEdge*>& pHs = pL->halfedges();
     
-    // 2. compute the total length of the boundary
+    // 3. compute the total length of the boundary
     double sum = 0.0;
     std::list<M::CHalfEdge*>::iterator it;
     for (it = pHs.begin(); it != pHs.end(); ++it)
@@ -247,7 +393,7 @@ void MeshLib::CHarmonicMap::_set_boundary()
         sum += m_pMesh->halfedgeEdge(pH)->length();
     }
 
-    // 3. parameterize the boundary using arc length parameter
+    // 4. parameterize the boundary using arc length parameter
     double len = 0.0;
     for (it = pHs.begin(); it != pHs.end(); ++it)
     {
@@ -258,11 +404,5 @@ void MeshLib::CHarmonicMap::_set_boundary()
         double angle = len / sum * 2.0 * M_PI;
         pV->uv() = CPoint2(cos(angle), sin(angle)); 
     }
-}
-
-double MeshLib::CHarmonicMap::_inverse_cosine_law(double a, double b, double c) 
-{ 
-    double cs = (a * a + b * b - c * c) / (2.0 * a * b);
-    assert(cs <= 1.0 && cs >= -1.0);
-    return std::acos(cs);
+    return true;
 }
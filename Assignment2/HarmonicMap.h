@@ -19,49 +19,58 @@ class CHarmonicMap
      */
     CHarmonicMap() : m_pMesh(NULL) {};
 
+    /*!
+     *  CHarmonicMap destructor
+     */
+    virtual ~CHarmonicMap() {};
+
     /*!
      *  Set mesh and initialization 
      *  \param pMesh input mesh
+     *  \return false if the mesh is not a topological disk
      */
-    void set_mesh(CHarmonicMapMesh* pMesh);
+    virtual bool set_mesh(CHarmonicMapMesh* pMesh);
 
     /*! 
      *  Take next one step
      *  \return maximal error of current step 
      */
-    double step_one();
+    virtual double step_one();
 
     /*!
-     *  Iterative meshod
+     *  Iterative meshod, takes steps until it converges
      *  \param epsilon error threshold
      */
     void iterative_map(double epsilon = 1e-5);
     
     /*!
      *  Directly solving the harmonic map
+     *  \return false if the equations are not solved
      */
-    void map();
+    bool map();
 
   protected:
     /*!
-     *  Compute edge weight
+     *  Compute edge length, corner angle and cotangent edge weight.
+     *
+     *  Vertex positions and face corners are first packed into flat
+     *  arrays, then each face computes the cotangents of its three
+     *  corners from dot and cross products, and the corner angles take
+     *  their atan2 in a separate pass. Every corner slot is owned by
+     *  exactly one face, and every edge gathers the two slots opposite
+     *  to it, so no atomics are needed when the face loop runs in
+     *  parallel.
+     *  \return false if a face has zero area
      */
-    void _calculate_edge_weight();
+    bool _calculate_edge_weight();
 
     /*!	
      *  Fix the boundary vertices to the unit circle
      *  using arc length parameter
+     *  \return false if there is not exactly one boundary loop
      */
-    void _set_boundary();
+    bool _set_boundary();
 
-    /*! 
-     * Compute angle using cosine law
-     * \param a first edge length
-     * \param b second edge length 
-     * \param c third edge length
-     * \return angle between 1st and 2nd edges
-     */
-    double _inverse_cosine_law(double a, double b, double c);
   protected:
     /*!
      * The input surface mesh
@@ -8,6 +8,7 @@
 #include "Mesh/Vertex.h"
 
 #include "Mesh/Boundary.h"
+#include "Mesh/Topology.h"
 #include "Mesh/Iterators.h"
 #include "Parser/parser.h"
 
@@ -37,34 +38,52 @@ class CHarmonicMapVertex : public CVertex
     /*! Vertex color */
     CPoint& rgb() { return m_rgb; };
 
+    /*! Vertex image on the unit sphere */
+    CPoint& image() { return m_image; };
+
     /*!
      *	Read vertex traits to vertex string
      */
     void _from_string();
 
+    /*!
+     *	Write vertex uv to vertex string
+     */
+    void _to_string();
+
   protected:
     /*! Vertex index */
     int m_index;
 
     /*! Vertex color */
     CPoint m_rgb;
+
+    /*! Vertex image on the unit sphere */
+    CPoint m_image;
 };
 
 inline void CHarmonicMapVertex::_from_string()
 {
     CParser parser(m_string);
-    for (std::list<CToken*>::iterator iter = parser.tokens().begin(); 
-         iter != parser.tokens().end(); ++iter)
+    const CTokenView* token = parser.find("rgb");
+    if (token != NULL)
     {
-        CToken* token = *iter;
-
-        if (token->m_key == "rgb")
-        {
-            token->m_value >> m_rgb;
-        }
+        double v[3] = {0, 0, 0};
+        token->numbers(v, 3);
+        m_rgb = CPoint(v[0], v[1], v[2]);
     }
 }
 
+inline void CHarmonicMapVertex::_to_string()
+{
+    CParser parser(m_string);
+    parser._removeToken("uv");
+    parser._toString(m_string);
+
+    double v[2] = {m_uv[0], m_uv[1]};
+    CParser::_appendToken(m_string, "uv", v, 2);
+}
+
 
 /*! \brief CHarmonicMapEdge class
  *
@@ -75,7 +94,10 @@ class CHarmonicMapEdge : public CEdge
 {
   public:
     /*! Constructor */
-    CHarmonicMapEdge() : m_length(0), m_weight(0) {};
+    CHarmonicMapEdge() : m_index(0), m_length(0), m_weight(0) {};
+
+    /*! Edge index */
+    int& idx() { return m_index; };
 
     /*!	Edge weight */
     double& weight() { return m_weight; };
@@ -84,6 +106,9 @@ class CHarmonicMapEdge : public CEdge
     double& length() { return m_length; };
     
   protected:
+    /*! Edge index */
+    int m_index;
+
     /*!	Edge weight */
     double m_weight;
 
@@ -143,6 +168,7 @@ class THarmonicMapMesh : public CBaseMesh<V, E, F, H>
 
     typedef CBoundary<V, E, F, H>                   CBoundary;
     typedef CLoop<V, E, F, H>                       CLoop;
+    typedef CTopology<V, E, F, H>                   CTopology;
 
     typedef MeshVertexIterator<V, E, F, H>          MeshVertexIterator;
     typedef MeshEdgeIterator<V, E, F, H>            MeshEdgeIterator;
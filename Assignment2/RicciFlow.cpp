@@ -0,0 +1,440 @@
+#include <math.h>
+#include <float.h>
+#include <algorithm>
+#include <queue>
+
+#include "RicciFlow.h"
+
+#ifndef M_PI
+#define M_PI 3.141592653589793238462643383279
+#endif
+
+bool MeshLib::CRicciFlow::set_mesh(CHarmonicMapMesh* pMesh)
+{
+    using M = CHarmonicMapMesh;
+
+    // 1. only topological disks, one component of genus zero with one boundary
+    m_pMesh = NULL;
+    M::CTopology topology(pMesh);
+    if (!topology.is_disk())
+    {
+        std::cerr << "Only topological disk accepted! " << topology.components().size() << " components, genus "
+                  << topology.genus() << ", " << topology.boundaries() << " boundaries" << std::endl;
+        return false;
+    }
+    m_pMesh = pMesh;
+
+    const int nv = pMesh->numVertices();
+    const int ne = pMesh->numEdges();
+    const int nf = pMesh->numFaces();
+
+    // 2. index the vertices and edges, store the initial lengths
+    m_verts.resize(nv);
+    m_boundary.resize(nv);
+    int vid = 0;
+    for (M::MeshVertexIterator viter(pMesh); !viter.end(); ++viter)
+    {
+        M::CVertex* pV = *viter;
+        pV->idx() = vid;
+        m_verts[vid] = pV;
+        m_boundary[vid] = pV->boundary() ? 1 : 0;
+        vid++;
+    }
+
+    m_edges.resize(ne);
+    m_edge_vertex.resize(2 * ne);
+    m_edge_corner.assign(2 * ne, -1);
+    m_length0.resize(ne);
+    int eid = 0;
+    for (M::MeshEdgeIterator eiter(pMesh); !eiter.end(); ++eiter)
+    {
+        M::CEdge* pE = *eiter;
+        pE->idx() = eid;
+        m_edges[eid] = pE;
+        M::CHalfEdge* pH = pMesh->edgeHalfedge(pE, 0);
+        m_edge_vertex[2 * eid + 0] = pMesh->halfedgeSource(pH)->idx();
+        m_edge_vertex[2 * eid + 1] = pMesh->halfedgeTarget(pH)->idx();
+        m_length0[eid] = pMesh->edgeLength(pE);
+        eid++;
+    }
+
+    // 3. pack the face corners, the k-th corner is the target of the k-th halfedge
+    m_halfedges.resize(3 * nf);
+    m_corner_vertex.resize(3 * nf);
+    m_corner_edge.resize(3 * nf);
+    int fid = 0;
+    for (M::MeshFaceIterator fiter(pMesh); !fiter.end(); ++fiter)
+    {
+        M::CFace* pF = *fiter;
+        M::CHalfEdge* pH = pMesh->faceHalfedge(pF);
+        for (int k = 0; k < 3; k++)
+        {
+            m_halfedges[3 * fid + k] = pH;
+            m_corner_vertex[3 * fid + k] = pMesh->halfedgeTarget(pH)->idx();
+            pH = pMesh->halfedgeNext(pH);
+        }
+        for (int k = 0; k < 3; k++)
+        {
+            pH = m_halfedges[3 * fid + k];
+            M::CEdge* pE = pMesh->halfedgeEdge(pH);
+            int side = (pMesh->edgeHalfedge(pE, 0) == pH) ? 0 : 1;
+            m_corner_edge[3 * fid + (k + 1) % 3] = pE->idx();
+            m_edge_corner[2 * pE->idx() + side] = 3 * fid + (k + 1) % 3;
+        }
+        fid++;
+    }
+
+    // 4. corners and edges around each vertex, by counting sort
+    m_vertex_offsets.assign(nv + 1, 0);
+    for (int c = 0; c < 3 * nf; c++)
+        m_vertex_offsets[m_corner_vertex[c] + 1]++;
+    for (int i = 0; i < nv; i++)
+        m_vertex_offsets[i + 1] += m_vertex_offsets[i];
+    m_vertex_corners.resize(3 * nf);
+    std::vector<int> fill(m_vertex_offsets.begin(), m_vertex_offsets.end() - 1);
+    for (int c = 0; c < 3 * nf; c++)
+        m_vertex_corners[fill[m_corner_vertex[c]]++] = c;
+
+    m_edge_offsets.assign(nv + 1, 0);
+    for (int e = 0; e < 2 * ne; e++)
+        m_edge_offsets[m_edge_vertex[e] + 1]++;
+    for (int i = 0; i < nv; i++)
+        m_edge_offsets[i + 1] += m_edge_offsets[i];
+    m_vertex_edges.resize(2 * ne);
+    fill.assign(m_edge_offsets.begin(), m_edge_offsets.end() - 1);
+    for (int e = 0; e < 2 * ne; e++)
+        m_vertex_edges[fill[m_edge_vertex[e]]++] = e / 2;
+
+    // 5. target curvatures, zero inside, proportional to the boundary length on the boundary
+    m_target.assign(nv, 0.0);
+    double total = 0;
+    for (int e = 0; e < ne; e++)
+    {
+        if (m_edge_corner[2 * e + 1] >= 0)
+            continue;
+        m_target[m_edge_vertex[2 * e + 0]] += m_length0[e] / 2.0;
+        m_target[m_edge_vertex[2 * e + 1]] += m_length0[e] / 2.0;
+        total += m_length0[e];
+    }
+    for (int i = 0; i < nv; i++)
+        m_target[i] *= 2.0 * M_PI / total;
+
+    // 6. the Hessian pattern, the factor of one boundary vertex is fixed
+    m_pinned = 0;
+    while (!m_boundary[m_pinned])
+        m_pinned++;
+    m_unknown.resize(nv);
+    int nu = 0;
+    for (int i = 0; i < nv; i++)
+        m_unknown[i] = (i == m_pinned) ? -1 : nu++;
+
+    std::vector<Eigen::Triplet<double>> coefficients;
+    for (int i = 0; i < nv; i++)
+    {
+        if (m_unknown[i] >= 0)
+            coefficients.push_back(Eigen::Triplet<double>(m_unknown[i], m_unknown[i], 0.0));
+    }
+    for (int e = 0; e < ne; e++)
+    {
+        int a = m_unknown[m_edge_vertex[2 * e + 0]];
+        int b = m_unknown[m_edge_vertex[2 * e + 1]];
+        if (a < 0 || b < 0)
+            continue;
+        coefficients.push_back(Eigen::Triplet<double>(a, b, 0.0));
+        coefficients.push_back(Eigen::Triplet<double>(b, a, 0.0));
+    }
+    m_hessian.resize(nu, nu);
+    m_hessian.setFromTriplets(coefficients.begin(), coefficients.end());
+    m_hessian.makeCompressed();
+
+    // locate the value slot of each entry, the rows are sorted in each column
+    const int* outer = m_hessian.outerIndexPtr();
+    const int* inner = m_hessian.innerIndexPtr();
+    auto slot = [&](int row, int col) -> int {
+        return (int)(std::lower_bound(inner + outer[col], inner + outer[col + 1], row) - inner);
+    };
+    m_diag_slots.resize(nu);
+    for (int i = 0; i < nu; i++)
+        m_diag_slots[i] = slot(i, i);
+    m_offdiag_slots.assign(2 * ne, -1);
+    for (int e = 0; e < ne; e++)
+    {
+        int a = m_unknown[m_edge_vertex[2 * e + 0]];
+        int b = m_unknown[m_edge_vertex[2 * e + 1]];
+        if (a < 0 || b < 0)
+            continue;
+        m_offdiag_slots[2 * e + 0] = slot(a, b);
+        m_offdiag_slots[2 * e + 1] = slot(b, a);
+    }
+
+    m_solver.analyzePattern(m_hessian);
+
+    m_u.assign(nv, 0.0);
+    m_length.resize(ne);
+    m_angle.resize(3 * nf);
+    m_cot.resize(3 * nf);
+    m_curvature.resize(nv);
+    return true;
+}
+
+int MeshLib::CRicciFlow::map(double epsilon, int max_steps)
+{
+    if (!m_pMesh)
+    {
+        std::cerr << "Should set mesh first!" << std::endl;
+        return 0;
+    }
+
+    const int nv = (int)m_verts.size();
+    const int nu = (int)m_hessian.rows();
+
+    if (!_calculate_metric(m_u))
+    {
+        std::cerr << "Degenerate triangles in the input mesh!" << std::endl;
+        return 0;
+    }
+
+    int step = 0;
+    std::vector<double> trial(nv);
+    Eigen::VectorXd b(nu);
+    for (; step < max_steps; step++)
+    {
+        double l2;
+        double max_error = _curvature_error(l2);
+        printf("Current max error is %g\n", max_error);
+        if (max_error < epsilon)
+            break;
+
+        // Newton direction, H du = K_target - K
+        _fill_hessian();
+        m_solver.factorize(m_hessian);
+        if (m_solver.info() != Eigen::Success)
+        {
+            std::cerr << "Hessian factorization failed!" << std::endl;
+            break;
+        }
+        for (int i = 0; i < nv; i++)
+        {
+            if (m_unknown[i] >= 0)
+                b[m_unknown[i]] = m_target[i] - m_curvature[i];
+        }
+        Eigen::VectorXd du = m_solver.solve(b);
+
+        // halve the step until the triangle inequality holds and the error decreases
+        bool accepted = false;
+        for (double t = 1.0; t > 1e-4; t /= 2.0)
+        {
+            for (int i = 0; i < nv; i++)
+                trial[i] = (m_unknown[i] >= 0) ? m_u[i] + t * du[m_unknown[i]] : m_u[i];
+
+            if (!_calculate_metric(trial))
+                continue;
+
+            double trial_l2;
+            _curvature_error(trial_l2);
+            if (trial_l2 < l2)
+            {
+                accepted = true;
+                break;
+            }
+        }
+        if (!accepted)
+        {
+            _calculate_metric(m_u);
+            break;
+        }
+        m_u.swap(trial);
+    }
+
+    _embed();
+    _write_traits();
+    return step;
+}
+
+bool MeshLib::CRicciFlow::_calculate_metric(const std::vector<double>& u)
+{
+    const int ne = (int)m_length0.size();
+    const int nf = (int)m_corner_vertex.size() / 3;
+    const int nv = (int)m_verts.size();
+
+#pragma omp parallel for
+    for (int e = 0; e < ne; e++)
+    {
+        m_length[e] = m_length0[e] * exp((u[m_edge_vertex[2 * e + 0]] + u[m_edge_vertex[2 * e + 1]]) / 2.0);
+    }
+
+    // cosine law by the edge lengths, cot = (b^2 + c^2 - a^2) / 4A
+    int invalid = 0;
+#pragma omp parallel for reduction(+ : invalid)
+    for (int f = 0; f < nf; f++)
+    {
+        double l[3];
+        for (int k = 0; k < 3; k++)
+            l[k] = m_length[m_corner_edge[3 * f + k]];
+
+        double s = (l[0] + l[1] + l[2]) * (-l[0] + l[1] + l[2]) * (l[0] - l[1] + l[2]) * (l[0] + l[1] - l[2]);
+        if (s <= 0)
+        {
+            invalid++;
+            continue;
+        }
+        double area4 = sqrt(s);
+        for (int k = 0; k < 3; k++)
+        {
+            double a = l[k], b = l[(k + 1) % 3], c = l[(k + 2) % 3];
+            double d = b * b + c * c - a * a;
+            m_cot[3 * f + k] = d / area4;
+            m_angle[3 * f + k] = atan2(area4, d);
+        }
+    }
+    if (invalid > 0)
+        return false;
+
+#pragma omp parallel for
+    for (int i = 0; i < nv; i++)
+    {
+        double sum = 0;
+        for (int j = m_vertex_offsets[i]; j < m_vertex_offsets[i + 1]; j++)
+            sum += m_angle[m_vertex_corners[j]];
+        m_curvature[i] = (m_boundary[i] ? M_PI : 2.0 * M_PI) - sum;
+    }
+    return true;
+}
+
+double MeshLib::CRicciFlow::_curvature_error(double& l2)
+{
+    const int nv = (int)m_verts.size();
+
+    double max_error = 0;
+    double sum = 0;
+    for (int i = 0; i < nv; i++)
+    {
+        if (m_unknown[i] < 0)
+            continue;
+        double error = fabs(m_target[i] - m_curvature[i]);
+        max_error = (error > max_error) ? error : max_error;
+        sum += error * error;
+    }
+    l2 = sqrt(sum);
+    return max_error;
+}
+
+void MeshLib::CRicciFlow::_fill_hessian()
+{
+    const int ne = (int)m_length.size();
+    const int nv = (int)m_verts.size();
+    double* values = m_hessian.valuePtr();
+
+    // each edge owns its two off diagonal slots
+#pragma omp parallel for
+    for (int e = 0; e < ne; e++)
+    {
+        if (m_offdiag_slots[2 * e] < 0)
+            continue;
+        int c0 = m_edge_corner[2 * e + 0], c1 = m_edge_corner[2 * e + 1];
+        double w = 0.5 * (m_cot[c0] + ((c1 >= 0) ? m_cot[c1] : 0.0));
+        values[m_offdiag_slots[2 * e + 0]] = -w;
+        values[m_offdiag_slots[2 * e + 1]] = -w;
+    }
+
+    // each vertex gathers the weights of its edges, including the edge to the pinned vertex
+#pragma omp parallel for
+    for (int i = 0; i < nv; i++)
+    {
+        if (m_unknown[i] < 0)
+            continue;
+        double sum = 0;
+        for (int j = m_edge_offsets[i]; j < m_edge_offsets[i + 1]; j++)
+        {
+            int e = m_vertex_edges[j];
+            int c0 = m_edge_corner[2 * e + 0], c1 = m_edge_corner[2 * e + 1];
+            sum += 0.5 * (m_cot[c0] + ((c1 >= 0) ? m_cot[c1] : 0.0));
+        }
+        values[m_diag_slots[m_unknown[i]]] = sum;
+    }
+}
+
+void MeshLib::CRicciFlow::_embed()
+{
+    const int nf = (int)m_corner_vertex.size() / 3;
+    const int nv = (int)m_verts.size();
+
+    std::vector<CPoint2> uv(nv);
+    std::vector<char> placed(nv, 0);
+    std::vector<char> visited(nf, 0);
+
+    // place the k+2-th corner of face f by the k-th and k+1-th corners
+    auto place = [&](int f, int k) {
+        int a = m_corner_vertex[3 * f + k];
+        int b = m_corner_vertex[3 * f + (k + 1) % 3];
+        int c = m_corner_vertex[3 * f + (k + 2) % 3];
+        if (placed[c])
+            return;
+        CPoint2 d = uv[b] - uv[a];
+        d /= d.norm();
+        double theta = m_angle[3 * f + k];
+        // the edge from a to c is opposite to the k+1-th corner
+        double l = m_length[m_corner_edge[3 * f + (k + 1) % 3]];
+        CPoint2 r(cos(theta) * d[0] - sin(theta) * d[1], sin(theta) * d[0] + cos(theta) * d[1]);
+        uv[c] = uv[a] + r * l;
+        placed[c] = 1;
+    };
+
+    // the first face, its 0-th corner at the origin, 1-th corner on the x-axis
+    int v0 = m_corner_vertex[0], v1 = m_corner_vertex[1];
+    uv[v0] = CPoint2(0, 0);
+    uv[v1] = CPoint2(m_length[m_corner_edge[2]], 0);
+    placed[v0] = placed[v1] = 1;
+    place(0, 0);
+
+    std::queue<int> queue;
+    queue.push(0);
+    visited[0] = 1;
+    while (!queue.empty())
+    {
+        int f = queue.front();
+        queue.pop();
+        for (int k = 0; k < 3; k++)
+        {
+            int e = m_corner_edge[3 * f + k];
+            int c = (m_edge_corner[2 * e + 0] / 3 == f) ? m_edge_corner[2 * e + 1] : m_edge_corner[2 * e + 0];
+            if (c < 0 || visited[c / 3])
+                continue;
+
+            // the shared edge is opposite to corner c in the neighbor
+            int g = c / 3;
+            place(g, (c % 3 + 1) % 3);
+            visited[g] = 1;
+            queue.push(g);
+        }
+    }
+
+    // normalize the uv into the unit disk
+    CPoint2 center(0, 0);
+    for (int i = 0; i < nv; i++)
+        center += uv[i];
+    center /= nv;
+    double radius = 0;
+    for (int i = 0; i < nv; i++)
+    {
+        double r = (uv[i] - center).norm();
+        radius = (r > radius) ? r : radius;
+    }
+    for (int i = 0; i < nv; i++)
+        m_verts[i]->uv() = (uv[i] - center) / radius;
+}
+
+void MeshLib::CRicciFlow::_write_traits()
+{
+    const int ne = (int)m_edges.size();
+    const int nc = (int)m_halfedges.size();
+
+    for (int e = 0; e < ne; e++)
+    {
+        int c0 = m_edge_corner[2 * e + 0], c1 = m_edge_corner[2 * e + 1];
+        m_edges[e]->length() = m_length[e];
+        m_edges[e]->weight() = 0.5 * (m_cot[c0] + ((c1 >= 0) ? m_cot[c1] : 0.0));
+    }
+    for (int c = 0; c < nc; c++)
+        m_halfedges[c]->angle() = m_angle[c];
+}
@@ -0,0 +1,148 @@
+#ifndef _RICCI_FLOW_H_
+#define _RICCI_FLOW_H_
+
+#include <vector>
+
+#include <Eigen/Sparse>
+
+#include "HarmonicMapMesh.h"
+
+namespace MeshLib
+{
+
+/*! \brief CRicciFlow class
+ *
+ *   Discrete surface Ricci flow (CETM) which maps a topological disk
+ *   conformally to the plane. The edge length is scaled by the conformal
+ *   factors at its end vertices, l_ij = l0_ij exp((u_i + u_j) / 2). The
+ *   target curvature is zero at interior vertices, and proportional to the
+ *   boundary length at boundary vertices. The factors are solved by Newton
+ *   iterations, the Hessian is the cotangent Laplacian. Its sparsity pattern
+ *   and symbolic factorization are computed once, and only the values are
+ *   refilled at each step.
+ */
+class CRicciFlow
+{
+  public:
+    /*!
+     *  CRicciFlow constructor
+     */
+    CRicciFlow() : m_pMesh(NULL), m_pinned(0) {};
+
+    /*!
+     *  Set mesh, pack the connectivity and build the Hessian pattern
+     *  \param pMesh input topological disk
+     *  \return false if the mesh is not a topological disk
+     */
+    bool set_mesh(CHarmonicMapMesh* pMesh);
+
+    /*!
+     *  Newton's method, solve the conformal factors for target curvatures,
+     *  then lay out the flat metric to the vertex uv
+     *  \param epsilon curvature error threshold
+     *  \param max_steps maximal number of Newton steps
+     *  \return number of Newton steps
+     */
+    int map(double epsilon = 1e-8, int max_steps = 32);
+
+  protected:
+    /*!
+     *  Compute the corner angles, cotangents and the vertex curvatures
+     *  under the conformal factors
+     *  \param u conformal factors
+     *  \return false if some triangle violates the triangle inequality
+     */
+    bool _calculate_metric(const std::vector<double>& u);
+
+    /*!
+     *  Maximal curvature error and its l2 norm
+     *  \param l2 output l2 norm of the curvature error
+     *  \return maximal curvature error
+     */
+    double _curvature_error(double& l2);
+
+    /*!
+     *  Fill the values of the Hessian, the pattern is kept
+     */
+    void _fill_hessian();
+
+    /*!
+     *  Isometrically lay out the faces to the plane by a breadth first
+     *  search, normalize the uv into the unit disk
+     */
+    void _embed();
+
+    /*!
+     *  Write the lengths, angles, weights and uv to the mesh traits
+     */
+    void _write_traits();
+
+  protected:
+    /*! the input mesh */
+    CHarmonicMapMesh* m_pMesh;
+
+    /*! vertices, ordered by their indices */
+    std::vector<CHarmonicMapVertex*> m_verts;
+
+    /*! halfedges of the face corners, corner 3f+k is the k-th corner of face f */
+    std::vector<CHarmonicMapHalfEdge*> m_halfedges;
+
+    /*! edges, ordered by their indices */
+    std::vector<CHarmonicMapEdge*> m_edges;
+
+    /*! vertex index of each corner */
+    std::vector<int> m_corner_vertex;
+
+    /*! index of the edge opposite to each corner */
+    std::vector<int> m_corner_edge;
+
+    /*! end vertices of each edge */
+    std::vector<int> m_edge_vertex;
+
+    /*! corners opposite to each edge, -1 on the boundary */
+    std::vector<int> m_edge_corner;
+
+    /*! offsets and corners around each vertex */
+    std::vector<int> m_vertex_offsets, m_vertex_corners;
+
+    /*! offsets and edges around each vertex */
+    std::vector<int> m_edge_offsets, m_vertex_edges;
+
+    /*! whether each vertex is on the boundary */
+    std::vector<char> m_boundary;
+
+    /*! initial edge lengths */
+    std::vector<double> m_length0;
+
+    /*! current edge lengths */
+    std::vector<double> m_length;
+
+    /*! corner angles and cotangents */
+    std::vector<double> m_angle, m_cot;
+
+    /*! current and target vertex curvatures */
+    std::vector<double> m_curvature, m_target;
+
+    /*! conformal factors */
+    std::vector<double> m_u;
+
+    /*! the vertex whose factor is fixed to zero */
+    int m_pinned;
+
+    /*! unknown index of each vertex, -1 for the pinned vertex */
+    std::vector<int> m_unknown;
+
+    /*! value slots of the Hessian, two off diagonals per edge */
+    std::vector<int> m_offdiag_slots;
+
+    /*! value slots of the diagonal entries */
+    std::vector<int> m_diag_slots;
+
+    /*! the Hessian */
+    Eigen::SparseMatrix<double> m_hessian;
+
+    /*! the solver, analyzed once */
+    Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> m_solver;
+};
+}
+#endif // !_RICCI_FLOW_H_
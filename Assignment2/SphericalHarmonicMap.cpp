@@ -0,0 +1,274 @@
+#include <math.h>
+#include <float.h>
+
+#include "SphericalHarmonicMap.h"
+
+bool MeshLib::CSphericalHarmonicMap::set_mesh(CHarmonicMapMesh* pMesh)
+{
+    using M = CHarmonicMapMesh;
+
+    // 1. only closed genus zero surfaces
+    m_pMesh = NULL;
+    M::CTopology topology(pMesh);
+    if (!topology.is_closed() || topology.genus() != 0)
+    {
+        std::cerr << "Only closed genus zero surface accepted! " << topology.components().size() << " components, genus "
+                  << topology.genus() << ", " << topology.boundaries() << " boundaries" << std::endl;
+        return false;
+    }
+    m_pMesh = pMesh;
+
+    // 2. compute the weights of edges, this also indexes the vertices
+    if (!_calculate_edge_weight())
+    {
+        m_pMesh = NULL;
+        return false;
+    }
+    _build_adjacency();
+    _calculate_vertex_area();
+
+    // 3. initialize the map by the Gauss map
+    _gauss_map();
+    _normalize();
+    _write_image();
+    m_step = 0.5;
+    return true;
+}
+
+void MeshLib::CSphericalHarmonicMap::tutte_map(double epsilon)
+{
+    if (!m_pMesh)
+    {
+        std::cerr << "Should set mesh first!" << std::endl;
+        return;
+    }
+
+    while (true)
+    {
+        double error = _flow(m_uniform);
+        _normalize();
+        printf("Current max error is %g\n", error);
+        if (error < epsilon)
+            break;
+    }
+    _write_image();
+    m_step = 0.5;
+}
+
+double MeshLib::CSphericalHarmonicMap::step_one()
+{
+    if (!m_pMesh)
+    {
+        std::cerr << "Should set mesh first!" << std::endl;
+        return DBL_MAX;
+    }
+
+    double max_error = _flow(m_cotangent);
+    _normalize();
+    _write_image();
+
+    printf("Current max error is %g\n", max_error);
+    return max_error;
+}
+
+void MeshLib::CSphericalHarmonicMap::_build_adjacency()
+{
+    using M = CHarmonicMapMesh;
+
+    const int nv = m_pMesh->numVertices();
+    m_verts.resize(nv);
+    for (M::MeshVertexIterator viter(m_pMesh); !viter.end(); ++viter)
+    {
+        M::CVertex* pV = *viter;
+        m_verts[pV->idx()] = pV;
+    }
+
+    // the surface is closed, the out halfedges visit every neighbor once
+    m_offsets.assign(nv + 1, 0);
+    m_neighbors.clear();
+    m_uniform.clear();
+    m_cotangent.clear();
+    for (int i = 0; i < nv; i++)
+    {
+        M::CVertex* pV = m_verts[i];
+        for (M::VertexOutHalfedgeIterator vhiter(m_pMesh, pV); !vhiter.end(); ++vhiter)
+        {
+            M::CHalfEdge* pH = *vhiter;
+            M::CVertex* pW = m_pMesh->halfedgeTarget(pH);
+            M::CEdge* pE = m_pMesh->halfedgeEdge(pH);
+            m_neighbors.push_back(pW->idx());
+            m_uniform.push_back(1.0);
+            m_cotangent.push_back(pE->weight());
+        }
+        m_offsets[i + 1] = (int)m_neighbors.size();
+    }
+}
+
+void MeshLib::CSphericalHarmonicMap::_calculate_vertex_area()
+{
+    using M = CHarmonicMapMesh;
+
+    m_area.assign(m_verts.size(), 0.0);
+    for (M::MeshFaceIterator fiter(m_pMesh); !fiter.end(); ++fiter)
+    {
+        M::CFace* pF = *fiter;
+        M::CVertex* pV[3];
+        M::CHalfEdge* pH = m_pMesh->faceHalfedge(pF);
+        for (int k = 0; k < 3; k++)
+        {
+            pV[k] = m_pMesh->halfedgeTarget(pH);
+            pH = m_pMesh->halfedgeNext(pH);
+        }
+
+        CPoint n = (pV[1]->point() - pV[0]->point()) ^ (pV[2]->point() - pV[0]->point());
+        double area = n.norm() / 2.0;
+        for (int k = 0; k < 3; k++)
+            m_area[pV[k]->idx()] += area / 3.0;
+    }
+}
+
+void MeshLib::CSphericalHarmonicMap::_gauss_map()
+{
+    using M = CHarmonicMapMesh;
+
+    const int nv = (int)m_verts.size();
+    m_image.resize(nv);
+    m_trial.resize(nv);
+
+#pragma omp parallel for
+    for (int i = 0; i < nv; i++)
+    {
+        M::CVertex* pV = m_verts[i];
+        CPoint& p = pV->point();
+
+        // area weighted normal of the one-ring
+        CPoint n(0, 0, 0);
+        for (int j = m_offsets[i]; j < m_offsets[i + 1]; j++)
+        {
+            int next = (j + 1 < m_offsets[i + 1]) ? j + 1 : m_offsets[i];
+            CPoint& a = m_verts[m_neighbors[j]]->point();
+            CPoint& b = m_verts[m_neighbors[next]]->point();
+            n += (a - p) ^ (b - p);
+        }
+        m_image[i] = n / n.norm();
+    }
+}
+
+double MeshLib::CSphericalHarmonicMap::_energy(const std::vector<double>& weight, const std::vector<CPoint>& image)
+{
+    const int nv = (int)image.size();
+
+    double energy = 0;
+#pragma omp parallel for reduction(+ : energy)
+    for (int i = 0; i < nv; i++)
+    {
+        for (int j = m_offsets[i]; j < m_offsets[i + 1]; j++)
+        {
+            CPoint d = image[i] - image[m_neighbors[j]];
+            energy += weight[j] * (d * d);
+        }
+    }
+    // every edge is visited twice
+    return energy / 2.0;
+}
+
+double MeshLib::CSphericalHarmonicMap::_flow(const std::vector<double>& weight)
+{
+    const int nv = (int)m_image.size();
+    const double energy = _energy(weight, m_image);
+
+    while (m_step > 1e-8)
+    {
+        // move each vertex along the tangential component of the Laplacian,
+        // reading the old images only, then project back to the sphere
+#pragma omp parallel for
+        for (int i = 0; i < nv; i++)
+        {
+            CPoint& p = m_image[i];
+
+            double sw = 0;
+            CPoint sp(0, 0, 0);
+            for (int j = m_offsets[i]; j < m_offsets[i + 1]; j++)
+            {
+                sw += weight[j];
+                sp += m_image[m_neighbors[j]] * weight[j];
+            }
+            if (sw <= 0)
+            {
+                m_trial[i] = p;
+                continue;
+            }
+
+            CPoint lap = sp / sw - p;
+            lap -= p * (lap * p);
+
+            CPoint q = p + lap * m_step;
+            m_trial[i] = q / q.norm();
+        }
+
+        // reject the step if the energy increases
+        if (_energy(weight, m_trial) > energy)
+        {
+            m_step /= 2.0;
+            continue;
+        }
+
+        double max_error = 0;
+        for (int i = 0; i < nv; i++)
+        {
+            double error = (m_trial[i] - m_image[i]).norm();
+            max_error = (error > max_error) ? error : max_error;
+        }
+
+        m_image.swap(m_trial);
+        m_step = (m_step * 1.2 < 1.0) ? m_step * 1.2 : 1.0;
+        return max_error;
+    }
+
+    // no descent step, the map has converged
+    return 0;
+}
+
+void MeshLib::CSphericalHarmonicMap::_normalize()
+{
+    const int nv = (int)m_image.size();
+
+    double total = 0;
+    for (int i = 0; i < nv; i++)
+        total += m_area[i];
+
+    for (int iter = 0; iter < 64; iter++)
+    {
+        // area weighted mass center of the images
+        CPoint c(0, 0, 0);
+        for (int i = 0; i < nv; i++)
+            c += m_image[i] * m_area[i];
+        c /= total;
+
+        double c2 = c * c;
+        if (c2 < 1e-16)
+            break;
+
+        // Mobius transformation of the unit ball which maps c to the origin,
+        // it keeps the unit sphere and pushes the images away from c
+#pragma omp parallel for
+        for (int i = 0; i < nv; i++)
+        {
+            CPoint d = m_image[i] - c;
+            double d2 = d * d;
+            CPoint q = (d * (1.0 - c2) - c * d2) / d2;
+            m_image[i] = q / q.norm();
+        }
+    }
+}
+
+void MeshLib::CSphericalHarmonicMap::_write_image()
+{
+    const int nv = (int)m_verts.size();
+
+#pragma omp parallel for
+    for (int i = 0; i < nv; i++)
+    {
+        m_verts[i]->image() = m_image[i];
+    }
+}
@@ -0,0 +1,120 @@
+#ifndef _SPHERICAL_HARMONIC_MAP_H_
+#define _SPHERICAL_HARMONIC_MAP_H_
+
+#include <vector>
+
+#include "HarmonicMap.h"
+
+namespace MeshLib
+{
+
+/*! \brief CSphericalHarmonicMap class
+ *
+ *   Harmonic map algorithm that maps a closed genus zero surface
+ *   to the unit sphere. The map is initialized by the Gauss map,
+ *   improved by the Tutte map with uniform weights, and then driven
+ *   by the nonlinear heat flow with cotangent weights. The images are
+ *   projected back to the sphere after each step, and normalized by
+ *   Mobius transformations such that the mass center is the origin.
+ */
+class CSphericalHarmonicMap : public CHarmonicMap
+{
+  public:
+    /*!
+     *  CSphericalHarmonicMap constructor
+     */
+    CSphericalHarmonicMap() : m_step(0.5) {};
+
+    /*!
+     *  Set mesh and initialize the map by the Gauss map
+     *  \param pMesh input closed genus zero mesh
+     *  \return false if the mesh is not a closed genus zero surface
+     */
+    bool set_mesh(CHarmonicMapMesh* pMesh) override;
+
+    /*!
+     *  Tutte map, heat flow with uniform weights
+     *  \param epsilon error threshold
+     */
+    void tutte_map(double epsilon = 1e-5);
+
+    /*!
+     *  Take next one step of heat flow with cotangent weights
+     *  \return maximal error of current step
+     */
+    double step_one() override;
+
+  protected:
+    /*!
+     *  Pack the one-ring of each vertex into compressed rows,
+     *  with uniform and cotangent weights
+     */
+    void _build_adjacency();
+
+    /*!
+     *  Compute the vertex area, one third of the adjacent face areas
+     */
+    void _calculate_vertex_area();
+
+    /*!
+     *  Initialize the images by the Gauss map (unit vertex normal)
+     */
+    void _gauss_map();
+
+    /*!
+     *  One step of heat flow, the step size is halved until the
+     *  harmonic energy decreases, and enlarged after success.
+     *  \param weight edge weights in the compressed rows
+     *  \return maximal displacement of the vertices
+     */
+    double _flow(const std::vector<double>& weight);
+
+    /*!
+     *  Harmonic energy of the current images
+     *  \param weight edge weights in the compressed rows
+     *  \param image  vertex images
+     *  \return harmonic energy
+     */
+    double _energy(const std::vector<double>& weight, const std::vector<CPoint>& image);
+
+    /*!
+     *  Apply Mobius transformations until the area weighted mass
+     *  center of the images is the origin
+     */
+    void _normalize();
+
+    /*!
+     *  Copy the images to the vertices
+     */
+    void _write_image();
+
+  protected:
+    /*! Vertices, ordered by their indices */
+    std::vector<CHarmonicMapVertex*> m_verts;
+
+    /*! Offsets of the one-ring of each vertex */
+    std::vector<int> m_offsets;
+
+    /*! Neighboring vertex indices */
+    std::vector<int> m_neighbors;
+
+    /*! Uniform weights */
+    std::vector<double> m_uniform;
+
+    /*! Cotangent weights */
+    std::vector<double> m_cotangent;
+
+    /*! Vertex areas */
+    std::vector<double> m_area;
+
+    /*! Vertex images on the unit sphere */
+    std::vector<CPoint> m_image;
+
+    /*! Images of the trial step */
+    std::vector<CPoint> m_trial;
+
+    /*! Current step size */
+    double m_step;
+};
+}
+#endif // !_SPHERICAL_HARMONIC_MAP_H_
@@ -11,6 +11,9 @@
 #include "viewer/Arcball.h" /*  Arc Ball  Interface         */
 #include "HarmonicMapMesh.h"
 #include "HarmonicMap.h"
+#include "SphericalHarmonicMap.h"
+#include "RicciFlow.h"
+#include "AreaPreservingMap.h"
 
 using namespace MeshLib;
 
@@ -21,6 +24,7 @@ int g_startx, g_starty;
 int g_shade_flag = 0;
 bool g_show_mesh = true;
 bool g_show_uv = false;
+bool g_closed = false;
 
 /* rotation quaternion and translation vector for the object */
 CQrot g_obj_rot(0, 0, 1, 0);
@@ -32,6 +36,9 @@ CArcball g_arcball;
 /* global g_mesh */
 CHarmonicMapMesh g_mesh;
 CHarmonicMap g_mapper;
+CSphericalHarmonicMap g_sphere_mapper;
+CRicciFlow g_ricci_flow;
+CAreaPreservingMap g_area_map;
 
 /*! setup the object, transform from the world to the object coordinate system */
 void setupObject(void)
@@ -107,6 +114,7 @@ void drawUv()
         {
             CHarmonicMapVertex* pV = *fviter;
             CPoint2& uv = pV->uv();
+            CPoint& img = pV->image();
             CPoint& rgb = pV->rgb();
             CPoint n;
             switch (g_shade_flag)
@@ -120,7 +128,10 @@ void drawUv()
             }
             glNormal3d(n[0], n[1], n[2]);
             glColor3f(rgb[0], rgb[1], rgb[2]);
-            glVertex3d(uv[0], uv[1], 0);
+            if (g_closed)
+                glVertex3d(img[0], img[1], img[2]);
+            else
+                glVertex3d(uv[0], uv[1], 0);
         }
         glEnd();
     }
@@ -180,6 +191,9 @@ void help()
     printf("n  -  Take next one step of iterative method\n");
     printf("i  -  Iterative method of harmonic map\n");
     printf("h  -  Directly solve the equations\n");
+    printf("t  -  Tutte map of closed surface\n");
+    printf("r  -  Conformal map by Ricci flow\n");
+    printf("a  -  Area-preserving map by optimal transport\n");
     printf("w  -  Wireframe Display\n");
     printf("f  -  Flat Shading \n");
     printf("s  -  Smooth Shading\n");
@@ -202,15 +216,43 @@ void keyBoard(unsigned char key, int x, int y)
         break;
     case 'n':
         // take next one step
-        g_mapper.step_one();
+        if (g_closed)
+            g_sphere_mapper.step_one();
+        else
+            g_mapper.step_one();
         break;
     case 'i':
         // iterative method of harmonic map
-        g_mapper.iterative_map();
+        if (g_closed)
+            g_sphere_mapper.iterative_map();
+        else
+            g_mapper.iterative_map();
         break;
     case 'h':
         // directly solve the equations
-        g_mapper.map();
+        if (!g_closed)
+            g_mapper.map();
+        break;
+    case 't':
+        // tutte map of closed surface
+        if (g_closed)
+            g_sphere_mapper.tutte_map();
+        break;
+    case 'r':
+        // conformal map of topological disk by Ricci flow
+        if (!g_closed)
+        {
+            if (g_ricci_flow.set_mesh(&g_mesh))
+                g_ricci_flow.map();
+        }
+        break;
+    case 'a':
+        // area-preserving map of topological disk by optimal transport
+        if (!g_closed)
+        {
+            if (g_area_map.set_mesh(&g_mesh))
+                g_area_map.map();
+        }
         break;
     case 'f':
         // Flat Shading
@@ -393,30 +435,34 @@ void normalizeMesh(CHarmonicMapMesh* pMesh)
  */
 void computeNormal(CHarmonicMapMesh* pMesh)
 {
-    for (CHarmonicMapMesh::MeshVertexIterator viter(pMesh); !viter.end(); ++viter)
-    {
-        CHarmonicMapVertex* v = *viter;
-        CPoint n(0, 0, 0);
-        for (CHarmonicMapMesh::VertexFaceIterator vfiter(v); !vfiter.end(); ++vfiter)
+    // area weighted normal of a face
+    auto faceNormal = [](CHarmonicMapFace* pF) {
+        CPoint p[3];
+        CHalfEdge* he = pF->halfedge();
+        for (int k = 0; k < 3; k++)
         {
-            CHarmonicMapFace* pF = *vfiter;
+            p[k] = he->target()->point();
+            he = he->he_next();
+        }
+        return (p[1] - p[0]) ^ (p[2] - p[0]);
+    };
 
-            CPoint p[3];
-            CHalfEdge* he = pF->halfedge();
-            for (int k = 0; k < 3; k++)
-            {
-                p[k] = he->target()->point();
-                he = he->he_next();
-            }
+    // each task writes its own faces, then its own vertices
+    pMesh->parallel_for_each_face([&](CHarmonicMapFace* pF) {
+        CPoint fn = faceNormal(pF);
+        pF->normal() = fn / fn.norm();
+    });
 
-            CPoint fn = (p[1] - p[0]) ^ (p[2] - p[0]);
-            pF->normal() = fn / fn.norm();
-            n += fn;
+    pMesh->parallel_for_each_vertex([&](CHarmonicMapVertex* v) {
+        CPoint n(0, 0, 0);
+        for (CHarmonicMapMesh::VertexFaceIterator vfiter(v); !vfiter.end(); ++vfiter)
+        {
+            n += faceNormal(*vfiter);
         }
 
         n = n / n.norm();
         v->normal() = n;
-    }
+    });
 };
 
 void initOpenGL(int argc, char* argv[])
@@ -471,7 +517,22 @@ int main(int argc, char* argv[])
     normalizeMesh(&g_mesh);
     computeNormal(&g_mesh);
 
-    g_mapper.set_mesh(&g_mesh);
+    // closed surfaces are mapped to the unit sphere
+    g_closed = true;
+    for (CHarmonicMapMesh::MeshVertexIterator viter(&g_mesh); !viter.end(); ++viter)
+    {
+        CHarmonicMapVertex* pV = *viter;
+        if (pV->boundary())
+        {
+            g_closed = false;
+            break;
+        }
+    }
+
+    if (g_closed)
+        g_sphere_mapper.set_mesh(&g_mesh);
+    else
+        g_mapper.set_mesh(&g_mesh);
 
     initOpenGL(argc, argv);
     return EXIT_SUCCESS;
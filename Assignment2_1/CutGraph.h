@@ -1,6 +1,8 @@
 #ifndef _CUT_GRAPH_H_
 #define _CUT_GRAPH_H_
 
+#include <vector>
+
 #include "CutGraphMesh.h"
 
 namespace MeshLib
@@ -10,36 +12,223 @@ namespace MeshLib
  *   Compute the spanning tree of the dual mesh,
  *   the edges whose duals are not on the tree form the cut locus,
  *   label the cut locus as the sharp edges.
+ *
+ *   The mesh is packed once into index arrays, the spanning tree and
+ *   the pruning work on the arrays, the cut edges are kept in a bit
+ *   vector and written to the sharp flags at the end.
+ *
+ *   In the shortest mode the cut graph is the greedy system of loops
+ *   of the tree-cotree decomposition: a shortest path tree T from a
+ *   root vertex, a maximum spanning cotree C of the dual graph, where
+ *   each edge weighs the length of its loop through T, and one loop
+ *   for each of the 2g edges left in neither T nor C.
+ *
+ *   After the cut graph, the split and swap operations of the dynamic
+ *   mesh repair the dual spanning tree and the pruned cut graph around
+ *   the edited faces only. The dual tree is kept rooted, and every
+ *   pruned vertex keeps the edge it was peeled along, which points to
+ *   the remaining cut graph, so a new cut edge finds the cycle it closes
+ *   by walking these edges. The repaired cut graph is valid, but in the
+ *   shortest mode it is not kept shortest. The edits are refused when
+ *   the dual tree is a forest: on a mesh of several components, and in
+ *   the shortest mode on a mesh with boundary, whose cotree skips the
+ *   boundary edges.
  */
 class CCutGraph
 {
   public:
-    /*! 
+    /*!
      *  CCutGraph constructor
      *  \param pMesh input closed mesh
      */
-    CCutGraph(CCutGraphMesh* pMesh) { m_pMesh = pMesh; };
+    CCutGraph(CCutGraphMesh* pMesh) : m_pMesh(pMesh), m_prune_rounds(0), m_cut_edges(0), m_editable(false), m_rooted(false), m_root(0), m_stamp(0){};
 
-    /*! 
+    /*!
      * Compute the cut graph.
+     * \param shortest geometrically short loops by edge length instead
+     *        of the breadth first dual spanning tree
+     */
+    void cut_graph(bool shortest = false);
+
+    /*!
+     * Number of parallel leaf pruning rounds of the last cut graph.
+     */
+    int prune_rounds() { return m_prune_rounds; };
+
+    /*!
+     * Number of edges in the last cut graph.
+     */
+    int cut_edges() { return m_cut_edges; };
+
+    /*!
+     *  Split a face at its center and repair the cut graph locally
+     *  \param pFace the face to be split
+     *  \return the new vertex
      */
-    void cut_graph();
+    CCutGraphVertex* split_face(CCutGraphFace* pFace);
+
+    /*!
+     *  Split an interior edge at its midpoint and repair the cut graph locally
+     *  \param pEdge the edge to be split
+     *  \return the new vertex, NULL for a boundary edge
+     */
+    CCutGraphVertex* split_edge(CCutGraphEdge* pEdge);
+
+    /*!
+     *  Swap an interior edge and repair the cut graph locally
+     *  \param pEdge the edge to be swapped
+     */
+    void swap_edge(CCutGraphEdge* pEdge);
 
   protected:
-    /*! 
+    /*!
      *  Input closed mesh.
      */
     CCutGraphMesh* m_pMesh;
 
-    /*! 
+    /*!
+     *  Index the vertices, edges and faces, build the face adjacency.
+     */
+    void _index();
+
+    /*!
      *  Compute the spanning tree of the dual mesh.
      */
     void _dual_spanning_tree();
 
     /*!
-     * Prune the branches which attached to valence-1 nodes.
+     *  Dijkstra shortest path tree by edge length with a binary heap.
+     *  \param root the base vertex of the loops
+     */
+    void _shortest_path_tree(int root);
+
+    /*!
+     *  Maximum spanning tree of the dual graph, avoiding the edges of
+     *  the shortest path tree, the weight of an edge is the length of
+     *  its loop through the root.
+     */
+    void _dual_cotree();
+
+    /*!
+     *  Cut along the loops of the edges in neither tree, each loop is
+     *  the edge and the tree paths from its two ends to the root.
+     */
+    void _greedy_generators();
+
+    /*!
+     * Prune the branches which attached to valence-1 nodes, peeling
+     * all the current leaves in parallel in each round.
      */
     void _prune();
+
+    /*!
+     *  Whether the cut graph can be repaired after an edit
+     *  \return false before the cut graph, or if its dual tree is a forest
+     */
+    bool _can_edit();
+
+    /*!
+     *  Root the dual spanning tree at face 0, before the first edit.
+     */
+    void _root_dual_tree();
+
+    /*!
+     *  Record the edges of the faces about to be edited.
+     *  \param faces indices of the faces to be edited
+     */
+    void _begin_edit(const std::vector<int>& faces);
+
+    /*!
+     *  Index the new elements, then repair the dual spanning tree and
+     *  the pruned cut graph around the edited faces.
+     *  \param faces indices of the edited faces, the new faces are added
+     */
+    void _end_edit(std::vector<int>& faces);
+
+    /*!
+     *  Update the face adjacency of one face.
+     */
+    void _index_face(int f);
+
+    /*!
+     *  Indices of the edges around a vertex, by rotating its halfedges.
+     */
+    void _vertex_edges(int v, std::vector<int>& edges);
+
+    /*!
+     *  Add an edge to the unpruned cut graph.
+     */
+    void _add_cut_edge(int e);
+
+    /*!
+     *  Peel the vertex and its successors while they are leaves.
+     */
+    void _peel(int v);
+
+  protected:
+    /*! vertices, edges and faces by index */
+    std::vector<CCutGraphVertex*> m_verts;
+    std::vector<CCutGraphEdge*> m_edges;
+    std::vector<CCutGraphFace*> m_faces;
+
+    /*! the two vertices of edge e are 2e and 2e+1 */
+    std::vector<int> m_edge_verts;
+
+    /*! the k-th halfedge of face f lies on edge m_face_edges[3f+k] */
+    std::vector<int> m_face_edges;
+
+    /*! the face across the k-th halfedge of face f, -1 on the boundary */
+    std::vector<int> m_face_adjacency;
+
+    /*! cut edges, the duals of the edges not on the spanning tree */
+    std::vector<bool> m_cut;
+
+    /*! edge lengths, vertex distances to the root and the tree edge to the parent */
+    std::vector<double> m_length;
+    std::vector<double> m_dist;
+    std::vector<int> m_parent;
+
+    /*! the edges in the shortest path tree or in the dual cotree */
+    std::vector<bool> m_tree;
+    std::vector<bool> m_cotree;
+
+    /*! pruning rounds and the remaining cut edges */
+    int m_prune_rounds;
+    int m_cut_edges;
+
+    /*! the edges whose duals are on the dual spanning tree */
+    std::vector<bool> m_dual_tree;
+
+    /*! whether the dual tree spans the faces, so that edits can be repaired */
+    bool m_editable;
+
+    /*! the parent face and the edge to it in the rooted dual tree */
+    std::vector<int> m_face_parent;
+    std::vector<int> m_face_parent_edge;
+
+    /*! whether the dual tree is rooted, and its root face */
+    bool m_rooted;
+    int m_root;
+
+    /*! the cut edges around each vertex after pruning */
+    std::vector<int> m_valence;
+
+    /*! the edge each pruned vertex was peeled along, -1 on the cut graph */
+    std::vector<int> m_peel;
+
+    /*! the edited faces and their edges before the edit, with the end
+     *  vertices and whether the edge was in the unpruned cut graph */
+    std::vector<int> m_edit_edges;
+    std::vector<int> m_edit_verts;
+    std::vector<bool> m_edit_in_cut;
+
+    /*! the edges whose pruned cut flag changed in the edit */
+    std::vector<int> m_changed;
+
+    /*! face and vertex stamps of the edits */
+    std::vector<int> m_face_stamp;
+    std::vector<int> m_vert_stamp;
+    int m_stamp;
 };
 } // namespace MeshLib
 #endif // !_CUT_GRAPH_H_
@@ -160,10 +160,14 @@ void help()
     printf("w  -  Wireframe Display\n");
     printf("f  -  Flat Shading \n");
     printf("s  -  Smooth Shading\n");
+    printf("c  -  Cut Graph by Dual Spanning Tree\n");
+    printf("g  -  Cut Graph by Shortest Loops\n");
     printf("?  -  Help Information\n");
     printf("esc - quit\n");
 }
 
+void cut_graph(CCutGraphMesh* pMesh, bool shortest = false);
+
 /*! Keyboard call back function */
 void keyBoard(unsigned char key, int x, int y)
 {
@@ -183,6 +187,14 @@ void keyBoard(unsigned char key, int x, int y)
             // Wireframe mode
             glPolygonMode(GL_FRONT, GL_LINE);
             break;
+        case 'c':
+            // Cut graph by the dual spanning tree
+            cut_graph(&g_mesh);
+            break;
+        case 'g':
+            // Cut graph by the greedy shortest loops
+            cut_graph(&g_mesh, true);
+            break;
         case '?':
             help();
             break;
@@ -350,30 +362,34 @@ void normalizeMesh(CCutGraphMesh* pMesh)
  */
 void computeNormal(CCutGraphMesh* pMesh)
 {
-    for (CCutGraphMesh::MeshVertexIterator viter(pMesh); !viter.end(); ++viter)
-    {
-        CCutGraphVertex* v = *viter;
-        CPoint n(0, 0, 0);
-        for (CCutGraphMesh::VertexFaceIterator vfiter(v); !vfiter.end(); ++vfiter)
+    // area weighted normal of a face
+    auto faceNormal = [](CCutGraphFace* pF) {
+        CPoint p[3];
+        CHalfEdge* he = pF->halfedge();
+        for (int k = 0; k < 3; k++)
         {
-            CCutGraphFace* pF = *vfiter;
+            p[k] = he->target()->point();
+            he = he->he_next();
+        }
+        return (p[1] - p[0]) ^ (p[2] - p[0]);
+    };
 
-            CPoint p[3];
-            CHalfEdge* he = pF->halfedge();
-            for (int k = 0; k < 3; k++)
-            {
-                p[k] = he->target()->point();
-                he = he->he_next();
-            }
+    // each task writes its own faces, then its own vertices
+    pMesh->parallel_for_each_face([&](CCutGraphFace* pF) {
+        CPoint fn = faceNormal(pF);
+        pF->normal() = fn / fn.norm();
+    });
 
-            CPoint fn = (p[1] - p[0]) ^ (p[2] - p[0]);
-            pF->normal() = fn / fn.norm();
-            n += fn;
+    pMesh->parallel_for_each_vertex([&](CCutGraphVertex* v) {
+        CPoint n(0, 0, 0);
+        for (CCutGraphMesh::VertexFaceIterator vfiter(v); !vfiter.end(); ++vfiter)
+        {
+            n += faceNormal(*vfiter);
         }
 
         n = n / n.norm();
         v->normal() = n;
-    }
+    });
 };
 
 void initOpenGL(int argc, char* argv[])
@@ -395,10 +411,10 @@ void initOpenGL(int argc, char* argv[])
     glutMainLoop(); /* Start GLUT event-processing loop */
 }
 
-void cut_graph(CCutGraphMesh* pMesh)
+void cut_graph(CCutGraphMesh* pMesh, bool shortest)
 {
     CCutGraph cg(pMesh);
-    cg.cut_graph();
+    cg.cut_graph(shortest);
 }
 
 /*! main function for viewer
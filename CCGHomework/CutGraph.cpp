@@ -1,115 +1,897 @@
+#include <algorithm>
+#include <atomic>
+#include <float.h>
+#include <functional>
+#include <iterator>
 #include <queue>
+
 #include "CutGraph.h"
 
-void MeshLib::CCutGraph::cut_graph()
+void MeshLib::CCutGraph::cut_graph(bool shortest)
 {
-    _dual_spanning_tree();
+    using M = CCutGraphMesh;
+
+    _index();
 
-    // The cut graph contains all edges which their duals are not
-    // in the spanning tree.
-    for (CCutGraphMesh::MeshEdgeIterator eiter(m_pMesh); !eiter.end(); ++eiter)
+    // the dual tree is a forest on several components, and the cotree
+    // skips the boundary edges, the edits need a spanning dual tree
+    M::CTopology topology(m_pMesh);
+    if (shortest)
     {
-        CCutGraphEdge* pE = *eiter;
-        pE->sharp() = !pE->sharp();
+        _shortest_path_tree(0);
+        _dual_cotree();
+        _greedy_generators();
+        m_dual_tree = m_cotree;
+        m_editable = topology.is_closed();
+
+        // prune the tree branches off the loops as well, so that every
+        // vertex off the loops keeps the edge it was peeled along
+        for (size_t e = 0; e < m_edges.size(); e++)
+            m_cut[e] = m_cut[e] || m_tree[e];
     }
+    else
+    {
+        _dual_spanning_tree();
+        m_dual_tree.resize(m_edges.size());
+        for (size_t e = 0; e < m_edges.size(); e++)
+            m_dual_tree[e] = !m_cut[e];
+        m_editable = topology.components().size() == 1;
+    }
+    m_rooted = false;
 
     _prune();
+
+    // write the cut edges to the sharp flags in one pass
+    for (size_t e = 0; e < m_edges.size(); e++)
+        m_edges[e]->sharp() = m_cut[e];
 }
 
-/*----------------------------------------------------------------------------
+void MeshLib::CCutGraph::_index()
+{
+    using M = CCutGraphMesh;
+
+    const int nv = m_pMesh->numVertices();
+    const int ne = m_pMesh->numEdges();
+    const int nf = m_pMesh->numFaces();
+
+    m_verts.resize(nv);
+    int vid = 0;
+    for (M::MeshVertexIterator viter(m_pMesh); !viter.end(); ++viter)
+    {
+        M::CVertex* pV = *viter;
+        pV->idx() = vid;
+        m_verts[vid++] = pV;
+    }
+
+    m_edges.resize(ne);
+    m_edge_verts.resize(2 * ne);
+    m_length.resize(ne);
+    int eid = 0;
+    for (M::MeshEdgeIterator eiter(m_pMesh); !eiter.end(); ++eiter)
+    {
+        M::CEdge* pE = *eiter;
+        pE->idx() = eid;
+        m_edges[eid] = pE;
+        m_edge_verts[2 * eid + 0] = m_pMesh->edgeVertex1(pE)->idx();
+        m_edge_verts[2 * eid + 1] = m_pMesh->edgeVertex2(pE)->idx();
+        m_length[eid] = (m_pMesh->edgeVertex1(pE)->point() - m_pMesh->edgeVertex2(pE)->point()).norm();
+        eid++;
+    }
 
-Modify the method CCutGraph::_dual_spanning_tree()
+    m_faces.resize(nf);
+    int fid = 0;
+    for (M::MeshFaceIterator fiter(m_pMesh); !fiter.end(); ++fiter)
+    {
+        M::CFace* pF = *fiter;
+        pF->idx() = fid;
+        m_faces[fid++] = pF;
+    }
 
-------------------------------------------------------------------------------*/
+    // the faces are indexed before, so the neighbor ids can be read directly
+    m_face_edges.resize(3 * nf);
+    m_face_adjacency.resize(3 * nf);
+    for (int f = 0; f < nf; f++)
+    {
+        M::CHalfEdge* pH = m_pMesh->faceHalfedge(m_faces[f]);
+        for (int k = 0; k < 3; k++)
+        {
+            M::CHalfEdge* pSymH = m_pMesh->halfedgeSym(pH);
+            m_face_edges[3 * f + k] = m_pMesh->halfedgeEdge(pH)->idx();
+            m_face_adjacency[3 * f + k] = (pSymH != NULL) ? m_pMesh->halfedgeFace(pSymH)->idx() : -1;
+            pH = m_pMesh->halfedgeNext(pH);
+        }
+    }
+}
 
 void MeshLib::CCutGraph::_dual_spanning_tree()
 {
-    // Mark all sharp flags false
-    for (CCutGraphMesh::MeshEdgeIterator eiter(m_pMesh); !eiter.end(); ++eiter)
+    const int nf = (int)m_faces.size();
+
+    // every edge is cut, until its dual joins the spanning tree
+    m_cut.assign(m_edges.size(), true);
+
+    // breadth first search on the face adjacency, the frontier is a flat
+    // array of face ids, every face is pushed exactly once
+    std::vector<bool> visited(nf, false);
+    std::vector<int> frontier;
+    frontier.reserve(nf);
+
+    for (int seed = 0; seed < nf; seed++)
     {
-        CCutGraphEdge* pE = *eiter;
-        //insert your code here
+        if (visited[seed])
+            continue;
+
+        visited[seed] = true;
+        frontier.push_back(seed);
+        for (size_t head = frontier.size() - 1; head < frontier.size(); head++)
+        {
+            const int f = frontier[head];
+            for (int k = 0; k < 3; k++)
+            {
+                const int g = m_face_adjacency[3 * f + k];
+                if (g < 0 || visited[g])
+                    continue;
+
+                visited[g] = true;
+                m_cut[m_face_edges[3 * f + k]] = false;
+                frontier.push_back(g);
+            }
+        }
     }
+}
 
-    // Mark all touched flags false, and select a face
-    CCutGraphFace* pHeadFace = NULL;
-    for (CCutGraphMesh::MeshFaceIterator fiter(m_pMesh); !fiter.end(); ++fiter)
+void MeshLib::CCutGraph::_shortest_path_tree(int root)
+{
+    const int nv = (int)m_verts.size();
+    const int ne = (int)m_edges.size();
+
+    // the edges around each vertex
+    std::vector<int> offsets(nv + 1, 0);
+    for (int e = 0; e < ne; e++)
+    {
+        offsets[m_edge_verts[2 * e + 0] + 1]++;
+        offsets[m_edge_verts[2 * e + 1] + 1]++;
+    }
+    for (int v = 0; v < nv; v++)
+        offsets[v + 1] += offsets[v];
+    std::vector<int> incident(offsets[nv]);
+    std::vector<int> fill(offsets.begin(), offsets.end() - 1);
+    for (int e = 0; e < ne; e++)
     {
-        CCutGraphFace* pF = *fiter;
-        //insert your code here
-        pHeadFace = pF;
+        incident[fill[m_edge_verts[2 * e + 0]]++] = e;
+        incident[fill[m_edge_verts[2 * e + 1]]++] = e;
     }
-    
-    // 1. Construct the dual mesh conceptually.
 
-    // 2. Generate a minimal spanning tree of the vertices in the dual mesh.
-    std::queue<CCutGraphFace*> fQueue;
-    fQueue.push(pHeadFace);
-    pHeadFace->touched() = true;
-    while (!fQueue.empty())
+    // Dijkstra, stale heap entries are skipped when popped
+    typedef std::pair<double, int> CEntry;
+    std::priority_queue<CEntry, std::vector<CEntry>, std::greater<CEntry>> heap;
+    std::vector<bool> done(nv, false);
+    m_dist.assign(nv, DBL_MAX);
+    m_parent.assign(nv, -1);
+    m_tree.assign(ne, false);
+
+    m_dist[root] = 0;
+    heap.push(CEntry(0, root));
+    while (!heap.empty())
     {
-        CCutGraphFace* pF = fQueue.front();
-        fQueue.pop();
+        const int v = heap.top().second;
+        heap.pop();
+        if (done[v])
+            continue;
+        done[v] = true;
+        if (m_parent[v] >= 0)
+            m_tree[m_parent[v]] = true;
 
-        for (CCutGraphMesh::FaceHalfedgeIterator fhiter(pF); !fhiter.end(); ++fhiter)
+        for (int i = offsets[v]; i < offsets[v + 1]; i++)
         {
-            CCutGraphHalfEdge* pH = *fhiter;
-            CCutGraphHalfEdge* pSymH = m_pMesh->halfedgeSym(pH);
-            if (pSymH != NULL)
+            const int e = incident[i];
+            const int w = (m_edge_verts[2 * e] == v) ? m_edge_verts[2 * e + 1] : m_edge_verts[2 * e];
+            const double d = m_dist[v] + m_length[e];
+            if (d < m_dist[w])
             {
-                CCutGraphFace* pSymFace = m_pMesh->halfedgeFace(pSymH);
-                if (!pSymFace->touched())
-                {
-                    //insert your code here
-                }
+                m_dist[w] = d;
+                m_parent[w] = e;
+                heap.push(CEntry(d, w));
             }
         }
     }
 }
 
-/*----------------------------------------------------------------------------
+void MeshLib::CCutGraph::_dual_cotree()
+{
+    const int nf = (int)m_faces.size();
+    const int ne = (int)m_edges.size();
+
+    // the two faces of each edge, -1 on the boundary
+    std::vector<int> edge_faces(2 * ne, -1);
+    for (int c = 0; c < 3 * nf; c++)
+    {
+        int* side = &edge_faces[2 * m_face_edges[c]];
+        side[(side[0] < 0) ? 0 : 1] = c / 3;
+    }
+
+    // the dual edges off the primal tree, by decreasing length of their loops
+    std::vector<int> candidates;
+    std::vector<double> loop(ne, 0);
+    for (int e = 0; e < ne; e++)
+    {
+        if (m_tree[e] || edge_faces[2 * e + 1] < 0)
+            continue;
+        loop[e] = m_dist[m_edge_verts[2 * e]] + m_dist[m_edge_verts[2 * e + 1]] + m_length[e];
+        candidates.push_back(e);
+    }
+    std::sort(candidates.begin(), candidates.end(), [&](int a, int b) { return loop[a] > loop[b]; });
 
-Modify the method _CCutGraph::_prune()
+    // Kruskal on the faces, union-find with path halving and union by size
+    std::vector<int> parent(nf), size(nf, 1);
+    for (int f = 0; f < nf; f++)
+        parent[f] = f;
+    auto find = [&](int f) {
+        while (parent[f] != f)
+        {
+            parent[f] = parent[parent[f]];
+            f = parent[f];
+        }
+        return f;
+    };
 
-------------------------------------------------------------------------------*/
+    m_cotree.assign(ne, false);
+    for (size_t i = 0; i < candidates.size(); i++)
+    {
+        const int e = candidates[i];
+        int f = find(edge_faces[2 * e]), g = find(edge_faces[2 * e + 1]);
+        if (f == g)
+            continue;
+        if (size[f] < size[g])
+            std::swap(f, g);
+        parent[g] = f;
+        size[f] += size[g];
+        m_cotree[e] = true;
+    }
+}
 
-void MeshLib::CCutGraph::_prune() 
+void MeshLib::CCutGraph::_greedy_generators()
 {
-    // A queue used to store valence-1 vertices
-    std::queue<CCutGraphVertex*> vQueue;
+    const int nv = (int)m_verts.size();
+    const int ne = (int)m_edges.size();
+
+    // the roots are on the cut, so every path stops at its root or
+    // where it meets a path walked before
+    std::vector<bool> on_cut(nv, false);
+    for (int v = 0; v < nv; v++)
+        on_cut[v] = (m_parent[v] < 0);
 
-    // 1. Compute the valence of each vertex, and record all valence-1 vertices.
-    for (CCutGraphMesh::MeshVertexIterator viter(m_pMesh); !viter.end(); ++viter)
+    m_cut.assign(ne, false);
+    int generators = 0;
+    for (int e = 0; e < ne; e++)
     {
-        CCutGraphVertex* pV = *viter;
-        pV->valence() = 0;
+        if (m_tree[e] || m_cotree[e] || m_edges[e]->boundary())
+            continue;
 
-        for (CCutGraphMesh::VertexEdgeIterator veiter(pV); !veiter.end(); ++veiter)
+        m_cut[e] = true;
+        generators++;
+        for (int k = 0; k < 2; k++)
         {
-            CCutGraphEdge* pE = *veiter;
-            //insert your code here
+            int v = m_edge_verts[2 * e + k];
+            while (!on_cut[v])
+            {
+                on_cut[v] = true;
+                const int p = m_parent[v];
+                m_cut[p] = true;
+                v = (m_edge_verts[2 * p] == v) ? m_edge_verts[2 * p + 1] : m_edge_verts[2 * p];
+            }
         }
+    }
+    printf("Greedy system of %d loops\n", generators);
+}
+
+void MeshLib::CCutGraph::_prune()
+{
+    const int nv = (int)m_verts.size();
+    const int ne = (int)m_edges.size();
+
+    // 1. Compute the valence of each vertex in the cut graph, and the
+    //    cut edges around each vertex in compressed rows.
+    std::vector<int> offsets(nv + 1, 0);
+    for (int e = 0; e < ne; e++)
+    {
+        if (!m_cut[e])
+            continue;
+        offsets[m_edge_verts[2 * e + 0] + 1]++;
+        offsets[m_edge_verts[2 * e + 1] + 1]++;
+    }
+    for (int v = 0; v < nv; v++)
+        offsets[v + 1] += offsets[v];
+    std::vector<int> incident(offsets[nv]);
+    std::vector<int> fill(offsets.begin(), offsets.end() - 1);
+    for (int e = 0; e < ne; e++)
+    {
+        if (!m_cut[e])
+            continue;
+        incident[fill[m_edge_verts[2 * e + 0]]++] = e;
+        incident[fill[m_edge_verts[2 * e + 1]]++] = e;
+    }
 
-        if (pV->valence() == 1)
-            vQueue.push(pV);
+    // the bit vector can not be written concurrently, the rounds work on
+    // one atomic flag per edge and one atomic valence per vertex
+    std::vector<std::atomic<char>> alive(ne);
+    std::vector<std::atomic<int>> valence(nv);
+    for (int e = 0; e < ne; e++)
+        alive[e] = m_cut[e] ? 1 : 0;
+    for (int v = 0; v < nv; v++)
+        valence[v] = offsets[v + 1] - offsets[v];
+
+    // record all valence-1 vertices
+    std::vector<int> leaves, next(nv);
+    m_peel.assign(nv, -1);
+    for (int v = 0; v < nv; v++)
+    {
+        if (valence[v] == 1)
+            leaves.push_back(v);
     }
 
-    // 2. Remove the segments which attached to valence-1 vertices.
-    while (!vQueue.empty())
+    // 2. Remove the segments which attached to valence-1 vertices, all
+    //    the leaves of a round at once. A vertex drops to valence 1 only
+    //    once, so it joins the next round at most once.
+    m_prune_rounds = 0;
+    while (!leaves.empty())
     {
-        CCutGraphVertex* pV = vQueue.front();
-        vQueue.pop();
+        std::atomic<int> count(0);
+        const int nl = (int)leaves.size();
 
-        for (CCutGraphMesh::VertexEdgeIterator veiter(pV); !veiter.end(); ++veiter)
+#pragma omp parallel for schedule(dynamic, 256)
+        for (int l = 0; l < nl; l++)
         {
-            CCutGraphEdge* pE = *veiter;
-            CCutGraphVertex* pW = m_pMesh->edgeVertex1(pE) == pV ? 
-                m_pMesh->edgeVertex2(pE) : m_pMesh->edgeVertex1(pE);
-            if (pE->sharp())
+            const int v = leaves[l];
+            for (int i = offsets[v]; i < offsets[v + 1]; i++)
             {
-                //insert your code here
+                // both ends of an isolated segment may be leaves, only one removes it
+                const int e = incident[i];
+                if (!alive[e].exchange(0))
+                    continue;
+
+                const int w = (m_edge_verts[2 * e] == v) ? m_edge_verts[2 * e + 1] : m_edge_verts[2 * e];
+                m_peel[v] = e;
+                valence[v]--;
+                if (valence[w].fetch_sub(1) == 2)
+                    next[count++] = w;
                 break;
             }
         }
+
+        leaves.assign(next.begin(), next.begin() + count);
+        m_prune_rounds++;
+    }
+
+    m_cut_edges = 0;
+    for (int e = 0; e < ne; e++)
+    {
+        m_cut[e] = (alive[e] != 0);
+        m_cut_edges += m_cut[e] ? 1 : 0;
+    }
+    m_valence.resize(nv);
+    for (int v = 0; v < nv; v++)
+    {
+        m_valence[v] = valence[v];
+        m_verts[v]->valence() = valence[v];
+    }
+
+    printf("Pruned in %d rounds, %d cut edges left\n", m_prune_rounds, m_cut_edges);
+}
+
+bool MeshLib::CCutGraph::_can_edit()
+{
+    if (m_dual_tree.empty())
+    {
+        std::cerr << "Should compute the cut graph first!" << std::endl;
+        return false;
+    }
+    if (!m_editable)
+    {
+        std::cerr << "Can not repair the cut graph, its dual tree does not span the faces!" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+MeshLib::CCutGraphVertex* MeshLib::CCutGraph::split_face(CCutGraphFace* pFace)
+{
+    if (!_can_edit())
+        return NULL;
+
+    CPoint center(0, 0, 0);
+    for (CCutGraphMesh::FaceVertexIterator fviter(pFace); !fviter.end(); ++fviter)
+        center += (*fviter)->point() / 3.0;
+
+    std::vector<int> faces(1, pFace->idx());
+    _begin_edit(faces);
+    CCutGraphVertex* pV = m_pMesh->splitFace(pFace);
+    pV->point() = center;
+    _end_edit(faces);
+    return pV;
+}
+
+MeshLib::CCutGraphVertex* MeshLib::CCutGraph::split_edge(CCutGraphEdge* pEdge)
+{
+    if (!_can_edit())
+        return NULL;
+    if (pEdge->boundary())
+    {
+        std::cerr << "Can not split a boundary edge!" << std::endl;
+        return NULL;
+    }
+
+    CPoint middle = (m_pMesh->edgeVertex1(pEdge)->point() + m_pMesh->edgeVertex2(pEdge)->point()) / 2.0;
+
+    std::vector<int> faces;
+    faces.push_back(m_pMesh->edgeFace1(pEdge)->idx());
+    faces.push_back(m_pMesh->edgeFace2(pEdge)->idx());
+    _begin_edit(faces);
+    CCutGraphVertex* pV = m_pMesh->splitEdge(pEdge);
+    pV->point() = middle;
+    _end_edit(faces);
+    return pV;
+}
+
+void MeshLib::CCutGraph::swap_edge(CCutGraphEdge* pEdge)
+{
+    if (!_can_edit())
+        return;
+    if (pEdge->boundary())
+    {
+        std::cerr << "Can not swap a boundary edge!" << std::endl;
+        return;
+    }
+
+    std::vector<int> faces;
+    faces.push_back(m_pMesh->edgeFace1(pEdge)->idx());
+    faces.push_back(m_pMesh->edgeFace2(pEdge)->idx());
+    _begin_edit(faces);
+    m_pMesh->swapEdge(pEdge);
+    _end_edit(faces);
+}
+
+void MeshLib::CCutGraph::_root_dual_tree()
+{
+    const int nf = (int)m_faces.size();
+
+    // breadth first search on the tree edges only
+    m_face_parent.assign(nf, -1);
+    m_face_parent_edge.assign(nf, -1);
+    std::vector<bool> visited(nf, false);
+    std::vector<int> frontier;
+    frontier.reserve(nf);
+
+    m_root = 0;
+    for (int seed = 0; seed < nf; seed++)
+    {
+        if (visited[seed])
+            continue;
+
+        visited[seed] = true;
+        frontier.push_back(seed);
+        for (size_t head = frontier.size() - 1; head < frontier.size(); head++)
+        {
+            const int f = frontier[head];
+            for (int k = 0; k < 3; k++)
+            {
+                const int g = m_face_adjacency[3 * f + k];
+                const int e = m_face_edges[3 * f + k];
+                if (g < 0 || visited[g] || !m_dual_tree[e])
+                    continue;
+
+                visited[g] = true;
+                m_face_parent[g] = f;
+                m_face_parent_edge[g] = e;
+                frontier.push_back(g);
+            }
+        }
+    }
+
+    m_face_stamp.assign(nf, 0);
+    m_vert_stamp.assign(m_verts.size(), 0);
+    m_stamp = 0;
+    m_rooted = true;
+}
+
+void MeshLib::CCutGraph::_begin_edit(const std::vector<int>& faces)
+{
+    if (!m_rooted)
+        _root_dual_tree();
+
+    m_edit_edges.clear();
+    m_edit_verts.clear();
+    m_edit_in_cut.clear();
+    for (size_t i = 0; i < faces.size(); i++)
+    {
+        for (int k = 0; k < 3; k++)
+        {
+            const int e = m_face_edges[3 * faces[i] + k];
+            if (std::find(m_edit_edges.begin(), m_edit_edges.end(), e) != m_edit_edges.end())
+                continue;
+            m_edit_edges.push_back(e);
+            m_edit_verts.push_back(m_edge_verts[2 * e + 0]);
+            m_edit_verts.push_back(m_edge_verts[2 * e + 1]);
+            m_edit_in_cut.push_back(!m_dual_tree[e]);
+        }
+    }
+}
+
+void MeshLib::CCutGraph::_end_edit(std::vector<int>& faces)
+{
+    using M = CCutGraphMesh;
+
+    // 1. index the new elements, which are at the ends of the arrays
+    const int nv = m_pMesh->numVertices();
+    const int ne = m_pMesh->numEdges();
+    const int nf = m_pMesh->numFaces();
+    const int old_faces = (int)faces.size();
+
+    CElementArray<M::CVertex*>::iterator viter = m_pMesh->vertices().end();
+    std::advance(viter, (int)m_verts.size() - nv);
+    for (; viter != m_pMesh->vertices().end(); ++viter)
+    {
+        (*viter)->idx() = (int)m_verts.size();
+        m_verts.push_back(*viter);
+    }
+    CElementArray<M::CEdge*>::iterator eiter = m_pMesh->edges().end();
+    std::advance(eiter, (int)m_edges.size() - ne);
+    for (; eiter != m_pMesh->edges().end(); ++eiter)
+    {
+        (*eiter)->idx() = (int)m_edges.size();
+        m_edges.push_back(*eiter);
+    }
+    CElementArray<M::CFace*>::iterator fiter = m_pMesh->faces().end();
+    std::advance(fiter, (int)m_faces.size() - nf);
+    for (; fiter != m_pMesh->faces().end(); ++fiter)
+    {
+        (*fiter)->idx() = (int)m_faces.size();
+        faces.push_back((int)m_faces.size());
+        m_faces.push_back(*fiter);
+    }
+
+    m_edge_verts.resize(2 * ne);
+    m_length.resize(ne);
+    m_dual_tree.resize(ne, false);
+    m_cut.resize(ne, false);
+    m_face_edges.resize(3 * nf);
+    m_face_adjacency.resize(3 * nf);
+    m_face_parent.resize(nf, -1);
+    m_face_parent_edge.resize(nf, -1);
+    m_face_stamp.resize(nf, 0);
+    m_valence.resize(nv, 0);
+    m_peel.resize(nv, -1);
+    m_vert_stamp.resize(nv, 0);
+
+    // 2. the adjacency of the edited faces and of their neighbors, and
+    //    the ends of the edges of the edited faces
+    const int inside = ++m_stamp;
+    for (size_t i = 0; i < faces.size(); i++)
+        m_face_stamp[faces[i]] = inside;
+
+    std::vector<int> patch;
+    for (size_t i = 0; i < faces.size(); i++)
+    {
+        const int f = faces[i];
+        _index_face(f);
+        for (int k = 0; k < 3; k++)
+        {
+            const int e = m_face_edges[3 * f + k];
+            if (std::find(patch.begin(), patch.end(), e) != patch.end())
+                continue;
+            patch.push_back(e);
+            M::CEdge* pE = m_edges[e];
+            m_edge_verts[2 * e + 0] = m_pMesh->edgeVertex1(pE)->idx();
+            m_edge_verts[2 * e + 1] = m_pMesh->edgeVertex2(pE)->idx();
+            m_length[e] = (m_pMesh->edgeVertex1(pE)->point() - m_pMesh->edgeVertex2(pE)->point()).norm();
+        }
+    }
+    for (size_t i = 0; i < faces.size(); i++)
+    {
+        for (int k = 0; k < 3; k++)
+        {
+            const int g = m_face_adjacency[3 * faces[i] + k];
+            if (g >= 0 && m_face_stamp[g] != inside)
+                _index_face(g);
+        }
+    }
+
+    // 3. the dual tree, the subtrees below the edited faces hang on the
+    //    faces now across their parent edges, the edited faces hang on
+    //    the one parent whose path reaches the root, and are connected
+    //    by a breadth first tree among themselves
+    int top = -1, up_face = -1, up_edge = -1;
+    std::vector<int> candidates;
+    for (int i = 0; i < old_faces; i++)
+    {
+        const int p = m_face_parent[faces[i]];
+        if (p < 0)
+        {
+            top = faces[i];
+            candidates.clear();
+            break;
+        }
+        if (m_face_stamp[p] != inside)
+            candidates.push_back(faces[i]);
+    }
+    for (size_t i = 0; i < candidates.size(); i++)
+    {
+        int x = m_face_parent[candidates[i]];
+        if (candidates.size() > 1)
+        {
+            while (x >= 0 && m_face_stamp[x] != inside)
+                x = m_face_parent[x];
+        }
+        if (x < 0 || candidates.size() == 1)
+        {
+            up_face = m_face_parent[candidates[i]];
+            up_edge = m_face_parent_edge[candidates[i]];
+            break;
+        }
+    }
+    if (up_face >= 0)
+    {
+        for (int k = 0; k < 3; k++)
+        {
+            if (m_face_edges[3 * up_face + k] == up_edge)
+                top = m_face_adjacency[3 * up_face + k];
+        }
+    }
+    if (top < 0)
+        top = faces[0];
+
+    std::vector<int> lower;
+    for (size_t i = 0; i < faces.size(); i++)
+    {
+        const int f = faces[i];
+        for (int k = 0; k < 3; k++)
+        {
+            const int g = m_face_adjacency[3 * f + k];
+            const int e = m_face_edges[3 * f + k];
+            if (g < 0 || m_face_stamp[g] == inside || m_face_parent_edge[g] != e)
+                continue;
+            if (m_face_parent[g] < 0 || m_face_stamp[m_face_parent[g]] != inside)
+                continue;
+            m_face_parent[g] = f;
+            lower.push_back(e);
+        }
+    }
+
+    for (size_t i = 0; i < patch.size(); i++)
+        m_dual_tree[patch[i]] = false;
+    for (size_t i = 0; i < lower.size(); i++)
+        m_dual_tree[lower[i]] = true;
+    if (up_edge >= 0)
+        m_dual_tree[up_edge] = true;
+
+    m_face_parent[top] = up_face;
+    m_face_parent_edge[top] = up_edge;
+    std::vector<int> frontier(1, top);
+    const int visited = ++m_stamp;
+    m_face_stamp[top] = visited;
+    for (size_t head = 0; head < frontier.size(); head++)
+    {
+        const int f = frontier[head];
+        for (int k = 0; k < 3; k++)
+        {
+            const int g = m_face_adjacency[3 * f + k];
+            if (g < 0 || m_face_stamp[g] != inside)
+                continue;
+            m_face_stamp[g] = visited;
+            m_face_parent[g] = f;
+            m_face_parent_edge[g] = m_face_edges[3 * f + k];
+            m_dual_tree[m_face_edges[3 * f + k]] = true;
+            frontier.push_back(g);
+        }
+    }
+
+    // 4. the pruned cut graph, the edges which left the unpruned cut
+    //    graph or changed their ends are removed first, with their old
+    //    ends, then the new leaves are peeled, then the edges which
+    //    joined it are added
+    m_changed.clear();
+    std::vector<int> leaves;
+    std::vector<bool> kept(m_edit_edges.size(), false);
+    for (size_t i = 0; i < m_edit_edges.size(); i++)
+    {
+        const int e = m_edit_edges[i];
+        const int a = m_edit_verts[2 * i], b = m_edit_verts[2 * i + 1];
+        const bool same = (m_edge_verts[2 * e] == a && m_edge_verts[2 * e + 1] == b) ||
+                          (m_edge_verts[2 * e] == b && m_edge_verts[2 * e + 1] == a);
+        kept[i] = same && (m_edit_in_cut[i] == !m_dual_tree[e]);
+        if (kept[i] || !m_edit_in_cut[i])
+            continue;
+
+        if (m_cut[e])
+        {
+            m_cut[e] = false;
+            m_cut_edges--;
+            m_changed.push_back(e);
+            m_valence[a]--;
+            m_valence[b]--;
+            leaves.push_back(a);
+            leaves.push_back(b);
+        }
+        else
+        {
+            if (m_peel[a] == e)
+                m_peel[a] = -1;
+            if (m_peel[b] == e)
+                m_peel[b] = -1;
+        }
+    }
+    for (size_t i = 0; i < leaves.size(); i++)
+        _peel(leaves[i]);
+
+    for (size_t i = 0; i < patch.size(); i++)
+    {
+        const int e = patch[i];
+        std::vector<int>::iterator pos = std::find(m_edit_edges.begin(), m_edit_edges.end(), e);
+        if (pos != m_edit_edges.end() && kept[pos - m_edit_edges.begin()])
+            continue;
+        if (!m_dual_tree[e])
+            _add_cut_edge(e);
+    }
+
+    for (size_t i = 0; i < m_changed.size(); i++)
+    {
+        const int e = m_changed[i];
+        m_edges[e]->sharp() = m_cut[e];
+        for (int k = 0; k < 2; k++)
+        {
+            const int v = m_edge_verts[2 * e + k];
+            m_verts[v]->valence() = m_valence[v];
+        }
+    }
+    // a swapped edge no longer ends at its old ends, which lost it and
+    // may still be on the cut graph, the peeled leaves are among them
+    for (size_t i = 0; i < m_edit_verts.size(); i++)
+    {
+        const int v = m_edit_verts[i];
+        m_verts[v]->valence() = m_valence[v];
+    }
+}
+
+void MeshLib::CCutGraph::_index_face(int f)
+{
+    using M = CCutGraphMesh;
+
+    M::CHalfEdge* pH = m_pMesh->faceHalfedge(m_faces[f]);
+    for (int k = 0; k < 3; k++)
+    {
+        M::CHalfEdge* pSymH = m_pMesh->halfedgeSym(pH);
+        m_face_edges[3 * f + k] = m_pMesh->halfedgeEdge(pH)->idx();
+        m_face_adjacency[3 * f + k] = (pSymH != NULL) ? m_pMesh->halfedgeFace(pSymH)->idx() : -1;
+        pH = m_pMesh->halfedgeNext(pH);
+    }
+}
+
+void MeshLib::CCutGraph::_vertex_edges(int v, std::vector<int>& edges)
+{
+    using M = CCutGraphMesh;
+
+    // the edge lists of the vertices are not updated by the dynamic
+    // mesh, so rotate the halfedges instead
+    edges.clear();
+    M::CVertex* pV = m_verts[v];
+    M::CHalfEdge* pStart = m_pMesh->vertexMostClwInHalfEdge(pV);
+    if (pV->boundary())
+        edges.push_back(m_pMesh->halfedgeEdge(m_pMesh->halfedgeNext(pStart))->idx());
+
+    M::CHalfEdge* pH = pStart;
+    while (true)
+    {
+        edges.push_back(m_pMesh->halfedgeEdge(pH)->idx());
+        pH = (M::CHalfEdge*)pH->ccw_rotate_about_target();
+        if (pH == NULL || pH == pStart)
+            break;
+    }
+}
+
+void MeshLib::CCutGraph::_peel(int v)
+{
+    std::vector<int> ring;
+    while (m_valence[v] == 1)
+    {
+        _vertex_edges(v, ring);
+        int e = -1;
+        for (size_t i = 0; i < ring.size() && e < 0; i++)
+            e = m_cut[ring[i]] ? ring[i] : -1;
+        if (e < 0)
+            break;
+
+        const int w = (m_edge_verts[2 * e] == v) ? m_edge_verts[2 * e + 1] : m_edge_verts[2 * e];
+        m_cut[e] = false;
+        m_cut_edges--;
+        m_changed.push_back(e);
+        m_peel[v] = e;
+        m_valence[v] = 0;
+        m_valence[w]--;
+        v = w;
+    }
+}
+
+void MeshLib::CCutGraph::_add_cut_edge(int e)
+{
+    auto other = [&](int edge, int v) {
+        return (m_edge_verts[2 * edge] == v) ? m_edge_verts[2 * edge + 1] : m_edge_verts[2 * edge];
+    };
+    auto keep = [&](int edge) {
+        m_cut[edge] = true;
+        m_cut_edges++;
+        m_changed.push_back(edge);
+        m_valence[m_edge_verts[2 * edge + 0]]++;
+        m_valence[m_edge_verts[2 * edge + 1]]++;
+    };
+    // the pruned vertices from v to w leave the pruned branches and
+    // join the cut graph
+    auto join = [&](int v, int w) {
+        while (v != w)
+        {
+            const int edge = m_peel[v];
+            m_peel[v] = -1;
+            keep(edge);
+            v = other(edge, v);
+        }
+    };
+    // reverse the peel edges from v to the root of its branch, v is
+    // then peeled along the given edge
+    auto reroot = [&](int v, int edge) {
+        int next = m_peel[v];
+        m_peel[v] = edge;
+        while (next >= 0)
+        {
+            const int w = other(next, v);
+            const int after = m_peel[w];
+            m_peel[w] = next;
+            v = w;
+            next = after;
+        }
+    };
+
+    // the ends of the peel paths, on the cut graph or the root of a branch
+    const int u = m_edge_verts[2 * e], v = m_edge_verts[2 * e + 1];
+    int ru = u, rv = v;
+    while (m_valence[ru] == 0 && m_peel[ru] >= 0)
+        ru = other(m_peel[ru], ru);
+    while (m_valence[rv] == 0 && m_peel[rv] >= 0)
+        rv = other(m_peel[rv], rv);
+    const bool cu = m_valence[ru] > 0, cv = m_valence[rv] > 0;
+
+    if (cu && cv)
+    {
+        // a new cycle through the cut graph
+        join(u, ru);
+        join(v, rv);
+        keep(e);
+    }
+    else if (!cu && !cv && ru == rv)
+    {
+        // a new cycle in a pruned branch, closed at the common vertex
+        const int stamp = ++m_stamp;
+        for (int x = u;; x = other(m_peel[x], x))
+        {
+            m_vert_stamp[x] = stamp;
+            if (x == ru)
+                break;
+        }
+        int l = v;
+        while (m_vert_stamp[l] != stamp)
+            l = other(m_peel[l], l);
+
+        join(u, l);
+        join(v, l);
+        reroot(l, -1);
+        keep(e);
+    }
+    else if (!cu && cv)
+    {
+        // the branch of u hangs on v
+        reroot(u, e);
+    }
+    else
+    {
+        // the branch of v hangs on u
+        reroot(v, e);
     }
 }
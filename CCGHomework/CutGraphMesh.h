@@ -2,12 +2,14 @@
 #define _CUT_GRAPH_MESH_
 
 #include "Mesh/BaseMesh.h"
+#include "Mesh/DynamicMesh.h"
 #include "Mesh/Edge.h"
 #include "Mesh/Face.h"
 #include "Mesh/HalfEdge.h"
 #include "Mesh/Vertex.h"
 
 #include "Mesh/Boundary.h"
+#include "Mesh/Topology.h"
 #include "Mesh/Iterators.h"
 #include "Parser/parser.h"
 
@@ -21,64 +23,83 @@ class CCutGraphHalfEdge;
 /*! \brief CCutGraphVertex class
  *
  *   Vertex class for cut graph algoritm
- *   Trait : Vertex valence
+ *   Trait : Vertex valence, index
  */
 class CCutGraphVertex : public CVertex
 {
   public:
     /*! Constructor */
-    CCutGraphVertex() : m_valence(0) {};
+    CCutGraphVertex() : m_valence(0), m_index(0) {};
 
     /*! Vertex valence */
     int& valence() { return m_valence; };
 
+    /*! Vertex index */
+    int& idx() { return m_index; };
+
   protected:
     /*! Vertex valence */
     int m_valence;
 
+    /*! Vertex index */
+    int m_index;
+
 };
 
 /*! \brief CCutGraphEdge class
  *
  *   Edge class for cut graph algorithm
- *   Trait : Edge sharp
+ *   Trait : Edge sharp, index
  */
 class CCutGraphEdge : public CEdge
 {
   public:
     /*! Constructor */
-    CCutGraphEdge() : m_sharp(false){};
+    CCutGraphEdge() : m_sharp(false), m_index(0){};
 
     /*! Sharp edge */
     bool& sharp() { return m_sharp; };
 
+    /*! Edge index */
+    int& idx() { return m_index; };
+
   protected:
     /*! Sharp edge */
     bool m_sharp;
+
+    /*! Edge index */
+    int m_index;
 };
 
 /*! \brief CCutGraphFace class
  *
  *   Face class for cut graph algorithm
- *   Trait : Face touched flag
+ *   Trait : Face touched flag, index
  */
 class CCutGraphFace : public CFace
 {
   public:
     /*! Constructor */
-    CCutGraphFace() : m_touched(false){};
+    CCutGraphFace() : m_touched(false), m_index(0){};
 
     /*! face touched flag */
     bool & touched() { return m_touched; };
 
     /*! face normal */
     CPoint& normal() { return m_normal; };
+
+    /*! face index */
+    int& idx() { return m_index; };
+
   protected:
     /*! face touched flag */
     bool m_touched;
 
     /*! face normal */
     CPoint m_normal;
+
+    /*! face index */
+    int m_index;
 };
 
 /*! \brief CCutGraphHalfEdge class
@@ -91,11 +112,11 @@ class CCutGraphHalfEdge : public CHalfEdge
 
 /*! \brief CCutGraphMesh class
  *
- *	Mesh class for cut graph algorithm
+ *	Mesh class for cut graph algorithm, with the dynamic mesh editing
  *
  */
 template <typename V, typename E, typename F, typename H>
-class TCutGraphMesh : public CBaseMesh<V, E, F, H>
+class TCutGraphMesh : public CDynamicMesh<V, E, F, H>
 {
   public:
     typedef V CVertex;
@@ -105,6 +126,7 @@ class TCutGraphMesh : public CBaseMesh<V, E, F, H>
 
     typedef CBoundary<V, E, F, H>                   CBoundary;
     typedef CLoop<V, E, F, H>                       CLoop;
+    typedef CTopology<V, E, F, H>                   CTopology;
 
     typedef MeshVertexIterator<V, E, F, H>          MeshVertexIterator;
     typedef MeshEdgeIterator<V, E, F, H>            MeshEdgeIterator;
@@ -0,0 +1,217 @@
+#ifndef _MESH_SLICER_H_
+#define _MESH_SLICER_H_
+
+#include <utility>
+#include <vector>
+
+#include "CutGraphMesh.h"
+
+namespace MeshLib
+{
+/*! \brief CMeshSlicer class
+ *
+ *   Slice a mesh along its sharp edges in memory. Each vertex is split
+ *   into one copy per wedge, a wedge being the corners between two
+ *   consecutive sharp edges around the vertex. After the cut graph the
+ *   result is a topological disk. The ids of the vertices and faces are
+ *   kept, the copies of a split vertex get new ids.
+ *
+ *   The wedges are found in one pass over the vertex rings, then the
+ *   sliced mesh is built in one pass over the faces. The strings of the
+ *   input are moved, not copied, to the sliced mesh, only the extra
+ *   copies of a split vertex or edge copy them, then the traits of the
+ *   sliced mesh are read from the strings. The input mesh keeps its
+ *   connectivity and geometry, but loses its strings.
+ *
+ *   \tparam M input mesh, with face idx() and edge sharp() traits
+ *   \tparam D sliced mesh, derived from CBaseMesh
+ */
+template <typename M, typename D>
+class CMeshSlicer
+{
+  public:
+    /*!
+     *  CMeshSlicer constructor
+     *  \param pMesh input mesh with the sharp edges labeled
+     */
+    CMeshSlicer(M* pMesh) : m_pMesh(pMesh){};
+
+    /*!
+     *  Slice the mesh along the sharp edges
+     *  \param pDisk output, an empty mesh
+     */
+    void slice(D* pDisk);
+
+    /*!
+     *  The input vertex id of each sliced vertex, in the order of the
+     *  sliced vertex list
+     */
+    std::vector<int>& father() { return m_father; };
+
+  protected:
+    /*! position of the halfedge in its face, the corner is 3f + k */
+    int _corner(typename M::CHalfEdge* pH);
+
+  protected:
+    /*! the input mesh */
+    M* m_pMesh;
+
+    /*! the input vertex id of each sliced vertex */
+    std::vector<int> m_father;
+};
+
+template <typename M, typename D>
+int CMeshSlicer<M, D>::_corner(typename M::CHalfEdge* pH)
+{
+    typename M::CFace* pF = m_pMesh->halfedgeFace(pH);
+    typename M::CHalfEdge* pS = m_pMesh->faceHalfedge(pF);
+    int k = 0;
+    while (pS != pH)
+    {
+        pS = m_pMesh->halfedgeNext(pS);
+        k++;
+    }
+    return 3 * pF->idx() + k;
+}
+
+template <typename M, typename D>
+void CMeshSlicer<M, D>::slice(D* pDisk)
+{
+    typedef typename M::CVertex   CVertex;
+    typedef typename M::CEdge     CEdge;
+    typedef typename M::CFace     CFace;
+    typedef typename M::CHalfEdge CHalfEdge;
+
+    const int nf = m_pMesh->numFaces();
+
+    std::vector<CFace*> faces(nf);
+    int fid = 0;
+    for (typename M::MeshFaceIterator fiter(m_pMesh); !fiter.end(); ++fiter)
+    {
+        CFace* pF = *fiter;
+        pF->idx() = fid;
+        faces[fid++] = pF;
+    }
+
+    // 1. the wedge of each corner, rotating ccw about each vertex from a
+    //    sharp edge, or from the boundary, and starting a new wedge after
+    //    every sharp edge crossed
+    std::vector<int> wedge(3 * nf);
+    std::vector<CVertex*> wedge_vertex;
+    m_father.clear();
+    for (typename M::MeshVertexIterator viter(m_pMesh); !viter.end(); ++viter)
+    {
+        CVertex* pV = *viter;
+        CHalfEdge* pStart = m_pMesh->vertexMostClwInHalfEdge(pV);
+        if (!pV->boundary())
+        {
+            // the clw side of the start corner is a sharp edge, if any
+            CHalfEdge* pH = pStart;
+            do
+            {
+                if (m_pMesh->halfedgeEdge(m_pMesh->halfedgeNext(pH))->sharp())
+                {
+                    pStart = pH;
+                    break;
+                }
+                pH = m_pMesh->vertexNextCcwInHalfEdge(pH);
+            } while (pH != pStart);
+        }
+
+        int w = (int)wedge_vertex.size();
+        wedge_vertex.push_back(pV);
+        m_father.push_back(pV->id());
+
+        CHalfEdge* pH = pStart;
+        while (true)
+        {
+            wedge[_corner(pH)] = w;
+            CHalfEdge* pN = (CHalfEdge*)pH->ccw_rotate_about_target();
+            if (pN == NULL || pN == pStart)
+                break;
+            if (m_pMesh->halfedgeEdge(pH)->sharp())
+            {
+                w = (int)wedge_vertex.size();
+                wedge_vertex.push_back(pV);
+                m_father.push_back(pV->id());
+            }
+            pH = pN;
+        }
+    }
+
+    // 2. one sliced vertex per wedge, the first wedge of each vertex
+    //    keeps its id, the copies are numbered after the largest id,
+    //    the last wedge takes the string
+    int max_id = 0;
+    for (size_t w = 0; w < wedge_vertex.size(); w++)
+        max_id = (wedge_vertex[w]->id() > max_id) ? wedge_vertex[w]->id() : max_id;
+
+    const int nw = (int)wedge_vertex.size();
+    std::vector<typename D::CVertex*> verts(nw);
+    for (int w = 0; w < nw; w++)
+    {
+        CVertex* pV = wedge_vertex[w];
+        bool first = (w == 0 || wedge_vertex[w - 1] != pV);
+        typename D::CVertex* pW = pDisk->createVertex(first ? pV->id() : ++max_id);
+        pW->point() = pV->point();
+        if (w + 1 < nw && wedge_vertex[w + 1] == pV)
+            pW->string() = pV->string();
+        else
+            pW->string() = std::move(pV->string());
+        verts[w] = pW;
+    }
+
+    // 3. the faces, with the same ids, in the same order
+    std::vector<typename D::CFace*> sliced(nf);
+    for (int f = 0; f < nf; f++)
+    {
+        typename D::CVertex* v[3];
+        for (int k = 0; k < 3; k++)
+            v[k] = verts[wedge[3 * f + k]];
+        sliced[f] = pDisk->createFace(v, faces[f]->id());
+        sliced[f]->string() = std::move(faces[f]->string());
+    }
+    pDisk->labelBoundary();
+
+    // 4. the corner strings, and the sliced halfedge of each corner
+    std::vector<typename D::CHalfEdge*> halfedges(3 * nf);
+    for (int f = 0; f < nf; f++)
+    {
+        CHalfEdge* pH = m_pMesh->faceHalfedge(faces[f]);
+        typename D::CHalfEdge* pS = pDisk->faceHalfedge(sliced[f]);
+        while (pDisk->halfedgeTarget(pS) != verts[wedge[3 * f]])
+            pS = pDisk->halfedgeNext(pS);
+
+        for (int k = 0; k < 3; k++)
+        {
+            halfedges[3 * f + k] = pS;
+            pS->string() = std::move(pH->string());
+            pH = m_pMesh->halfedgeNext(pH);
+            pS = pDisk->halfedgeNext(pS);
+        }
+    }
+
+    // 5. the edge strings, a sharp edge becomes two edges and the second
+    //    one copies the string
+    for (typename M::MeshEdgeIterator eiter(m_pMesh); !eiter.end(); ++eiter)
+    {
+        CEdge* pE = *eiter;
+        CHalfEdge* pH0 = m_pMesh->edgeHalfedge(pE, 0);
+        CHalfEdge* pH1 = m_pMesh->edgeHalfedge(pE, 1);
+        if (pH1 != NULL && pE->sharp())
+            pDisk->halfedgeEdge(halfedges[_corner(pH1)])->string() = pE->string();
+        pDisk->halfedgeEdge(halfedges[_corner(pH0)])->string() = std::move(pE->string());
+    }
+
+    // 6. read the traits of the sliced mesh
+    for (typename D::MeshVertexIterator viter(pDisk); !viter.end(); ++viter)
+        (*viter)->_from_string();
+    for (typename D::MeshEdgeIterator eiter(pDisk); !eiter.end(); ++eiter)
+        (*eiter)->_from_string();
+    for (typename D::MeshFaceIterator fiter(pDisk); !fiter.end(); ++fiter)
+        (*fiter)->_from_string();
+    for (typename D::MeshHalfEdgeIterator hiter(pDisk); !hiter.end(); ++hiter)
+        (*hiter)->_from_string();
+}
+} // namespace MeshLib
+#endif // !_MESH_SLICER_H_
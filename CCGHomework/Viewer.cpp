@@ -160,10 +160,14 @@ void help()
     printf("w  -  Wireframe Display\n");
     printf("f  -  Flat Shading \n");
     printf("s  -  Smooth Shading\n");
+    printf("c  -  Cut Graph by Dual Spanning Tree\n");
+    printf("g  -  Cut Graph by Shortest Loops\n");
     printf("?  -  Help Information\n");
     printf("esc - quit\n");
 }
 
+void cut_graph(CCutGraphMesh* pMesh, bool shortest = false);
+
 /*! Keyboard call back function */
 void keyBoard(unsigned char key, int x, int y)
 {
@@ -183,6 +187,14 @@ void keyBoard(unsigned char key, int x, int y)
             // Wireframe mode
             glPolygonMode(GL_FRONT, GL_LINE);
             break;
+        case 'c':
+            // Cut graph by the dual spanning tree
+            cut_graph(&g_mesh);
+            break;
+        case 'g':
+            // Cut graph by the greedy shortest loops
+            cut_graph(&g_mesh, true);
+            break;
         case '?':
             help();
             break;
@@ -395,10 +407,10 @@ void initOpenGL(int argc, char* argv[])
     glutMainLoop(); /* Start GLUT event-processing loop */
 }
 
-void cut_graph(CCutGraphMesh* pMesh)
+void cut_graph(CCutGraphMesh* pMesh, bool shortest)
 {
     CCutGraph cg(pMesh);
-    cg.cut_graph();
+    cg.cut_graph(shortest);
 }
 
 /*! main function for viewer
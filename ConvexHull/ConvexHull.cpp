@@ -1,9 +1,11 @@
 #include <stdlib.h>
 #include <time.h>
+#include <algorithm>
 #include <random>
 #include <functional>
 
 #include "ConvexHull.h"
+#include "Parser/stream.h"
 
 namespace ConvexHull
 {
@@ -36,6 +38,89 @@ void CConvexHull::init(size_t num_pts)
     }
 
     // 2. ˫ĳʼ͹
+    _initial_hull();
+}
+
+void CConvexHull::init(const std::string& input, size_t num_pts)
+{
+    // 1. sample the vertices of the mesh by reservoir sampling, the mesh is
+    //    streamed chunk by chunk, its bounding box is taken in the same pass
+    CMeshStream stream;
+    if (!stream.open(input.c_str()))
+        return;
+
+    std::vector<CPoint> samples;
+    CPoint lower(1e30, 1e30, 1e30), upper(-1e30, -1e30, -1e30);
+    size_t seen = 0;
+    std::mt19937 gen((unsigned) time(NULL));
+    stream.read(
+        [&](const CVertexChunk& chunk) {
+            for (size_t i = 0; i < chunk.size(); ++i)
+            {
+                const CPoint& p = chunk.points[i];
+                for (int k = 0; k < 3; ++k)
+                {
+                    lower[k] = std::min(lower[k], p[k]);
+                    upper[k] = std::max(upper[k], p[k]);
+                }
+
+                if (seen++ < num_pts)
+                {
+                    samples.push_back(p);
+                    continue;
+                }
+                size_t j = std::uniform_int_distribution<size_t>(0, seen - 1)(gen);
+                if (j < num_pts)
+                    samples[j] = p;
+            }
+        },
+        [](const CFaceChunk&) {});
+
+    if (samples.size() < 3)
+    {
+        fprintf(stderr, "Error: %s has less than 3 vertices\n", input.c_str());
+        return;
+    }
+
+    // 2. scale the samples into the unit ball
+    CPoint center = (lower + upper) / 2.0;
+    double radius = (upper - lower).norm() / 2.0;
+    if (radius == 0)
+        radius = 1;
+    for (size_t i = 0; i < samples.size(); ++i)
+        m_sites.push_back(new CPoint((samples[i] - center) / radius));
+
+    // 3. the reservoir keeps the first vertices of the file in place, they
+    //    are often adjacent and collinear on scanned grids. Shuffle the
+    //    sites, then bring two distinct sites and a third one off their
+    //    line to the front, so that the initial triangles are not degenerate.
+    std::shuffle(m_sites.begin(), m_sites.end(), gen);
+    size_t second = 1, third = 2;
+    while (second < m_sites.size() && (*m_sites[second] - *m_sites[0]).norm() < 1e-12)
+        ++second;
+    if (second < m_sites.size())
+    {
+        std::swap(m_sites[1], m_sites[second]);
+        CPoint d = *m_sites[1] - *m_sites[0];
+        while (third < m_sites.size() && (d ^ (*m_sites[third] - *m_sites[0])).norm() < 1e-12)
+            ++third;
+    }
+    if (second >= m_sites.size() || third >= m_sites.size())
+    {
+        fprintf(stderr, "Error: the vertices of %s are collinear\n", input.c_str());
+        for (size_t i = 0; i < m_sites.size(); ++i)
+            delete m_sites[i];
+        m_sites.clear();
+        return;
+    }
+    std::swap(m_sites[2], m_sites[third]);
+
+    // 4. build the initial hull
+    _initial_hull();
+}
+
+void CConvexHull::_initial_hull()
+{
     using M = CConvexHullMesh;
     m_max_vertex_id = 0;
     m_max_face_id   = 0;
@@ -3,6 +3,7 @@
 
 #include <vector>
 #include <list>
+#include <string>
 
 #include "ConvexHullMesh.h"
 
@@ -24,6 +25,14 @@ class CConvexHull
      */
     void init(size_t num_pts);
 
+    /*!
+     *  Sample some vertices of a mesh, scaled into the unit ball. The mesh
+     *  is streamed, so it may be larger than the memory.
+     *  \param [in] input: an .m or .mb file.
+     *  \param [in] num_pts: the number of the points.
+     */
+    void init(const std::string& input, size_t num_pts);
+
     /*!
      *  Insert one point, the convex hull will be updated if necessary.
      *  \param [in] p: a point which will be inserted.
@@ -48,6 +57,12 @@ class CConvexHull
     CConvexHullMesh& hull()       { return m_pMesh; };
 
   protected:
+    /*!
+     *  Build the initial convex hull, two opposite triangles on the first
+     *  three sites.
+     */
+    void _initial_hull();
+
     /*!
      *  Determine the sign of the volume constructed by a face and a point
      *  \param [in] pF: a face pointer
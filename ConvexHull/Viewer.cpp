@@ -145,8 +145,9 @@ void reshape(int w, int h)
 /*! helper function to remind the user about commands, hot keys */
 void help()
 {
-    printf("Usage: ConvexHull [num_of_sites]\n");
-    printf("   ex: ConvexHull 12000\n\n");
+    printf("Usage: ConvexHull [num_of_sites] [mesh]\n");
+    printf("   ex: ConvexHull 12000\n");
+    printf("   ex: ConvexHull 12000 bunny.m, sites sampled from the vertices of the mesh\n\n");
 
     printf("1  -  Show or hide the convex hull\n");
     printf("2  -  Show or hide the sites\n");
@@ -354,7 +355,10 @@ int main(int argc, char* argv[])
     if (argc >= 2)
         num_sites = atoi(argv[1]);
 
-    g_convexhull.init(num_sites);
+    if (argc >= 3)
+        g_convexhull.init(argv[2], num_sites);
+    else
+        g_convexhull.init(num_sites);
 
     help();
 
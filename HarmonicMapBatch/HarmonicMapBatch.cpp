@@ -0,0 +1,409 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "../Assignment2/HarmonicMapMesh.h"
+#include "../Assignment2/HarmonicMap.h"
+#include "../Assignment2/AreaPreservingMap.h"
+#include "../Assignment2_1/CutGraph.h"
+#include "../Assignment2_1/MeshSlicer.h"
+
+using namespace MeshLib;
+
+/*! \brief CBatchJob class
+ *
+ *   One line of the manifest, input mesh and output mesh
+ */
+struct CBatchJob
+{
+    /*! line number in the manifest */
+    int line;
+    /*! input .m file */
+    std::string input;
+    /*! output .m file with vertex uv */
+    std::string output;
+};
+
+/*! \brief CManifest class
+ *
+ *   Manifest read line by line by the workers, each line is
+ *   "input.m [output.m]", empty lines and lines starting with '#'
+ *   are skipped. The default output is input_uv.m.
+ */
+class CManifest
+{
+  public:
+    /*! open the manifest */
+    bool open(const char* name)
+    {
+        m_is.open(name);
+        m_line = 0;
+        return !m_is.fail();
+    };
+
+    /*! the next job, false at the end of the manifest */
+    bool next(CBatchJob& job)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::string line;
+        while (std::getline(m_is, line))
+        {
+            m_line++;
+            std::stringstream iss(line);
+            if (!(iss >> job.input) || job.input[0] == '#')
+                continue;
+            if (!(iss >> job.output))
+            {
+                size_t dot = job.input.rfind(".m");
+                job.output = job.input.substr(0, dot) + "_uv.m";
+            }
+            job.line = m_line;
+            return true;
+        }
+        return false;
+    };
+
+  protected:
+    std::ifstream m_is;
+    std::mutex m_mutex;
+    int m_line;
+};
+
+/*! \brief CMemoryBudget class
+ *
+ *   Bounds the estimated memory of the meshes loaded at the same time.
+ *   A mesh larger than the whole budget still runs, but alone.
+ */
+class CMemoryBudget
+{
+  public:
+    CMemoryBudget(size_t budget) : m_budget(budget), m_used(0){};
+
+    /*! wait until the bytes fit in the budget */
+    void acquire(size_t bytes)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [&] { return m_used == 0 || m_used + bytes <= m_budget; });
+        m_used += bytes;
+    };
+
+    /*! give the bytes back */
+    void release(size_t bytes)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_used -= bytes;
+        }
+        m_cv.notify_all();
+    };
+
+  protected:
+    size_t m_budget;
+    size_t m_used;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+};
+
+/*! global settings and shared state of the batch */
+CManifest g_manifest;
+CMemoryBudget* g_budget = NULL;
+bool g_cut = false;
+bool g_area = false;
+int g_reorder = -1;
+std::mutex g_stats_mutex;
+std::ofstream g_stats;
+std::atomic<int> g_succeeded(0), g_failed(0);
+
+/*! a loaded mesh takes about this many bytes per byte of the .m file */
+const size_t g_memory_per_byte = 8;
+
+/*! size of a file in bytes, 0 if it can not be opened */
+size_t fileSize(const std::string& name)
+{
+    std::ifstream is(name.c_str(), std::ifstream::binary | std::ifstream::ate);
+    if (is.fail())
+        return 0;
+    return (size_t)is.tellg();
+}
+
+/*! Read a mesh, cut it along the shortest cut graph if it is closed, and
+ *  slice it into a topological disk in memory, other meshes are sliced
+ *  without cuts, so they are copied
+ */
+void readAndSlice(const std::string& name, CHarmonicMapMesh* pDisk)
+{
+    CCutGraphMesh mesh;
+    mesh.read_m(name.c_str());
+    if (mesh.numFaces() == 0)
+        return;
+
+    CCutGraphMesh::CTopology topology(&mesh);
+    if (topology.is_closed())
+    {
+        CCutGraph cg(&mesh);
+        cg.cut_graph(true);
+    }
+
+    CMeshSlicer<CCutGraphMesh, CHarmonicMapMesh> slicer(&mesh);
+    slicer.slice(pDisk);
+}
+
+/*! Maximal residual of the harmonic equations at the interior vertices,
+ *  relative to the weighted average of the neighbors, and the number of
+ *  faces with non-positive uv area
+ */
+void mapStatistics(CHarmonicMapMesh* pMesh, double& residual, int& flipped)
+{
+    using M = CHarmonicMapMesh;
+
+    residual = 0;
+    for (M::MeshVertexIterator viter(pMesh); !viter.end(); ++viter)
+    {
+        M::CVertex* pV = *viter;
+        if (pV->boundary())
+            continue;
+
+        double sw = 0;
+        CPoint2 suv(0, 0);
+        for (M::VertexOutHalfedgeIterator vhiter(pMesh, pV); !vhiter.end(); ++vhiter)
+        {
+            M::CHalfEdge* pH = *vhiter;
+            double w = pMesh->halfedgeEdge(pH)->weight();
+            sw += w;
+            suv += pMesh->halfedgeTarget(pH)->uv() * w;
+        }
+        double error = (pV->uv() - suv / sw).norm();
+        residual = (error > residual) ? error : residual;
+    }
+
+    flipped = 0;
+    for (M::MeshFaceIterator fiter(pMesh); !fiter.end(); ++fiter)
+    {
+        M::CHalfEdge* pH = pMesh->faceHalfedge(*fiter);
+        CPoint2& a = pMesh->halfedgeSource(pH)->uv();
+        CPoint2& b = pMesh->halfedgeTarget(pH)->uv();
+        CPoint2& c = pMesh->halfedgeTarget(pMesh->halfedgeNext(pH))->uv();
+        CPoint2 u = b - a, v = c - a;
+        if (u[0] * v[1] - u[1] * v[0] <= 0)
+            flipped++;
+    }
+}
+
+/*! stages of the area-preserving map after the harmonic map, in the order of its timings */
+const int g_area_stages = 3;
+
+/*! Load, map and write one mesh, then append a line to the statistics */
+void runJob(const CBatchJob& job)
+{
+    typedef std::chrono::steady_clock clock;
+    auto ms = [](clock::time_point a, clock::time_point b) {
+        return std::chrono::duration<double, std::milli>(b - a).count();
+    };
+
+    std::string status = "ok";
+    int nv = 0, nf = 0, components = 0, genus = 0, boundaries = 0, flipped = 0;
+    double residual = 0, area_error = 0;
+    std::vector<double> stages(g_area_stages, 0.0);
+    clock::time_point t0 = clock::now(), t1 = t0, tr = t0, t2 = t0, ta0 = t0, ta1 = t0, t3 = t0;
+
+    // the closed mesh and the sliced mesh are loaded at the same time
+    size_t bytes = fileSize(job.input) * (g_cut ? 2 : 1);
+    if (bytes == 0)
+    {
+        status = "cannot_open";
+    }
+    else
+    {
+        g_budget->acquire(bytes * g_memory_per_byte);
+        {
+            // the mesh is released before the budget
+            CHarmonicMapMesh mesh;
+            t0 = clock::now();
+            if (g_cut)
+                readAndSlice(job.input, &mesh);
+            else
+                mesh.read_m(job.input.c_str());
+            t1 = clock::now();
+            // the solver numbers the vertices in the order of the mesh
+            if (g_reorder >= 0)
+                mesh.reorder(g_reorder);
+            tr = clock::now();
+            nv = mesh.numVertices();
+            nf = mesh.numFaces();
+
+            // reject the meshes which are not disks before the solver
+            CHarmonicMapMesh::CTopology topology(&mesh);
+            components = (int)topology.components().size();
+            genus = topology.genus();
+            boundaries = topology.boundaries();
+
+            CHarmonicMap mapper;
+            if (nf == 0)
+                status = "empty_mesh";
+            else if (components != 1)
+                status = "not_connected";
+            else if (!topology.is_disk())
+                status = "not_disk";
+            else if (!mapper.set_mesh(&mesh))
+                status = "not_disk";
+            else if (!mapper.map())
+                status = "solver_failed";
+            t2 = clock::now();
+
+            // the statistics are of the harmonic map
+            if (status == "ok")
+                mapStatistics(&mesh, residual, flipped);
+            ta0 = clock::now();
+
+            // the area-preserving map starts from the harmonic uv and replaces
+            // it, its stages are timed by itself, the first one is skipped
+            if (status == "ok" && g_area)
+            {
+                CAreaPreservingMap area_map;
+                if (!area_map.set_mesh(&mesh, true) || !area_map.map())
+                    status = "area_map_failed";
+                area_error = area_map.area_error();
+                for (size_t k = 1; k < area_map.timings().size() && (int)k <= g_area_stages; k++)
+                    stages[k - 1] = area_map.timings()[k].second;
+            }
+            ta1 = clock::now();
+
+            if (status == "ok")
+                mesh.write_m(job.output.c_str());
+            t3 = clock::now();
+        }
+        g_budget->release(bytes * g_memory_per_byte);
+    }
+
+    if (status == "ok")
+        g_succeeded++;
+    else
+        g_failed++;
+
+    std::lock_guard<std::mutex> lock(g_stats_mutex);
+    g_stats << job.input << "," << status << "," << nv << "," << nf << "," << components << "," << genus << ","
+            << boundaries << "," << ms(t0, t1) << "," << ms(t1, tr) << "," << ms(tr, t2) << ","
+            << ms(t2, ta0) + ms(ta1, t3) << "," << residual << "," << flipped;
+    for (int k = 0; k < g_area_stages; k++)
+        g_stats << "," << stages[k];
+    g_stats << "," << area_error << std::endl;
+    printf("[%d] %s %s\n", job.line, job.input.c_str(), status.c_str());
+}
+
+/*! worker of the thread pool, takes jobs until the manifest ends */
+void worker()
+{
+#ifdef _OPENMP
+    // parallelism comes from the pool, not from inside each mesh
+    omp_set_num_threads(1);
+#endif
+    CBatchJob job;
+    while (g_manifest.next(job))
+        runJob(job);
+}
+
+void help(const char* name)
+{
+    printf("Usage: %s manifest.txt [-t threads] [-m memory_mb] [-s stats.csv] [-c] [-r rcm|hilbert] [-a]\n", name);
+    printf("manifest  -  one mesh per line, input.m [output.m]\n");
+    printf("-t        -  number of worker threads, hardware concurrency by default\n");
+    printf("-m        -  estimated memory budget of the loaded meshes in MB, 1024 by default\n");
+    printf("-s        -  per-mesh timing and error statistics, stats.csv by default\n");
+    printf("-c        -  cut closed meshes along the shortest cut graph and slice them in memory\n");
+    printf("-r        -  reorder the vertices and faces before the map, the output ids are renumbered\n");
+    printf("-a        -  area-preserving map after the harmonic map, written as the uv, with its stage timings and area error\n");
+    printf("meshes which are not connected disks are rejected before the solver\n");
+}
+
+/*! main function for batch harmonic map
+ */
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        help(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    int threads = (int)std::thread::hardware_concurrency();
+    size_t memory = 1024;
+    std::string stats = "stats.csv";
+    for (int i = 2; i < argc; i += 2)
+    {
+        std::string option(argv[i]);
+        if (option == "-c")
+        {
+            g_cut = true;
+            i--;
+        }
+        else if (option == "-a")
+        {
+            g_area = true;
+            i--;
+        }
+        else if (i + 1 == argc)
+        {
+            help(argv[0]);
+            return EXIT_FAILURE;
+        }
+        else if (option == "-t")
+            threads = atoi(argv[i + 1]);
+        else if (option == "-m")
+            memory = (size_t)atol(argv[i + 1]);
+        else if (option == "-s")
+            stats = argv[i + 1];
+        else if (option == "-r" && std::string(argv[i + 1]) == "rcm")
+            g_reorder = COrdering::RCM;
+        else if (option == "-r" && std::string(argv[i + 1]) == "hilbert")
+            g_reorder = COrdering::HILBERT;
+        else
+        {
+            help(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    threads = (threads < 1) ? 1 : threads;
+
+    if (!g_manifest.open(argv[1]))
+    {
+        fprintf(stderr, "Error is opening file %s\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+    g_stats.open(stats.c_str());
+    if (g_stats.fail())
+    {
+        fprintf(stderr, "Error is opening file %s\n", stats.c_str());
+        return EXIT_FAILURE;
+    }
+    g_stats << "input,status,vertices,faces,components,genus,boundaries,load_ms,reorder_ms,map_ms,write_ms,max_residual,flipped_faces,"
+            << "area_measure_ms,area_transport_ms,area_compose_ms,area_error" << std::endl;
+
+    CMemoryBudget budget(memory * 1024 * 1024);
+    g_budget = &budget;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (int i = 0; i < threads; i++)
+        pool.push_back(std::thread(worker));
+    for (int i = 0; i < threads; i++)
+        pool[i].join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printf("%d succeeded, %d failed, %g s with %d threads\n", (int)g_succeeded, (int)g_failed, seconds, threads);
+    return (g_failed > 0) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
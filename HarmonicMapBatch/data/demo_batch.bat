@@ -0,0 +1,6 @@
+Echo harmonic map of every mesh in manifest.txt
+..\bin\HarmonicMapBatch.exe manifest.txt -t 4 -m 1024 -s stats.csv
+Echo cut the closed meshes in manifest.txt and map the sliced disks
+..\bin\HarmonicMapBatch.exe manifest.txt -t 4 -m 1024 -s stats_cut.csv -c
+Echo area-preserving map of every mesh in manifest.txt, with its stage timings
+..\bin\HarmonicMapBatch.exe manifest.txt -t 4 -m 1024 -s stats_area.csv -a
@@ -18,30 +18,22 @@ class CMyFace_2 : public CFace_2
     {
         CParser parser(m_string);
         parser._removeToken("normal");
-
         parser._toString(m_string);
-        std::stringstream iss;
-
-        iss << "normal=(" << m_normal[0] << " " << m_normal[1] << " " << m_normal[2] << ")";
 
-        if (m_string.length() > 0)
-        {
-            m_string += " ";
-        }
-        m_string += iss.str();
+        double v[3] = {m_normal[0], m_normal[1], m_normal[2]};
+        CParser::_appendToken(m_string, "normal", v, 3);
     };
 
     void from_string()
     {
         CParser parser(m_string);
-        for (std::list<CToken*>::iterator iter = parser.tokens().begin(); iter != parser.tokens().end(); ++iter)
+        const CTokenView* token = parser.find("normal");
+        if (token != NULL)
         {
-            CToken* token = *iter;
-            if (token->m_key == "normal")
-            {
-                token->m_value >> m_normal;
-            }
-        }        
+            double v[3] = {0, 0, 0};
+            token->numbers(v, 3);
+            m_normal = CPoint(v[0], v[1], v[2]);
+        }
     };
 
     ADD_TRAIT(CPoint, normal)